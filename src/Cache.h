@@ -52,11 +52,15 @@ template <class Key, class T>
 class Cache
 {
   struct Node {
-    inline Node() : keyPtr(nullptr), t(nullptr), c(0), p(nullptr), n(nullptr) {}
-    inline Node(T *data, size_t cost) : keyPtr(nullptr), t(data), c(cost), p(nullptr), n(nullptr) {}
+    inline Node() : keyPtr(nullptr), t(nullptr), c(0), pins(0), p(nullptr), n(nullptr) {}
+    inline Node(T *data, size_t cost)
+      : keyPtr(nullptr), t(data), c(cost), pins(0), p(nullptr), n(nullptr)
+    {
+    }
     const Key *keyPtr;
     T *t;
     size_t c;
+    size_t pins;
     Node *p, *n;
   };
   using map_type = typename std::unordered_map<Key, Node>;
@@ -131,6 +135,11 @@ public:
   bool remove(const Key& key);
   T *take(const Key& key);
 
+  // Pinned objects aren't evicted to make room for others until unpinned as often as pinned, so the
+  // total cost may exceed the maximum while they are. Returns false if the key isn't cached.
+  bool pin(const Key& key);
+  void unpin(const Key& key);
+
 private:
   void trim(size_t m);
 };
@@ -160,6 +169,22 @@ inline T *Cache<Key, T>::take(const Key& key)
   return t;
 }
 
+template <class Key, class T>
+inline bool Cache<Key, T>::pin(const Key& key)
+{
+  auto i = hash.find(key);
+  if (i == hash.end()) return false;
+  ++i->second.pins;
+  return true;
+}
+
+template <class Key, class T>
+inline void Cache<Key, T>::unpin(const Key& key)
+{
+  auto i = hash.find(key);
+  if (i != hash.end() && i->second.pins > 0) --i->second.pins;
+}
+
 template <class Key, class T>
 bool Cache<Key, T>::insert(const Key& akey, T *aobject, size_t acost)
 {
@@ -189,6 +214,7 @@ void Cache<Key, T>::trim(size_t m)
   while (n && total > m) {
     Node *u = n;
     n = n->p;
+    if (u->pins > 0) continue;
 #ifdef DEBUG
     LOG("Trimming cache: %1$s (%2$d bytes)", u->keyPtr->substr(0, 40), u->c);
 #endif
@@ -0,0 +1,59 @@
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+#include "Cache.h"
+
+TEST_CASE("Cache evicts the least recently used objects", "[Cache]")
+{
+  Cache<std::string, int> cache(2);
+  cache.insert("a", new int(1), 1);
+  cache.insert("b", new int(2), 1);
+  // Makes "b" the least recently used
+  CHECK(*cache.object("a") == 1);
+  cache.insert("c", new int(3), 1);
+  CHECK(cache.contains("a"));
+  CHECK_FALSE(cache.contains("b"));
+  CHECK(cache.contains("c"));
+  CHECK(cache.totalCost() == 2);
+}
+
+TEST_CASE("Cache keeps pinned objects until they are unpinned", "[Cache]")
+{
+  Cache<std::string, int> cache(2);
+  cache.insert("shared", new int(1), 1);
+  REQUIRE(cache.pin("shared"));
+  CHECK_FALSE(cache.pin("missing"));
+
+  SECTION("siblings evict each other, not the pinned object")
+  {
+    cache.insert("b", new int(2), 1);
+    cache.insert("c", new int(3), 1);
+    CHECK(cache.contains("shared"));
+    CHECK_FALSE(cache.contains("b"));
+    CHECK(cache.contains("c"));
+  }
+
+  SECTION("the total cost may exceed the maximum while pinned")
+  {
+    cache.insert("b", new int(2), 2);
+    CHECK(cache.contains("shared"));
+    CHECK(cache.contains("b"));
+    CHECK(cache.totalCost() == 3);
+
+    cache.setMaxCost(1);
+    CHECK(cache.contains("shared"));
+    CHECK_FALSE(cache.contains("b"));
+  }
+
+  SECTION("pins are counted")
+  {
+    REQUIRE(cache.pin("shared"));
+    cache.unpin("shared");
+    cache.setMaxCost(0);
+    CHECK(cache.contains("shared"));
+    cache.unpin("shared");
+    cache.setMaxCost(0);
+    CHECK_FALSE(cache.contains("shared"));
+  }
+}
@@ -44,6 +44,31 @@ const Feature Feature::ExperimentalPredictibleOutput(
   "order)");
 const Feature Feature::ExperimentalVectorSwizzle(
   "vector-swizzle", "Enable vector swizzling (e.g. <code>vec4.zyx</code> to reverse a 3D vector).");
+const Feature Feature::ExperimentalFunctionMemoization(
+  "function-memoization",
+  "Cache results of pure user functions called repeatedly with the same arguments.");
+const Feature Feature::ExperimentalNodeSharing(
+  "node-sharing",
+  "Share the nodes of pure user modules instantiated repeatedly with the same arguments, so identical "
+  "subtrees are only evaluated once.");
+const Feature Feature::ExperimentalParallelComprehensions(
+  "parallel-comprehensions",
+  "Evaluate the iterations of large list comprehensions with side effect free bodies on several threads.");
+const Feature Feature::ExperimentalIncrementalInstantiation(
+  "incremental-instantiation",
+  "Reuse the nodes of pure user modules from the previous evaluation of a design when neither their "
+  "definitions nor their arguments changed.");
+const Feature Feature::ExperimentalTransformInvariantCache(
+  "transform-invariant-cache",
+  "Cache the results of booleans over children sharing the same rigid transform without it, so they "
+  "can be reused under other rigid transforms.");
+const Feature Feature::ExperimentalOffset3D(
+  "offset-3d",
+  "Enable <code>offset(r)</code> of 3D objects, rounding them without minkowski() (Manifold backend "
+  "only).");
+const Feature Feature::ExperimentalCacheAwareEvaluation(
+  "cache-aware-evaluation",
+  "Evaluate subtrees used more than once first, and keep their geometry cached until their last use.");
 
 #ifdef ENABLE_PYTHON
 const Feature Feature::ExperimentalPythonEngine(
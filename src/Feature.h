@@ -21,6 +21,13 @@ public:
   static const Feature ExperimentalObjectFunction;
   static const Feature ExperimentalPredictibleOutput;
   static const Feature ExperimentalVectorSwizzle;
+  static const Feature ExperimentalFunctionMemoization;
+  static const Feature ExperimentalNodeSharing;
+  static const Feature ExperimentalParallelComprehensions;
+  static const Feature ExperimentalIncrementalInstantiation;
+  static const Feature ExperimentalTransformInvariantCache;
+  static const Feature ExperimentalOffset3D;
+  static const Feature ExperimentalCacheAwareEvaluation;
 #ifdef ENABLE_PYTHON
   static const Feature ExperimentalPythonEngine;
 #endif
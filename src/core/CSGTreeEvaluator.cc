@@ -67,8 +67,8 @@ void CSGTreeEvaluator::applyToChildren(State& state, const AbstractNode& node, O
 
   std::shared_ptr<CSGNode> t1;
   for (const auto& chnode : vc) {
+    // a shared node (see NodeSharing) may occur more than once, so erase the terms afterwards
     std::shared_ptr<CSGNode> t2(this->stored_term[chnode->index()]);
-    this->stored_term.erase(chnode->index());
     if (t2 && !t1) {
       t1 = t2;
     } else if (t2 && t1) {
@@ -124,6 +124,9 @@ void CSGTreeEvaluator::applyToChildren(State& state, const AbstractNode& node, O
       t1 = t;
     }
   }
+  for (const auto& chnode : vc) {
+    this->stored_term.erase(chnode->index());
+  }
   if (t1) {
     if (node.modinst->isBackground() || state.isBackground()) t1->setBackground(true);
     if (node.modinst->isHighlight() || state.isHighlight()) t1->setHighlight(true);
@@ -40,7 +40,7 @@
 Context::Context(EvaluationSession *session) : ContextFrame(session), parent(nullptr) {}
 
 Context::Context(const std::shared_ptr<const Context>& parent)
-  : ContextFrame(parent->evaluation_session), parent(parent)
+  : ContextFrame(parent->session()), parent(parent)
 {
 }
 
@@ -48,7 +48,7 @@ Context::~Context()
 {
   Context::clear();
   if (accountingAdded)  // avoiding bad accounting where exception threw in constructor issue #3871
-    session()->contextMemoryManager().releaseContext();
+    evaluation_session->contextMemoryManager().releaseContext();
 }
 
 const Children *Context::user_module_children() const
@@ -129,7 +129,7 @@ bool Context::set_variable(const std::string& name, Value&& value)
 {
   bool new_variable = ContextFrame::set_variable(name, std::move(value));
   if (new_variable) {
-    session()->accounting().addContextVariable();
+    evaluation_session->accounting().addContextVariable();
   }
   return new_variable;
 }
@@ -137,7 +137,7 @@ bool Context::set_variable(const std::string& name, Value&& value)
 size_t Context::clear()
 {
   size_t removed = ContextFrame::clear();
-  session()->accounting().removeContextVariable(removed);
+  evaluation_session->accounting().removeContextVariable(removed);
   return removed;
 }
 
@@ -40,7 +40,57 @@
 #include <string>
 #include <vector>
 #include <boost/format.hpp>
-ContextFrame::ContextFrame(EvaluationSession *session) : evaluation_session(session) {}
+
+/*
+ * Inherited special variables form a persistent list: each level is an object holding the
+ * variables set in one frame, with the rest of the list stored under PARENT_KEY. A level is never
+ * modified once built, so frames inheriting the same variables share it, and a call only pays for
+ * the variables it actually changes. Being ordinary values, levels are accounted for by the
+ * garbage collector like any other value. Lists longer than MAX_INHERITED_DEPTH are flattened, to
+ * bound the cost of lookups in deep call chains.
+ */
+static const std::string PARENT_KEY;  // not a valid variable name
+static constexpr size_t MAX_INHERITED_DEPTH = 8;
+
+static boost::optional<const Value&> lookup_inherited(const Value& inherited, const std::string& name)
+{
+  for (const Value *level = &inherited; level->type() == Value::Type::OBJECT;
+       level = &level->toObject().get(PARENT_KEY)) {
+    const auto& variables = level->toObject();
+    if (variables.contains(name)) return variables.get(name);
+  }
+  return boost::none;
+}
+
+static Value make_inherited(const ValueMap& changed, const Value& parent, EvaluationSession *session)
+{
+  ObjectType level(session);
+  std::vector<const ObjectType *> ancestors;
+  for (const Value *p = &parent; p->type() == Value::Type::OBJECT; p = &p->toObject().get(PARENT_KEY)) {
+    ancestors.push_back(&p->toObject());
+  }
+  if (ancestors.size() < MAX_INHERITED_DEPTH) {
+    if (!ancestors.empty()) level.set(PARENT_KEY, parent.clone());
+  } else {
+    // flatten, outermost first so that inner levels override
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+      for (size_t i = 0; i < (*it)->keys().size(); ++i) {
+        if ((*it)->keys()[i] != PARENT_KEY) level.set((*it)->keys()[i], (*it)->values()[i].clone());
+      }
+    }
+  }
+  for (const auto& variable : changed) {
+    level.set(variable.first, variable.second.clone());
+  }
+  // Build the key index now, so that lookups never modify a shared level.
+  level.contains(PARENT_KEY);
+  return {std::move(level)};
+}
+
+ContextFrame::ContextFrame(EvaluationSession *session)
+  : inherited_config_variables(Value::undefined.clone()), evaluation_session(session)
+{
+}
 
 boost::optional<const Value&> ContextFrame::lookup_local_variable(const std::string& name) const
 {
@@ -49,6 +99,7 @@ boost::optional<const Value&> ContextFrame::lookup_local_variable(const std::str
     if (result != config_variables.end()) {
       return result->second;
     }
+    return lookup_inherited(inherited_config_variables, name);
   } else {
     auto result = lexical_variables.find(name);
     if (result != lexical_variables.end()) {
@@ -83,6 +134,7 @@ std::vector<const Value *> ContextFrame::list_embedded_values() const
   for (const auto& variable : config_variables) {
     output.push_back(&variable.second);
   }
+  output.push_back(&inherited_config_variables);
   return output;
 }
 
@@ -91,6 +143,7 @@ size_t ContextFrame::clear()
   size_t removed = lexical_variables.size() + config_variables.size();
   lexical_variables.clear();
   config_variables.clear();
+  inherited_config_variables = Value::undefined.clone();
   return removed;
 }
 
@@ -117,7 +170,12 @@ void ContextFrame::apply_lexical_variables(const ContextFrame& other)
 
 void ContextFrame::apply_config_variables(const ContextFrame& other)
 {
-  apply_variables(other.config_variables);
+  if (other.config_variables.size() == 0) {
+    inherited_config_variables = other.inherited_config_variables.clone();
+  } else {
+    inherited_config_variables =
+      make_inherited(other.config_variables, other.inherited_config_variables, evaluation_session);
+  }
 }
 
 void ContextFrame::apply_variables(ValueMap&& variables)
@@ -162,6 +220,9 @@ std::string ContextFrame::dumpFrame() const
   for (const auto& v : config_variables) {
     s << boost::format("    %s = %s\n") % v.first % v.second.toEchoString();
   }
+  if (inherited_config_variables.isDefined()) {
+    s << boost::format("    (inherited) %s\n") % inherited_config_variables.toEchoString();
+  }
   return s.str();
 }
 #endif  // ifdef DEBUG
@@ -8,10 +8,10 @@
 
 #include "core/AST.h"
 #include "core/callables.h"
+#include "core/Value.h"
 #include "core/ValueMap.h"
 
 class EvaluationSession;
-class Value;
 
 class ContextFrame
 {
@@ -34,6 +34,8 @@ public:
 
   void apply_variables(const ValueMap& variables);
   void apply_lexical_variables(const ContextFrame& other);
+  // Inherit the special variables visible in other, without copying them.
+  // Special variables set in this frame take precedence over inherited ones.
   void apply_config_variables(const ContextFrame& other);
   void apply_variables(const ContextFrame& other)
   {
@@ -48,18 +50,49 @@ public:
 
   static bool is_config_variable(const std::string& name);
 
-  EvaluationSession *session() const { return evaluation_session; }
+  // The session evaluating this frame. That is the session the frame was created in, unless the
+  // calling thread works for it within a WorkerSessionScope.
+  EvaluationSession *session() const { return worker_session ? worker_session : evaluation_session; }
   const std::string& documentRoot() const;
 
 protected:
   ValueMap lexical_variables;
   ValueMap config_variables;
+  // Special variables inherited through apply_config_variables(), as a persistent list shared with
+  // the frames they were inherited from (see ContextFrame.cc). Undefined if nothing is inherited.
+  Value inherited_config_variables;
   EvaluationSession *evaluation_session;
 
 public:
 #ifdef DEBUG
   virtual std::string dumpFrame() const;
 #endif
+
+private:
+  friend class WorkerSessionScope;
+  static inline thread_local EvaluationSession *worker_session = nullptr;
+};
+
+/*
+ * While a WorkerSessionScope is alive, the calling thread evaluates frames of
+ * any session in the given worker session: new contexts belong to it, and the
+ * special variable stack, caches and heap accounting are its own (see
+ * ParallelComprehension).
+ */
+class WorkerSessionScope
+{
+public:
+  WorkerSessionScope(EvaluationSession *session) : previous(ContextFrame::worker_session)
+  {
+    ContextFrame::worker_session = session;
+  }
+  ~WorkerSessionScope() { ContextFrame::worker_session = previous; }
+
+  WorkerSessionScope(const WorkerSessionScope&) = delete;
+  WorkerSessionScope& operator=(const WorkerSessionScope&) = delete;
+
+private:
+  EvaluationSession *previous;
 };
 
 /*
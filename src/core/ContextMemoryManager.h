@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <vector>
@@ -14,21 +15,28 @@ class Context;
  *
  * Counts one point for each context, each context variable, and each element
  * in a VectorType value.
+ *
+ * Vectors created by worker threads (see ParallelComprehension) are accounted
+ * to the session they work for, so the count is atomic. Its exact value only
+ * matters for scheduling, hence the relaxed ordering.
  */
 class HeapSizeAccounting
 {
 public:
-  void addContext(size_t number = 1) { count += number; }
-  void removeContext(size_t number = 1) { count -= number; }
-  void addContextVariable(size_t number = 1) { count += number; }
-  void removeContextVariable(size_t number = 1) { count -= number; }
-  void addVectorElement(size_t number = 1) { count += number; }
-  void removeVectorElement(size_t number = 1) { count -= number; }
+  void addContext(size_t number = 1) { add(number); }
+  void removeContext(size_t number = 1) { remove(number); }
+  void addContextVariable(size_t number = 1) { add(number); }
+  void removeContextVariable(size_t number = 1) { remove(number); }
+  void addVectorElement(size_t number = 1) { add(number); }
+  void removeVectorElement(size_t number = 1) { remove(number); }
 
-  [[nodiscard]] size_t size() const { return count; }
+  [[nodiscard]] size_t size() const { return count.load(std::memory_order_relaxed); }
 
 private:
-  size_t count = 0;
+  void add(size_t number) { count.fetch_add(number, std::memory_order_relaxed); }
+  void remove(size_t number) { count.fetch_sub(number, std::memory_order_relaxed); }
+
+  std::atomic<size_t> count{0};
 };
 
 class ContextMemoryManager
@@ -5,6 +5,7 @@
 #include <queue>
 
 #include "core/AST.h"  // for Location
+#include "core/EvaluationSession.h"
 #include "core/Parameters.h"
 #include "geometry/Grid.h"
 #include "geometry/Polygon2d.h"
@@ -34,6 +35,7 @@ CurveDiscretizer::CurveDiscretizer(const Parameters& parameters, const Location&
         F_MINIMUM);
     fa = F_MINIMUM;
   }
+  limitFragments(parameters.session()->fragmentLimit());
 }
 
 CurveDiscretizer::CurveDiscretizer(const Parameters& parameters)
@@ -41,6 +43,15 @@ CurveDiscretizer::CurveDiscretizer(const Parameters& parameters)
   fn = std::max(parameters["$fn"].toDouble(), 0.0);
   fs = std::max(parameters["$fs"].toDouble(), F_MINIMUM);
   fa = std::max(parameters["$fa"].toDouble(), F_MINIMUM);
+  limitFragments(parameters.session()->fragmentLimit());
+}
+
+void CurveDiscretizer::limitFragments(int limit)
+{
+  if (limit <= 0) return;
+  if (fn > limit) fn = limit;
+  // At most 360 / fa fragments are used when $fn isn't set.
+  fa = std::max(fa, 360.0 / limit);
 }
 
 CurveDiscretizer::CurveDiscretizer(double segmentsPerCircle)
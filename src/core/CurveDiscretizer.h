@@ -76,6 +76,8 @@ public:
 
 private:
   CurveDiscretizer(double fn, double fs, double fa) : fn(fn), fs(fs), fa(fa) {}
+  // Applies the fragment limit of the evaluation session, see EvaluationSession::fragmentLimit().
+  void limitFragments(int limit);
 
 protected:
   friend class RoofDiscretizer;
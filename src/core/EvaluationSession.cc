@@ -28,15 +28,53 @@
 
 #include <cassert>
 #include <cstddef>
+#include <memory>
 #include <string>
+#include <utility>
 
+#include "Feature.h"
 #include "core/AST.h"
 #include "core/ContextFrame.h"
 #include "core/function.h"
+#include "core/FunctionMemo.h"
+#include "core/IncrementalInstantiation.h"
 #include "core/module.h"
+#include "core/NodeSharing.h"
+#include "core/ParallelComprehension.h"
 #include "core/Value.h"
 #include "utils/printutils.h"
 
+EvaluationSession::EvaluationSession(std::string documentRoot)
+  : document_root(std::move(documentRoot)), value_session(this)
+{
+  if (Feature::ExperimentalFunctionMemoization.is_enabled()) {
+    function_memo = std::make_unique<FunctionMemo>();
+  }
+  if (Feature::ExperimentalNodeSharing.is_enabled()) {
+    node_sharing = std::make_unique<NodeSharing>();
+  }
+  if (Feature::ExperimentalIncrementalInstantiation.is_enabled()) {
+    incremental_instantiation = std::make_unique<IncrementalInstantiation>();
+  }
+  if (Feature::ExperimentalParallelComprehensions.is_enabled()) {
+    parallel_comprehension = std::make_unique<ParallelComprehension>();
+  }
+}
+
+EvaluationSession::EvaluationSession(EvaluationSession *owner)
+  : document_root(owner->document_root),
+    stack(owner->stack),
+    value_session(owner->value_session),
+    fragment_limit(owner->fragment_limit)
+{
+  // The memo of the owner isn't thread-safe, the worker keeps its own for the duration of its work.
+  if (owner->function_memo) {
+    function_memo = std::make_unique<FunctionMemo>();
+  }
+}
+
+EvaluationSession::~EvaluationSession() = default;
+
 size_t EvaluationSession::push_frame(ContextFrame *frame)
 {
   size_t index = stack.size();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -11,11 +12,20 @@
 
 class Value;
 class ContextFrame;
+class FunctionMemo;
+class IncrementalInstantiation;
+class NodeSharing;
+class ParallelComprehension;
 
 class EvaluationSession
 {
 public:
-  EvaluationSession(std::string documentRoot) : document_root(std::move(documentRoot)) {}
+  EvaluationSession(std::string documentRoot);
+  // A worker session, evaluating on behalf of owner on another thread (see WorkerSessionScope).
+  // Its special variable stack starts out with the frames of owner, which must not change while
+  // the worker session exists, and the values it creates are accounted to owner.
+  explicit EvaluationSession(EvaluationSession *owner);
+  ~EvaluationSession();
 
   size_t push_frame(ContextFrame *frame);
   void replace_frame(size_t index, ContextFrame *frame);
@@ -28,12 +38,34 @@ public:
   [[nodiscard]] boost::optional<InstantiableModule> lookup_special_module(const std::string& name,
                                                                           const Location& loc) const;
 
+  [[nodiscard]] const std::vector<ContextFrame *>& frames() const { return stack; }
   [[nodiscard]] const std::string& documentRoot() const { return document_root; }
   ContextMemoryManager& contextMemoryManager() { return context_memory_manager; }
   HeapSizeAccounting& accounting() { return context_memory_manager.accounting(); }
+  // Null unless the function-memoization feature is enabled.
+  FunctionMemo *functionMemo() { return function_memo.get(); }
+  // Null unless the node-sharing feature is enabled.
+  NodeSharing *nodeSharing() { return node_sharing.get(); }
+  // Null unless the incremental-instantiation feature is enabled, and always null for worker sessions.
+  IncrementalInstantiation *incrementalInstantiation() { return incremental_instantiation.get(); }
+  // Null unless the parallel-comprehensions feature is enabled, and always null for worker sessions.
+  ParallelComprehension *parallelComprehension() { return parallel_comprehension.get(); }
+  // The session accounting for the vectors and objects created in this one.
+  EvaluationSession *valueSession() { return value_session; }
+  // The most fragments circles, spheres and other curved shapes are made of, or 0 for no limit. Used
+  // for quick, coarse previews, e.g. while dragging a customizer slider.
+  [[nodiscard]] int fragmentLimit() const { return fragment_limit; }
+  void setFragmentLimit(int limit) { fragment_limit = limit; }
 
 private:
   std::string document_root;
   std::vector<ContextFrame *> stack;
+  EvaluationSession *value_session;
+  int fragment_limit = 0;
   ContextMemoryManager context_memory_manager;
+  // Holds values, so must be destroyed before the context_memory_manager which accounts for them.
+  std::unique_ptr<FunctionMemo> function_memo;
+  std::unique_ptr<NodeSharing> node_sharing;
+  std::unique_ptr<IncrementalInstantiation> incremental_instantiation;
+  std::unique_ptr<ParallelComprehension> parallel_comprehension;
 };
@@ -43,6 +43,8 @@
 #include "core/Context.h"
 #include "core/EvaluationSession.h"
 #include "core/function.h"
+#include "core/FunctionMemo.h"
+#include "core/ParallelComprehension.h"
 #include "core/Parameters.h"
 #include "core/Value.h"
 
@@ -65,6 +67,31 @@ Value Expression::checkUndef(Value&& val, const std::shared_ptr<const Context>&
 
 bool Expression::isLiteral() const { return false; }
 
+void Expression::generate(VectorType& output, const std::shared_ptr<const Context>& context) const
+{
+  output.emplace_back(evaluate(context));
+}
+
+void Expression::visitChildren(const ExpressionVisitor&, const BindingVisitor&) const {}
+
+static void visitArguments(const AssignmentList& arguments,
+                           const Expression::ExpressionVisitor& visitExpression)
+{
+  for (const auto& argument : arguments) {
+    if (argument->getExpr()) visitExpression(*argument->getExpr());
+  }
+}
+
+static void visitAssignments(const AssignmentList& assignments,
+                             const Expression::ExpressionVisitor& visitExpression,
+                             const Expression::BindingVisitor& visitBinding)
+{
+  for (const auto& assignment : assignments) {
+    visitBinding(assignment->getName());
+    if (assignment->getExpr()) visitExpression(*assignment->getExpr());
+  }
+}
+
 UnaryOp::UnaryOp(UnaryOp::Op op, Expression *expr, const Location& loc)
   : Expression(loc), op(op), expr(expr)
 {
@@ -101,6 +128,11 @@ void UnaryOp::print(std::ostream& stream, const std::string&) const
   stream << opString() << *this->expr;
 }
 
+void UnaryOp::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->expr);
+}
+
 BinaryOp::BinaryOp(Expression *left, BinaryOp::Op op, Expression *right, const Location& loc)
   : Expression(loc), op(op), left(left), right(right)
 {
@@ -183,6 +215,12 @@ void BinaryOp::print(std::ostream& stream, const std::string&) const
   stream << "(" << *this->left << " " << opString() << " " << *this->right << ")";
 }
 
+void BinaryOp::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->left);
+  visitExpression(*this->right);
+}
+
 TernaryOp::TernaryOp(Expression *cond, Expression *ifexpr, Expression *elseexpr, const Location& loc)
   : Expression(loc), cond(cond), ifexpr(ifexpr), elseexpr(elseexpr)
 {
@@ -203,6 +241,13 @@ void TernaryOp::print(std::ostream& stream, const std::string&) const
   stream << "(" << *this->cond << " ? " << *this->ifexpr << " : " << *this->elseexpr << ")";
 }
 
+void TernaryOp::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->cond);
+  visitExpression(*this->ifexpr);
+  visitExpression(*this->elseexpr);
+}
+
 ArrayLookup::ArrayLookup(Expression *array, Expression *index, const Location& loc)
   : Expression(loc), array(array), index(index)
 {
@@ -218,6 +263,12 @@ void ArrayLookup::print(std::ostream& stream, const std::string&) const
   stream << *array << "[" << *index << "]";
 }
 
+void ArrayLookup::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->array);
+  visitExpression(*this->index);
+}
+
 Value Literal::evaluate(const std::shared_ptr<const Context>&) const { return value.clone(); }
 
 void Literal::print(std::ostream& stream, const std::string&) const { stream << value; }
@@ -279,6 +330,13 @@ void Range::print(std::ostream& stream, const std::string&) const
   stream << "]";
 }
 
+void Range::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->begin);
+  if (this->step) visitExpression(*this->step);
+  visitExpression(*this->end);
+}
+
 bool Range::isLiteral() const
 {
   return this->step ? begin->isLiteral() && end->isLiteral() && step->isLiteral()
@@ -320,7 +378,7 @@ Value Vector::evaluate(const std::shared_ptr<const Context>& context) const
   } else {
     VectorType vec(context->session());
     vec.reserve(this->children.size());
-    for (const auto& e : this->children) vec.emplace_back(e->evaluate(context));
+    for (const auto& e : this->children) e->generate(vec, context);
     return std::move(vec);
   }
 }
@@ -335,6 +393,11 @@ void Vector::print(std::ostream& stream, const std::string&) const
   stream << "]";
 }
 
+void Vector::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  for (const auto& child : this->children) visitExpression(*child);
+}
+
 Lookup::Lookup(std::string name, const Location& loc) : Expression(loc), name(std::move(name)) {}
 
 Value Lookup::evaluate(const std::shared_ptr<const Context>& context) const
@@ -400,6 +463,11 @@ void MemberLookup::print(std::ostream& stream, const std::string&) const
   stream << *this->expr << "." << this->member;
 }
 
+void MemberLookup::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->expr);
+}
+
 FunctionDefinition::FunctionDefinition(Expression *expr, AssignmentList parameters, const Location& loc)
   : Expression(loc), context(nullptr), parameters(std::move(parameters)), expr(expr)
 {
@@ -424,6 +492,13 @@ void FunctionDefinition::print(std::ostream& stream, const std::string& indent)
   stream << ") " << *this->expr;
 }
 
+void FunctionDefinition::visitChildren(const ExpressionVisitor& visitExpression,
+                                       const BindingVisitor& visitBinding) const
+{
+  visitAssignments(this->parameters, visitExpression, visitBinding);
+  visitExpression(*this->expr);
+}
+
 /**
  * This is separated because PRINTB uses quite a lot of stack space
  * and the method using it evaluate()
@@ -490,6 +565,9 @@ struct SimplifiedExpression {
   const Expression *expression;
   boost::optional<ContextHandle<Context>> new_context = boost::none;
   boost::optional<const FunctionCall *> new_active_function_call = boost::none;
+  // The called function, if it is a named user function (whose results may be memoized).
+  const UserFunction *user_function = nullptr;
+  std::shared_ptr<const Context> defining_context = nullptr;
 };
 using SimplificationResult = std::variant<SimplifiedExpression, Value>;
 
@@ -520,6 +598,7 @@ static SimplificationResult simplify_function_body(const Expression *expression,
       const Expression *function_body;
       const AssignmentList *required_parameters;
       std::shared_ptr<const Context> defining_context;
+      const UserFunction *user_function = nullptr;
 
       auto f = call->evaluate_function_expression(context);
       if (!f) {
@@ -533,6 +612,7 @@ static SimplificationResult simplify_function_body(const Expression *expression,
           function_body = callable.function->expr.get();
           required_parameters = &callable.function->parameters;
           defining_context = callable.defining_context;
+          user_function = callable.function;
         } else {
           const FunctionType *function;
           if (index == 2) {
@@ -554,7 +634,8 @@ static SimplificationResult simplify_function_body(const Expression *expression,
                                                 *required_parameters, defining_context);
       body_context->apply_variables(std::move(parameters).to_context_frame());
 
-      return SimplifiedExpression{function_body, std::move(body_context), call};
+      return SimplifiedExpression{function_body, std::move(body_context), call, user_function,
+                                  std::move(defining_context)};
     } else {
       return expression->evaluate(context);
     }
@@ -576,18 +657,37 @@ Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) cons
   unsigned int recursion_depth = 0;
   const FunctionCall *current_call = this;
 
+  // With function memoization enabled, the result of this call (not of the tail calls it
+  // turns into) is cached, unless its evaluation printed anything.
+  FunctionMemo *memo = context->session()->functionMemo();
+  boost::optional<FunctionMemo::Key> memo_key;
+  size_t message_count = 0;
+
   ContextHandle<Context> expression_context{Context::create<Context>(context)};
   const Expression *expression = this;
   while (true) {
     try {
       auto result = simplify_function_body(expression, *expression_context);
       if (Value *value = std::get_if<Value>(&result)) {
+        if (memo_key && print_message_count() == message_count) {
+          memo->insert(std::move(*memo_key), value->clone());
+        }
         return std::move(*value);
       }
 
       SimplifiedExpression *simplified_expression = std::get_if<SimplifiedExpression>(&result);
       assert(simplified_expression);
 
+      if (memo && expression == this && simplified_expression->user_function) {
+        memo_key = memo->makeKey(*simplified_expression->user_function,
+                                 simplified_expression->defining_context,
+                                 **(*simplified_expression->new_context));
+        if (memo_key) {
+          if (auto cached = memo->lookup(*memo_key)) return std::move(*cached);
+          message_count = print_message_count();
+        }
+      }
+
       expression = simplified_expression->expression;
       if (simplified_expression->new_context) {
         expression_context = std::move(*simplified_expression->new_context);
@@ -613,6 +713,12 @@ void FunctionCall::print(std::ostream& stream, const std::string&) const
   stream << this->get_name() << "(" << this->arguments << ")";
 }
 
+void FunctionCall::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  if (!this->isLookup) visitExpression(*this->expr);
+  visitArguments(this->arguments, visitExpression);
+}
+
 Expression *FunctionCall::create(const std::string& funcname, const AssignmentList& arglist,
                                  Expression *expr, const Location& loc)
 {
@@ -674,6 +780,12 @@ void Assert::print(std::ostream& stream, const std::string&) const
   if (this->expr) stream << " " << *this->expr;
 }
 
+void Assert::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitArguments(this->arguments, visitExpression);
+  if (this->expr) visitExpression(*this->expr);
+}
+
 Echo::Echo(AssignmentList args, Expression *expr, const Location& loc)
   : Expression(loc), arguments(std::move(args)), expr(expr)
 {
@@ -698,6 +810,12 @@ void Echo::print(std::ostream& stream, const std::string&) const
   if (this->expr) stream << " " << *this->expr;
 }
 
+void Echo::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitArguments(this->arguments, visitExpression);
+  if (this->expr) visitExpression(*this->expr);
+}
+
 Let::Let(AssignmentList args, Expression *expr, const Location& loc)
   : Expression(loc), arguments(std::move(args)), expr(expr)
 {
@@ -750,21 +868,33 @@ void Let::print(std::ostream& stream, const std::string&) const
   stream << "let(" << this->arguments << ") " << *expr;
 }
 
+void Let::visitChildren(const ExpressionVisitor& visitExpression,
+                        const BindingVisitor& visitBinding) const
+{
+  visitAssignments(this->arguments, visitExpression, visitBinding);
+  if (this->expr) visitExpression(*this->expr);
+}
+
 ListComprehension::ListComprehension(const Location& loc) : Expression(loc) {}
 
+Value ListComprehension::evaluate(const std::shared_ptr<const Context>& context) const
+{
+  EmbeddedVectorType output(context->session());
+  generate(output, context);
+  return {std::move(output)};
+}
+
 LcIf::LcIf(Expression *cond, Expression *ifexpr, Expression *elseexpr, const Location& loc)
   : ListComprehension(loc), cond(cond), ifexpr(ifexpr), elseexpr(elseexpr)
 {
 }
 
-Value LcIf::evaluate(const std::shared_ptr<const Context>& context) const
+void LcIf::generate(VectorType& output, const std::shared_ptr<const Context>& context) const
 {
   const std::shared_ptr<Expression>& expr =
     this->cond->evaluate(context).toBool() ? this->ifexpr : this->elseexpr;
   if (expr) {
-    return expr->evaluate(context);
-  } else {
-    return EmbeddedVectorType::Empty();
+    expr->generate(output, context);
   }
 }
 
@@ -776,11 +906,18 @@ void LcIf::print(std::ostream& stream, const std::string&) const
   }
 }
 
+void LcIf::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->cond);
+  visitExpression(*this->ifexpr);
+  if (this->elseexpr) visitExpression(*this->elseexpr);
+}
+
 LcEach::LcEach(Expression *expr, const Location& loc) : ListComprehension(loc), expr(expr) {}
 
 // Need this for recurring into already embedded vectors, and performing "each" on their elements
 //    Context is only passed along for the possible use in Range warning.
-Value LcEach::evalRecur(Value&& v, const std::shared_ptr<const Context>& context) const
+void LcEach::append(Value&& v, VectorType& output, const std::shared_ptr<const Context>& context) const
 {
   if (v.type() == Value::Type::RANGE) {
     const RangeType& range = v.toRange();
@@ -789,38 +926,42 @@ Value LcEach::evalRecur(Value&& v, const std::shared_ptr<const Context>& context
       LOG(message_group::Warning, loc, context->documentRoot(),
           "Bad range parameter in for statement: too many elements (%1$lu)", steps);
     } else {
-      EmbeddedVectorType vec(context->session());
-      vec.reserve(range.numValues());
-      for (double d : range) vec.emplace_back(d);
-      return {std::move(vec)};
+      output.reserve_additional(steps);
+      for (double d : range) output.emplace_back(d);
     }
   } else if (v.type() == Value::Type::VECTOR) {
-    // Safe to move the overall vector ptr since we have a temporary value (could be a copy, or
-    // constructed just for us, doesn't matter)
-    auto vec = EmbeddedVectorType(std::move(v.toVectorNonConst()));
-    return {std::move(vec)};
+    const auto& vec = v.toVector();
+    output.reserve_additional(vec.size());
+    for (const auto& val : vec) output.emplace_back(val.clone());
   } else if (v.type() == Value::Type::EMBEDDED_VECTOR) {
-    EmbeddedVectorType vec(context->session());
-    vec.reserve(v.toEmbeddedVector().size());
     // Not safe to move values out of a vector, since it's shared_ptr maye be shared with another Value,
     // which should remain constant
-    for (const auto& val : v.toEmbeddedVector()) vec.emplace_back(evalRecur(val.clone(), context));
-    return {std::move(vec)};
+    for (const auto& val : v.toEmbeddedVector()) append(val.clone(), output, context);
   } else if (v.type() == Value::Type::STRING) {
-    EmbeddedVectorType vec(context->session());
     auto& wrapper = v.toStrUtf8Wrapper();
-    vec.reserve(wrapper.size());
-    for (auto ch : wrapper) vec.emplace_back(std::move(ch));
-    return {std::move(vec)};
+    output.reserve_additional(wrapper.size());
+    for (auto ch : wrapper) output.emplace_back(std::move(ch));
   } else if (v.type() != Value::Type::UNDEFINED) {
-    return std::move(v);
+    output.emplace_back(std::move(v));
   }
-  return EmbeddedVectorType::Empty();
 }
 
 Value LcEach::evaluate(const std::shared_ptr<const Context>& context) const
 {
-  return evalRecur(this->expr->evaluate(context), context);
+  Value v = this->expr->evaluate(context);
+  if (v.type() == Value::Type::VECTOR) {
+    // Safe to move the overall vector ptr since we have a temporary value (could be a copy, or
+    // constructed just for us, doesn't matter)
+    return EmbeddedVectorType(std::move(v.toVectorNonConst()));
+  }
+  EmbeddedVectorType output(context->session());
+  append(std::move(v), output, context);
+  return {std::move(output)};
+}
+
+void LcEach::generate(VectorType& output, const std::shared_ptr<const Context>& context) const
+{
+  append(this->expr->evaluate(context), output, context);
 }
 
 void LcEach::print(std::ostream& stream, const std::string&) const
@@ -828,6 +969,11 @@ void LcEach::print(std::ostream& stream, const std::string&) const
   stream << "each (" << *this->expr << ")";
 }
 
+void LcEach::visitChildren(const ExpressionVisitor& visitExpression, const BindingVisitor&) const
+{
+  visitExpression(*this->expr);
+}
+
 LcFor::LcFor(AssignmentList args, Expression *expr, const Location& loc)
   : ListComprehension(loc), arguments(std::move(args)), expr(expr)
 {
@@ -844,15 +990,15 @@ static inline ContextHandle<Context> forContext(const std::shared_ptr<const Cont
 static void doForEach(const AssignmentList& assignments, const Location& location,
                       const std::function<void(const std::shared_ptr<const Context>&)>& operation,
                       size_t assignment_index, const std::shared_ptr<const Context>& context,
-                      const std::function<void(size_t)> *pReserve = nullptr)
-{
-  if (assignment_index >= assignments.size()) {
-    operation(context);
-    return;
-  }
+                      const std::function<void(size_t)> *pReserve = nullptr);
 
+// Iterate over the already evaluated values of the assignment at assignment_index.
+static void doForEachValue(const AssignmentList& assignments, const Location& location,
+                           const std::function<void(const std::shared_ptr<const Context>&)>& operation,
+                           size_t assignment_index, const std::shared_ptr<const Context>& context,
+                           Value variable_values, const std::function<void(size_t)> *pReserve)
+{
   const std::string& variable_name = assignments[assignment_index]->getName();
-  Value variable_values = assignments[assignment_index]->getExpr()->evaluate(context);
 
   if (variable_values.type() == Value::Type::RANGE) {
     const RangeType& range = variable_values.toRange();
@@ -902,6 +1048,19 @@ static void doForEach(const AssignmentList& assignments, const Location& locatio
   }
 }
 
+static void doForEach(const AssignmentList& assignments, const Location& location,
+                      const std::function<void(const std::shared_ptr<const Context>&)>& operation,
+                      size_t assignment_index, const std::shared_ptr<const Context>& context,
+                      const std::function<void(size_t)> *pReserve)
+{
+  if (assignment_index >= assignments.size()) {
+    operation(context);
+    return;
+  }
+  doForEachValue(assignments, location, operation, assignment_index, context,
+                 assignments[assignment_index]->getExpr()->evaluate(context), pReserve);
+}
+
 void LcFor::forEach(const AssignmentList& assignments, const Location& loc,
                     const std::shared_ptr<const Context>& context,
                     const std::function<void(const std::shared_ptr<const Context>&)>& operation,
@@ -910,17 +1069,24 @@ void LcFor::forEach(const AssignmentList& assignments, const Location& loc,
   doForEach(assignments, loc, operation, 0, context, pReserve);
 }
 
-Value LcFor::evaluate(const std::shared_ptr<const Context>& context) const
-{
-  EmbeddedVectorType vec(context->session());
-  std::function<void(size_t)> reserve = [&vec](size_t capacity) { vec.reserve(capacity); };
-  forEach(
-    this->arguments, this->loc, context,
-    [&vec, expression = expr.get()](const std::shared_ptr<const Context>& iterationContext) {
-      vec.emplace_back(expression->evaluate(iterationContext));
-    },
-    &reserve);
-  return {std::move(vec)};
+void LcFor::generate(VectorType& output, const std::shared_ptr<const Context>& context) const
+{
+  // Estimated as one element per iteration, for each loop nested in the comprehension.
+  std::function<void(size_t)> reserve = [&output](size_t count) { output.reserve_additional(count); };
+  const std::function<void(const std::shared_ptr<const Context>&)> operation =
+    [&output, expression = expr.get()](const std::shared_ptr<const Context>& iterationContext) {
+      expression->generate(output, iterationContext);
+    };
+  auto *parallel = context->session()->parallelComprehension();
+  if (parallel && this->arguments.size() == 1) {
+    const auto& assignment = this->arguments[0];
+    Value values = assignment->getExpr()->evaluate(context);
+    if (!parallel->evaluate(assignment->getName(), values, *this->expr, context, output)) {
+      doForEachValue(this->arguments, this->loc, operation, 0, context, std::move(values), &reserve);
+    }
+    return;
+  }
+  forEach(this->arguments, this->loc, context, operation, &reserve);
 }
 
 void LcFor::print(std::ostream& stream, const std::string&) const
@@ -928,6 +1094,13 @@ void LcFor::print(std::ostream& stream, const std::string&) const
   stream << "for(" << this->arguments << ") (" << *this->expr << ")";
 }
 
+void LcFor::visitChildren(const ExpressionVisitor& visitExpression,
+                          const BindingVisitor& visitBinding) const
+{
+  visitAssignments(this->arguments, visitExpression, visitBinding);
+  visitExpression(*this->expr);
+}
+
 LcForC::LcForC(AssignmentList args, AssignmentList incrargs, Expression *cond, Expression *expr,
                const Location& loc)
   : ListComprehension(loc),
@@ -938,17 +1111,15 @@ LcForC::LcForC(AssignmentList args, AssignmentList incrargs, Expression *cond, E
 {
 }
 
-Value LcForC::evaluate(const std::shared_ptr<const Context>& context) const
+void LcForC::generate(VectorType& output, const std::shared_ptr<const Context>& context) const
 {
-  EmbeddedVectorType output(context->session());
-
   ContextHandle<Context> initialContext{
     Let::sequentialAssignmentContext(this->arguments, this->location(), context)};
   ContextHandle<Context> currentContext{Context::create<Context>(*initialContext)};
 
   unsigned int counter = 0;
   while (this->cond->evaluate(*currentContext).toBool()) {
-    output.emplace_back(this->expr->evaluate(*currentContext));
+    this->expr->generate(output, *currentContext);
 
     if (counter++ == 1000000) {
       LOG(message_group::Error, loc, context->documentRoot(), "For loop counter exceeded limit");
@@ -971,7 +1142,6 @@ Value LcForC::evaluate(const std::shared_ptr<const Context>& context) const
     currentContext = std::move(nextContext);
     currentContext->setParent(*initialContext);
   }
-  return {std::move(output)};
 }
 
 void LcForC::print(std::ostream& stream, const std::string&) const
@@ -980,18 +1150,34 @@ void LcForC::print(std::ostream& stream, const std::string&) const
          << *this->expr;
 }
 
+void LcForC::visitChildren(const ExpressionVisitor& visitExpression,
+                           const BindingVisitor& visitBinding) const
+{
+  visitAssignments(this->arguments, visitExpression, visitBinding);
+  visitAssignments(this->incr_arguments, visitExpression, visitBinding);
+  visitExpression(*this->cond);
+  visitExpression(*this->expr);
+}
+
 LcLet::LcLet(AssignmentList args, Expression *expr, const Location& loc)
   : ListComprehension(loc), arguments(std::move(args)), expr(expr)
 {
 }
 
-Value LcLet::evaluate(const std::shared_ptr<const Context>& context) const
+void LcLet::generate(VectorType& output, const std::shared_ptr<const Context>& context) const
 {
-  return this->expr->evaluate(
-    *Let::sequentialAssignmentContext(this->arguments, this->location(), context));
+  this->expr->generate(output,
+                       *Let::sequentialAssignmentContext(this->arguments, this->location(), context));
 }
 
 void LcLet::print(std::ostream& stream, const std::string&) const
 {
   stream << "let(" << this->arguments << ") (" << *this->expr << ")";
 }
+
+void LcLet::visitChildren(const ExpressionVisitor& visitExpression,
+                          const BindingVisitor& visitBinding) const
+{
+  visitAssignments(this->arguments, visitExpression, visitBinding);
+  visitExpression(*this->expr);
+}
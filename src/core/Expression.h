@@ -21,10 +21,21 @@ class ContextHandle;
 class Expression : public ASTNode
 {
 public:
+  using ExpressionVisitor = std::function<void(const Expression&)>;
+  using BindingVisitor = std::function<void(const std::string&)>;
+
   Expression(const Location& loc) : ASTNode(loc) {}
   [[nodiscard]] virtual bool isLiteral() const;
   [[nodiscard]] virtual Value evaluate(const std::shared_ptr<const Context>& context) const = 0;
   Value checkUndef(Value&& val, const std::shared_ptr<const Context>& context) const;
+  // Appends the elements this expression contributes to an enclosing list: its value, or for list
+  // comprehensions the elements they generate, which thus stream into the enclosing list directly.
+  virtual void generate(VectorType& output, const std::shared_ptr<const Context>& context) const;
+  // Calls visitExpression for each direct subexpression, and visitBinding for each name this
+  // expression binds for (some of) them, such as let() assignments or function literal parameters.
+  // Used for static analysis of expressions, see ExpressionPurity.h.
+  virtual void visitChildren(const ExpressionVisitor& visitExpression,
+                             const BindingVisitor& visitBinding) const;
 };
 
 class UnaryOp : public Expression
@@ -35,6 +46,8 @@ public:
   UnaryOp(Op op, Expression *expr, const Location& loc);
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   [[nodiscard]] const char *opString() const;
@@ -70,6 +83,8 @@ public:
   BinaryOp(Expression *left, Op op, Expression *right, const Location& loc);
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   [[nodiscard]] const char *opString() const;
@@ -86,6 +101,8 @@ public:
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   std::shared_ptr<Expression> cond;
@@ -99,6 +116,8 @@ public:
   ArrayLookup(Expression *array, Expression *index, const Location& loc);
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   std::shared_ptr<Expression> array;
@@ -136,6 +155,8 @@ public:
   [[nodiscard]] const Expression *getEnd() const { return end.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
   [[nodiscard]] bool isLiteral() const override;
 
 private:
@@ -151,6 +172,8 @@ public:
   const std::vector<std::shared_ptr<Expression>>& getChildren() const { return children; }
   Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
   void emplace_back(Expression *expr);
   bool isLiteral() const override;
 
@@ -177,6 +200,8 @@ public:
   MemberLookup(Expression *expr, std::string member, const Location& loc);
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   std::shared_ptr<Expression> expr;
@@ -191,6 +216,8 @@ public:
     const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
   [[nodiscard]] const std::string& get_name() const { return name; }
   static Expression *create(const std::string& funcname, const AssignmentList& arglist, Expression *expr,
                             const Location& loc);
@@ -208,6 +235,8 @@ public:
   FunctionDefinition(Expression *expr, AssignmentList parameters, const Location& loc);
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 public:
   std::shared_ptr<const Context> context;
@@ -224,6 +253,8 @@ public:
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   AssignmentList arguments;
@@ -237,6 +268,8 @@ public:
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   AssignmentList arguments;
@@ -255,6 +288,8 @@ public:
   const Expression *evaluateStep(ContextHandle<Context>& targetContext) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   AssignmentList arguments;
@@ -265,14 +300,19 @@ class ListComprehension : public Expression
 {
 public:
   ListComprehension(const Location& loc);
+  // The generated elements, embedded into the enclosing list.
+  [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
+  void generate(VectorType& output, const std::shared_ptr<const Context>& context) const override = 0;
 };
 
 class LcIf : public ListComprehension
 {
 public:
   LcIf(Expression *cond, Expression *ifexpr, Expression *elseexpr, const Location& loc);
-  [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
+  void generate(VectorType& output, const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   std::shared_ptr<Expression> cond;
@@ -288,8 +328,10 @@ public:
                       const std::shared_ptr<const Context>& context,
                       const std::function<void(const std::shared_ptr<const Context>&)>& operation,
                       const std::function<void(size_t)> *pReserve = nullptr);
-  [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
+  void generate(VectorType& output, const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   AssignmentList arguments;
@@ -301,8 +343,10 @@ class LcForC : public ListComprehension
 public:
   LcForC(AssignmentList args, AssignmentList incrargs, Expression *cond, Expression *expr,
          const Location& loc);
-  [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
+  void generate(VectorType& output, const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   AssignmentList arguments;
@@ -315,11 +359,15 @@ class LcEach : public ListComprehension
 {
 public:
   LcEach(Expression *expr, const Location& loc);
+  // Embeds a vector as is, instead of copying its elements.
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
+  void generate(VectorType& output, const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
-  Value evalRecur(Value&& v, const std::shared_ptr<const Context>& context) const;
+  void append(Value&& v, VectorType& output, const std::shared_ptr<const Context>& context) const;
   std::shared_ptr<Expression> expr;
 };
 
@@ -327,8 +375,10 @@ class LcLet : public ListComprehension
 {
 public:
   LcLet(AssignmentList args, Expression *expr, const Location& loc);
-  [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
+  void generate(VectorType& output, const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
+  void visitChildren(const ExpressionVisitor& visitExpression,
+                     const BindingVisitor& visitBinding) const override;
 
 private:
   AssignmentList arguments;
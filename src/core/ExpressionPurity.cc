@@ -0,0 +1,363 @@
+#include "core/ExpressionPurity.h"
+
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <typeinfo>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "core/BuiltinContext.h"
+#include "core/Builtins.h"
+#include "core/Context.h"
+#include "core/Expression.h"
+#include "core/function.h"
+#include "core/LocalScope.h"
+#include "core/module.h"
+#include "core/ModuleInstantiation.h"
+#include "core/ScopeContext.h"
+#include "core/SourceFile.h"
+#include "core/SourceFileCache.h"
+#include "core/UserModule.h"
+
+namespace {
+
+// Builtin functions whose result only depends on their arguments.
+// Notably absent: rands(), parent_module(), import(), dxf_dim(), dxf_cross() and the font functions.
+const std::unordered_set<std::string> pure_builtin_functions = {
+  "abs",      "sign",    "min",    "max",     "sin",       "cos",         "asin",        "acos",
+  "tan",      "atan",    "atan2",  "round",   "ceil",      "floor",       "pow",         "sqrt",
+  "exp",      "len",     "log",    "ln",      "str",       "chr",         "ord",         "concat",
+  "lookup",   "search",  "norm",   "cross",   "version",   "version_num", "is_undef",    "is_list",
+  "is_num",   "is_bool", "is_string", "is_function", "is_object", "object", "has_key",
+};
+
+// Builtin modules whose node only depends on their arguments and children.
+// Notably absent: echo(), assert(), import() and surface().
+const std::unordered_set<std::string> pure_builtin_modules = {
+  "cube",     "sphere",         "cylinder",         "polyhedron", "square",   "circle",
+  "polygon",  "text",           "translate",        "rotate",     "scale",    "mirror",
+  "multmatrix", "color",        "offset",           "union",      "difference", "intersection",
+  "hull",     "minkowski",      "fill",             "resize",     "render",   "group",
+  "projection", "linear_extrude", "rotate_extrude", "roof",       "children", "for",
+  "let",      "intersection_for", "if",
+};
+
+// Builtin modules reading the curve resolution special variables without them being passed explicitly.
+const std::unordered_set<std::string> curve_builtin_modules = {
+  "sphere", "cylinder", "circle", "text", "offset", "linear_extrude", "rotate_extrude", "roof",
+};
+
+// Builtin modules binding their arguments as variables of their children.
+const std::unordered_set<std::string> binding_builtin_modules = {"for", "let", "intersection_for"};
+
+// Where function names are resolved: either a run-time context, or statically the top-level of a file.
+//
+// Files are always analyzed statically: a used library gets a fresh FileContext for each call into it
+// (see FileContext::lookup_local_function()), so the analysis must hold for all of them.
+// Module bodies are analyzed statically as well, with the enclosing local scopes innermost last.
+struct Scope {
+  std::shared_ptr<const Context> context;
+  const SourceFile *file = nullptr;
+  std::vector<const LocalScope *> locals;
+};
+
+Scope scopeOf(const std::shared_ptr<const Context>& context)
+{
+  if (const auto *file_context = dynamic_cast<const FileContext *>(context.get())) {
+    return Scope{nullptr, file_context->sourceFile()};
+  }
+  return Scope{context};
+}
+
+class PurityAnalyzer
+{
+public:
+  PurityAnalysis result;
+
+  void analyzeFunction(const UserFunction& function, const Scope& scope)
+  {
+    if (!result.pure || !visited.insert(&function).second) return;
+    result.definitions.push_back(&function);
+    if (scope.file) analyzeFile(*scope.file);
+    std::set<std::string> bound;
+    for (const auto& parameter : function.parameters) {
+      bound.insert(parameter->getName());
+    }
+    // default values are evaluated in the defining context, parameters aren't bound yet
+    for (const auto& parameter : function.parameters) {
+      if (parameter->getExpr()) analyzeExpression(*parameter->getExpr(), {}, scope);
+    }
+    if (function.expr) analyzeExpression(*function.expr, std::move(bound), scope);
+  }
+
+  void analyzeExpression(const Expression& expression, std::set<std::string> bound, const Scope& scope)
+  {
+    std::vector<const FunctionCall *> calls;
+    collect(expression, bound, calls);
+    for (const auto *call : calls) {
+      if (!result.pure) return;
+      if (bound.count(call->name) || ContextFrame::is_config_variable(call->name)) {
+        // calls a function value, which we can't follow
+        result.pure = false;
+      } else {
+        analyzeCall(call->name, scope);
+      }
+    }
+  }
+
+  // `bound` holds the variables visible where a module is defined, for modules defined in module bodies.
+  void analyzeModule(const UserModule& module, const Scope& scope, std::set<std::string> bound)
+  {
+    if (!result.pure || !visited_modules.insert(&module).second) return;
+    result.definitions.push_back(&module);
+    if (scope.file) analyzeFile(*scope.file);
+    for (const auto& parameter : module.parameters) {
+      if (parameter->getExpr()) analyzeExpression(*parameter->getExpr(), bound, scope);
+    }
+    for (const auto& parameter : module.parameters) {
+      bound.insert(parameter->getName());
+    }
+    analyzeLocalScope(*module.body, std::move(bound), scope);
+  }
+
+  // A file's top-level variables are evaluated again for each FileContext created for it,
+  // so functions defined there also depend on whatever those assignments depend on.
+  void analyzeFile(const SourceFile& file)
+  {
+    if (!analyzed_files.insert(&file).second) return;
+    for (const auto& assignment : file.scope->assignments) {
+      result.definitions.push_back(assignment.get());
+      analyzeExpression(*assignment->getExpr(), {}, Scope{nullptr, &file});
+    }
+  }
+
+private:
+  std::set<const UserFunction *> visited;
+  std::set<const UserModule *> visited_modules;
+  std::set<const SourceFile *> analyzed_files;
+
+  void analyzeLocalScope(const LocalScope& local, std::set<std::string> bound, Scope scope)
+  {
+    scope.locals.push_back(&local);
+    // assignments are visible in the whole scope, not just after their definition
+    for (const auto& assignment : local.assignments) {
+      bound.insert(assignment->getName());
+    }
+    for (const auto& assignment : local.assignments) {
+      analyzeExpression(*assignment->getExpr(), bound, scope);
+    }
+    for (const auto& inst : local.moduleInstantiations) {
+      if (!result.pure) return;
+      analyzeInstantiation(*inst, bound, scope);
+    }
+  }
+
+  void analyzeInstantiation(const ModuleInstantiation& inst, const std::set<std::string>& bound,
+                            const Scope& scope)
+  {
+    auto child_bound = bound;
+    if (binding_builtin_modules.count(inst.name())) {
+      for (const auto& argument : inst.arguments) {
+        child_bound.insert(argument->getName());
+      }
+    }
+    for (const auto& argument : inst.arguments) {
+      analyzeExpression(*argument->getExpr(), child_bound, scope);
+    }
+    analyzeModuleCall(inst.name(), bound, scope);
+    // Children are evaluated in the calling context, whichever module instantiates them.
+    analyzeLocalScope(*inst.scope, child_bound, scope);
+    const auto *if_else = dynamic_cast<const IfElseModuleInstantiation *>(&inst);
+    if (if_else && if_else->getElseScope()) {
+      analyzeLocalScope(*if_else->getElseScope(), child_bound, scope);
+    }
+  }
+
+  void analyzeModuleCall(const std::string& name, const std::set<std::string>& bound,
+                         const Scope& scope)
+  {
+    for (auto it = scope.locals.rbegin(); it != scope.locals.rend(); ++it) {
+      if (const auto module = (*it)->lookup<UserModule *>(name)) {
+        analyzeModule(**module, scope, bound);
+        return;
+      }
+    }
+    if (!scope.file || ContextFrame::is_config_variable(name)) {
+      result.pure = false;
+      return;
+    }
+    if (const auto module = scope.file->scope->lookup<UserModule *>(name)) {
+      analyzeModule(**module, Scope{nullptr, scope.file}, {});
+      return;
+    }
+    for (const auto& library_name : scope.file->usedlibs) {
+      const auto *library = SourceFileCache::instance()->lookup(library_name);
+      if (const auto module = library ? library->scope->lookup<UserModule *>(name) : std::nullopt) {
+        analyzeModule(**module, Scope{nullptr, library}, {});
+        return;
+      }
+    }
+    const auto& modules = Builtins::instance()->getModules();
+    const auto it = modules.find(name);
+    if (it == modules.end() || !it->second->is_enabled() || !pure_builtin_modules.count(name)) {
+      result.pure = false;
+    } else if (curve_builtin_modules.count(name)) {
+      result.config_variables.insert({"$fn", "$fa", "$fs"});
+    }
+  }
+
+  // Gather the calls and bound names of an expression tree, and whatever can be decided locally.
+  // Bindings are collected for the whole tree, which can only make the analysis more conservative.
+  void collect(const Expression& expression, std::set<std::string>& bound,
+               std::vector<const FunctionCall *>& calls)
+  {
+    if (!result.pure) return;
+    const auto& type = typeid(expression);
+    if (type == typeid(Echo) || type == typeid(FunctionDefinition)) {
+      result.pure = false;
+      return;
+    } else if (type == typeid(FunctionCall)) {
+      const auto& call = static_cast<const FunctionCall&>(expression);
+      if (!call.isLookup) {
+        result.pure = false;
+        return;
+      }
+      calls.push_back(&call);
+    } else if (type == typeid(Lookup)) {
+      const auto& name = static_cast<const Lookup&>(expression).get_name();
+      if (ContextFrame::is_config_variable(name)) result.config_variables.insert(name);
+    }
+    expression.visitChildren(
+      [&](const Expression& child) { collect(child, bound, calls); },
+      [&](const std::string& name) { bound.insert(name); });
+  }
+
+  void analyzeCall(const std::string& name, const Scope& scope)
+  {
+    for (auto it = scope.locals.rbegin(); it != scope.locals.rend(); ++it) {
+      if (const auto function = (*it)->lookup<UserFunction *>(name)) {
+        analyzeFunction(**function, scope);
+        return;
+      }
+      for (const auto& assignment : (*it)->assignments) {
+        if (assignment->getName() == name) {
+          // might be a function value
+          result.pure = false;
+          return;
+        }
+      }
+    }
+    if (scope.file) {
+      analyzeStaticCall(name, *scope.file);
+      return;
+    }
+    for (const Context *context = scope.context.get(); context; context = context->getParent().get()) {
+      if (dynamic_cast<const BuiltinContext *>(context)) {
+        analyzeBuiltinContextCall(name, *context);
+        return;
+      }
+      if (const auto *file_context = dynamic_cast<const FileContext *>(context)) {
+        analyzeStaticCall(name, *file_context->sourceFile());
+        return;
+      }
+      const auto f = context->lookup_local_function(name, Location::NONE);
+      if (f) {
+        if (const auto *callable = std::get_if<CallableUserFunction>(&*f)) {
+          analyzeFunction(*callable->function, scopeOf(callable->defining_context));
+        } else {
+          result.pure = false;
+        }
+        return;
+      }
+    }
+    result.pure = false;
+  }
+
+  void analyzeStaticCall(const std::string& name, const SourceFile& file)
+  {
+    if (const auto function = file.scope->lookup<UserFunction *>(name)) {
+      analyzeFunction(**function, Scope{nullptr, &file});
+      return;
+    }
+    for (const auto& assignment : file.scope->assignments) {
+      if (assignment->getName() == name) {
+        // might be a function value
+        result.pure = false;
+        return;
+      }
+    }
+    if (const auto *library = findInUsedLibraries(name, file)) {
+      analyzeLibraryFunction(name, *library);
+    } else {
+      analyzeBuiltinCall(name);
+    }
+  }
+
+  void analyzeBuiltinContextCall(const std::string& name, const Context& builtin_context)
+  {
+    // builtin variables holding functions are not followed
+    if (builtin_context.ContextFrame::lookup_local_function(name, Location::NONE)) {
+      result.pure = false;
+    } else {
+      analyzeBuiltinCall(name);
+    }
+  }
+
+  void analyzeBuiltinCall(const std::string& name)
+  {
+    const auto& functions = Builtins::instance()->getFunctions();
+    const auto it = functions.find(name);
+    if (it == functions.end() || !it->second->is_enabled() || !pure_builtin_functions.count(name)) {
+      result.pure = false;
+    }
+  }
+
+  void analyzeLibraryFunction(const std::string& name, const SourceFile& library)
+  {
+    analyzeFunction(*library.scope->lookup<UserFunction *>(name).value(), Scope{nullptr, &library});
+  }
+
+  static const SourceFile *findInUsedLibraries(const std::string& name, const SourceFile& file)
+  {
+    for (const auto& library_name : file.usedlibs) {
+      const auto *library = SourceFileCache::instance()->lookup(library_name);
+      if (library && library->scope->lookup<UserFunction *>(name)) return library;
+    }
+    return nullptr;
+  }
+};
+
+}  // namespace
+
+PurityAnalysis analyze_function_purity(const UserFunction& function,
+                                       const std::shared_ptr<const Context>& defining_context)
+{
+  PurityAnalyzer analyzer;
+  analyzer.analyzeFunction(function, scopeOf(defining_context));
+  return analyzer.result;
+}
+
+PurityAnalysis analyze_expression_purity(const Expression& expression,
+                                         const std::set<std::string>& bound_names,
+                                         const std::shared_ptr<const Context>& context)
+{
+  PurityAnalyzer analyzer;
+  analyzer.analyzeExpression(expression, bound_names, scopeOf(context));
+  return analyzer.result;
+}
+
+PurityAnalysis analyze_module_purity(const UserModule& module,
+                                     const std::shared_ptr<const Context>& defining_context)
+{
+  PurityAnalyzer analyzer;
+  const auto scope = scopeOf(defining_context);
+  if (scope.file) {
+    analyzer.analyzeModule(module, scope, {});
+  } else {
+    analyzer.result.pure = false;
+  }
+  return analyzer.result;
+}
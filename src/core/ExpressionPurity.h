@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+class ASTNode;
+class Context;
+class Expression;
+class UserFunction;
+class UserModule;
+
+/**
+ * Result of a conservative static analysis of an expression.
+ *
+ * An expression is pure if evaluating it twice with the same variable values yields the same
+ * value, and has no observable side effects (no echo(), no random numbers, no file access).
+ * Anything the analysis cannot prove is treated as impure.
+ *
+ * Likewise, a module is pure if instantiating it twice with the same variable values yields equal
+ * node trees, without side effects.
+ */
+struct PurityAnalysis {
+  bool pure = true;
+  // Special ($) variables the expression may read, including those read by called functions.
+  std::set<std::string> config_variables;
+  // The user modules and functions the analysis followed, and the top-level assignments of their files,
+  // in the order they were analyzed.
+  std::vector<const ASTNode *> definitions;
+};
+
+// Analyze a user function called through the given defining context.
+PurityAnalysis analyze_function_purity(const UserFunction& function,
+                                       const std::shared_ptr<const Context>& defining_context);
+
+// Analyze an expression evaluated in a child of `context`, with `bound_names` bound in between.
+PurityAnalysis analyze_expression_purity(const Expression& expression,
+                                         const std::set<std::string>& bound_names,
+                                         const std::shared_ptr<const Context>& context);
+
+// Analyze a user module instantiated without children through the given defining context.
+// Only modules defined at the top-level of a file can be analyzed.
+PurityAnalysis analyze_module_purity(const UserModule& module,
+                                     const std::shared_ptr<const Context>& defining_context);
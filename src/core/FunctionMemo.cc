@@ -0,0 +1,240 @@
+#include "core/FunctionMemo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
+
+#include "core/Context.h"
+#include "core/ExpressionPurity.h"
+#include "core/function.h"
+#include "core/ScopeContext.h"
+#include "core/Value.h"
+
+namespace {
+
+// Vectors with up to this many (nested) elements are compared by value, larger ones by identity.
+// Identity is still exact, as keys hold on to the vectors they refer to, and results computed
+// from large vectors are mostly reused with the very same vector anyway (e.g. a polygon passed
+// down a recursion).
+constexpr size_t MAX_STRUCTURAL_ELEMENTS = 64;
+
+// Number of nested elements of v, or more than limit if there are more than that.
+size_t element_count(const Value& v, size_t limit)
+{
+  if (v.type() != Value::Type::VECTOR) return 1;
+  size_t count = 1;
+  for (const auto& element : v.toVector()) {
+    count += element_count(element, limit - count);
+    if (count > limit) break;
+  }
+  return count;
+}
+
+bool compare_structurally(const Value& v)
+{
+  return element_count(v, MAX_STRUCTURAL_ELEMENTS) <= MAX_STRUCTURAL_ELEMENTS;
+}
+
+// Estimated memory held by v, or more than limit if it holds more than that. Vectors are counted in
+// full even if they are shared with other values.
+size_t value_bytes(const Value& v, size_t limit)
+{
+  size_t bytes = sizeof(Value);
+  if (v.type() == Value::Type::STRING) {
+    bytes += v.toStrUtf8Wrapper().toString().size();
+  } else if (v.type() == Value::Type::VECTOR) {
+    for (const auto& element : v.toVector()) {
+      if (bytes > limit) break;
+      bytes += value_bytes(element, limit - bytes);
+    }
+  }
+  return bytes;
+}
+
+uint64_t double_bits(double d)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+const void *identity(const Value& v)
+{
+  const auto& variant = v.getVariant();
+  switch (v.type()) {
+  case Value::Type::VECTOR:          return std::get<VectorType>(variant).ptr.get();
+  case Value::Type::EMBEDDED_VECTOR: return std::get<EmbeddedVectorType>(variant).ptr.get();
+  case Value::Type::FUNCTION:        return std::get<FunctionPtr>(variant).get().get();
+  case Value::Type::OBJECT:          return std::get<ObjectType>(variant).ptr.get();
+  default:                           return nullptr;
+  }
+}
+
+void hash_value(size_t& seed, const Value& v, bool structural)
+{
+  boost::hash_combine(seed, static_cast<int>(v.type()));
+  switch (v.type()) {
+  case Value::Type::UNDEFINED: break;
+  case Value::Type::BOOL:      boost::hash_combine(seed, v.toBool()); break;
+  case Value::Type::NUMBER:    boost::hash_combine(seed, double_bits(v.toDouble())); break;
+  case Value::Type::STRING:    boost::hash_combine(seed, v.toStrUtf8Wrapper().toString()); break;
+  case Value::Type::RANGE:     {
+    const auto& range = v.toRange();
+    boost::hash_combine(seed, double_bits(range.begin_value()));
+    boost::hash_combine(seed, double_bits(range.step_value()));
+    boost::hash_combine(seed, double_bits(range.end_value()));
+    break;
+  }
+  case Value::Type::VECTOR:
+    if (structural) {
+      for (const auto& element : v.toVector()) hash_value(seed, element, true);
+      break;
+    }
+    [[fallthrough]];
+  default: boost::hash_combine(seed, identity(v)); break;
+  }
+}
+
+bool equal_values(const Value& a, const Value& b, bool structural)
+{
+  if (a.type() != b.type()) return false;
+  switch (a.type()) {
+  case Value::Type::UNDEFINED: return a.toUndefString() == b.toUndefString();
+  case Value::Type::BOOL:      return a.toBool() == b.toBool();
+  case Value::Type::NUMBER:    return double_bits(a.toDouble()) == double_bits(b.toDouble());
+  case Value::Type::STRING:    return a.toStrUtf8Wrapper().toString() == b.toStrUtf8Wrapper().toString();
+  case Value::Type::RANGE:     {
+    const auto& ra = a.toRange();
+    const auto& rb = b.toRange();
+    return double_bits(ra.begin_value()) == double_bits(rb.begin_value()) &&
+           double_bits(ra.step_value()) == double_bits(rb.step_value()) &&
+           double_bits(ra.end_value()) == double_bits(rb.end_value());
+  }
+  case Value::Type::VECTOR:
+    if (structural) {
+      const auto& va = a.toVector();
+      const auto& vb = b.toVector();
+      if (va.size() != vb.size()) return false;
+      for (size_t i = 0; i < va.size(); ++i) {
+        if (!equal_values(va[i], vb[i], true)) return false;
+      }
+      return true;
+    }
+    [[fallthrough]];
+  default: return identity(a) == identity(b);
+  }
+}
+
+}  // namespace
+
+size_t hash_call_values(size_t seed, const std::vector<Value>& values)
+{
+  for (const auto& value : values) {
+    hash_value(seed, value, compare_structurally(value));
+  }
+  return seed;
+}
+
+bool equal_call_values(const std::vector<Value>& a, const std::vector<Value>& b)
+{
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    const bool structural = compare_structurally(a[i]);
+    if (structural != compare_structurally(b[i]) || !equal_values(a[i], b[i], structural)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FunctionMemo::Key::operator==(const Key& other) const
+{
+  return function == other.function && file == other.file && equal_call_values(values, other.values);
+}
+
+const FunctionMemo::FunctionInfo& FunctionMemo::functionInfo(
+  const UserFunction& function, const std::shared_ptr<const Context>& defining_context)
+{
+  // Name resolution is lexical, so the analysis holds for every context the function is called from.
+  auto it = functions.find(&function);
+  if (it == functions.end()) {
+    auto analysis = analyze_function_purity(function, defining_context);
+    it = functions
+           .emplace(&function, FunctionInfo{analysis.pure, {analysis.config_variables.begin(),
+                                                            analysis.config_variables.end()}})
+           .first;
+  }
+  return it->second;
+}
+
+boost::optional<FunctionMemo::Key> FunctionMemo::makeKey(
+  const UserFunction& function, const std::shared_ptr<const Context>& defining_context,
+  const Context& body_context)
+{
+  // Functions defined in module bodies see the variables of one particular instantiation,
+  // which we don't attempt to identify. Top-level variables only depend on the file (and on
+  // the special variables they read, which the analysis includes).
+  const auto *file_context = dynamic_cast<const FileContext *>(defining_context.get());
+  if (!file_context) return boost::none;
+  const auto& info = functionInfo(function, defining_context);
+  if (!info.pure) return boost::none;
+
+  Key key;
+  key.function = &function;
+  key.file = file_context->sourceFile();
+  key.values.reserve(function.parameters.size() + info.config_variables.size());
+  for (const auto& parameter : function.parameters) {
+    const auto value = body_context.lookup_local_variable(parameter->getName());
+    key.values.push_back(value ? value->clone() : Value::undefined.clone());
+  }
+  for (const auto& name : info.config_variables) {
+    const auto value = body_context.try_lookup_variable(name);
+    key.values.push_back(value ? value->clone() : Value::undefined.clone());
+  }
+
+  key.hash = hash_call_values(std::hash<const void *>()(key.function), key.values);
+  return key;
+}
+
+boost::optional<Value> FunctionMemo::lookup(const Key& key)
+{
+  auto it = index.find(&key);
+  if (it == index.end()) {
+    ++miss_count;
+    return boost::none;
+  }
+  ++hit_count;
+  entries.splice(entries.begin(), entries, it->second);
+  return it->second->result.clone();
+}
+
+void FunctionMemo::insert(Key key, Value result)
+{
+  size_t bytes = sizeof(Entry) + value_bytes(result, MAX_ENTRY_BYTES);
+  for (const auto& value : key.values) {
+    if (bytes > MAX_ENTRY_BYTES) break;
+    bytes += value_bytes(value, MAX_ENTRY_BYTES - bytes);
+  }
+  if (bytes > MAX_ENTRY_BYTES) return;
+
+  entries.push_front(Entry{std::move(key), std::move(result), bytes});
+  if (!index.emplace(&entries.front().key, entries.begin()).second) {
+    // already stored by a nested call with the same arguments
+    entries.pop_front();
+    return;
+  }
+  total_bytes += bytes;
+  while (total_bytes > MAX_BYTES) {
+    total_bytes -= entries.back().bytes;
+    index.erase(&entries.back().key);
+    entries.pop_back();
+  }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "core/Value.h"
+
+class Context;
+class SourceFile;
+class UserFunction;
+
+// Hash and equality of the values identifying a cached call, see FunctionMemo::Key.
+// Small vectors are compared structurally, larger ones by identity.
+size_t hash_call_values(size_t seed, const std::vector<Value>& values);
+bool equal_call_values(const std::vector<Value>& a, const std::vector<Value>& b);
+
+/**
+ * Per-session cache of user function results, enabled by the function-memoization feature.
+ *
+ * Only functions which are pure according to analyze_function_purity() and defined at the
+ * top-level of a file are memoized. A call is identified by the function, its argument values
+ * and the values of the special variables it may read; argument values are compared structurally
+ * (see FunctionMemo::Key). The cache is bounded by an estimate of the memory it holds, and evicts
+ * the least recently used results.
+ */
+class FunctionMemo
+{
+public:
+  struct Key {
+    const UserFunction *function = nullptr;
+    const SourceFile *file = nullptr;
+    // Parameters in declaration order, followed by the special variables the function may read.
+    std::vector<Value> values;
+    size_t hash = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  // The key for a call whose parameters have been bound in body_context,
+  // or none if results of this function must not be cached.
+  boost::optional<Key> makeKey(const UserFunction& function,
+                               const std::shared_ptr<const Context>& defining_context,
+                               const Context& body_context);
+  boost::optional<Value> lookup(const Key& key);
+  void insert(Key key, Value result);
+
+  [[nodiscard]] size_t hits() const { return hit_count; }
+  [[nodiscard]] size_t misses() const { return miss_count; }
+
+  // The least recently used results are dropped once keys and results hold more than MAX_BYTES.
+  // Calls whose key or result alone is larger than MAX_ENTRY_BYTES are not cached.
+  static constexpr size_t MAX_BYTES = 64 * 1024 * 1024;
+  static constexpr size_t MAX_ENTRY_BYTES = 1024 * 1024;
+
+private:
+  struct FunctionInfo {
+    bool pure;
+    std::vector<std::string> config_variables;
+  };
+  struct Entry {
+    Key key;
+    Value result;
+    size_t bytes;
+  };
+  struct KeyHash {
+    size_t operator()(const Key *key) const { return key->hash; }
+  };
+  struct KeyEqual {
+    bool operator()(const Key *a, const Key *b) const { return *a == *b; }
+  };
+
+  const FunctionInfo& functionInfo(const UserFunction& function,
+                                   const std::shared_ptr<const Context>& defining_context);
+
+  std::unordered_map<const UserFunction *, FunctionInfo> functions;
+  std::list<Entry> entries;  // most recently used first
+  std::unordered_map<const Key *, std::list<Entry>::iterator, KeyHash, KeyEqual> index;
+  size_t total_bytes = 0;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+};
@@ -92,6 +92,7 @@ static std::shared_ptr<AbstractNode> do_import(const ModuleInstantiation *inst,
     else if (ext == ".amf") actualtype = ImportType::AMF;
     else if (ext == ".svg") actualtype = ImportType::SVG;
     else if (ext == ".obj") actualtype = ImportType::OBJ;
+    else if (ext == ".ogeom") actualtype = ImportType::OGEOM;
   }
 
   auto node =
@@ -217,6 +218,17 @@ std::unique_ptr<const Geometry> ImportNode::createGeometry() const
     g = optionally_center(import_obj(this->filename, loc), this->center);
     break;
   }
+  case ImportType::OGEOM: {
+    auto geom = import_ogeom(this->filename, loc);
+    if (geom->getDimension() == 2) {
+      auto poly = std::unique_ptr<Polygon2d>(static_cast<Polygon2d *>(geom.release()));
+      g = optionally_center(std::move(poly), this->center);
+    } else {
+      auto ps = std::unique_ptr<PolySet>(static_cast<PolySet *>(geom.release()));
+      g = optionally_center(std::move(ps), this->center);
+    }
+    break;
+  }
   case ImportType::SVG: {
     g =
       import_svg(this->discretizer, this->filename, this->id, this->layer, this->dpi, this->center, loc);
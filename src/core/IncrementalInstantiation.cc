@@ -0,0 +1,242 @@
+#include "core/IncrementalInstantiation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "core/AST.h"
+#include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/ExpressionPurity.h"
+#include "core/LocalScope.h"
+#include "core/ModuleInstantiation.h"
+#include "core/node.h"
+#include "core/ScopeContext.h"
+#include "core/UserModule.h"
+#include "core/Value.h"
+
+struct IncrementalInstantiation::Definition {
+  struct Entry {
+    std::vector<std::shared_ptr<AbstractNode>> children;
+    // The module bodies the children refer to, including those of nested reused results.
+    std::vector<std::shared_ptr<const Bodies>> bodies;
+    unsigned int generation;
+  };
+  std::unordered_map<std::string, Entry> calls;
+};
+
+struct IncrementalInstantiation::Store {
+  // by the text of the definitions, see IncrementalInstantiation::moduleInfo()
+  std::unordered_map<std::string, Definition> definitions;
+  // of the latest evaluation
+  unsigned int generation = 0;
+  // when a session last used it, to drop the stores of documents no longer evaluated
+  size_t last_used = 0;
+  // sessions using it, which keep it from being dropped
+  size_t sessions = 0;
+};
+
+namespace {
+
+// Most documents whose results are kept
+constexpr size_t MAX_DOCUMENTS = 16;
+
+// One store per root file, so evaluating one document doesn't drop the results of another.
+IncrementalInstantiation::Store& store_for(const std::string& document)
+{
+  static std::unordered_map<std::string, IncrementalInstantiation::Store> stores;
+  static size_t clock = 0;
+  if (!stores.count(document) && stores.size() >= MAX_DOCUMENTS) {
+    auto oldest = stores.end();
+    for (auto it = stores.begin(); it != stores.end(); ++it) {
+      if (it->second.sessions > 0) continue;
+      if (oldest == stores.end() || it->second.last_used < oldest->second.last_used) oldest = it;
+    }
+    if (oldest != stores.end()) stores.erase(oldest);
+  }
+  auto& store = stores[document];
+  store.last_used = ++clock;
+  ++store.sessions;
+  return store;
+}
+
+constexpr char END_OF_LIST = '\xff';
+
+template <typename T>
+void append_bytes(std::string& out, const T& value)
+{
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out.append(bytes, sizeof(T));
+}
+
+void append_string(std::string& out, const std::string& str)
+{
+  append_bytes(out, str.size());
+  out += str;
+}
+
+// Append an exact encoding of value. Returns false for function literals, which can't be compared
+// across evaluations as they refer to the context they were defined in.
+bool encode_value(const Value& value, std::string& out)
+{
+  out.push_back(static_cast<char>(value.type()));
+  switch (value.type()) {
+  case Value::Type::UNDEFINED: return true;
+  case Value::Type::BOOL:      out.push_back(value.toBool() ? 1 : 0); return true;
+  case Value::Type::NUMBER:    append_bytes(out, value.toDouble()); return true;
+  case Value::Type::STRING:    append_string(out, value.toStrUtf8Wrapper().toString()); return true;
+  case Value::Type::VECTOR:
+    for (const auto& element : value.toVector()) {
+      if (!encode_value(element, out)) return false;
+    }
+    out.push_back(END_OF_LIST);
+    return true;
+  case Value::Type::RANGE: {
+    const auto& range = value.toRange();
+    append_bytes(out, range.begin_value());
+    append_bytes(out, range.step_value());
+    append_bytes(out, range.end_value());
+    return true;
+  }
+  case Value::Type::OBJECT: {
+    const auto& object = value.toObject();
+    for (size_t i = 0; i < object.keys().size(); ++i) {
+      append_string(out, object.keys()[i]);
+      if (!encode_value(object.values()[i], out)) return false;
+    }
+    out.push_back(END_OF_LIST);
+    return true;
+  }
+  default: return false;
+  }
+}
+
+// Nodes refer to the module instantiations they were created for, for their location.
+void append_locations(const LocalScope& scope, std::ostream& stream)
+{
+  for (const auto& inst : scope.moduleInstantiations) {
+    const auto& loc = inst->location();
+    stream << loc.firstLine() << ',' << loc.firstColumn() << ',' << loc.lastLine() << ','
+           << loc.lastColumn() << ' ';
+    append_locations(*inst->scope, stream);
+    const auto *if_else = dynamic_cast<const IfElseModuleInstantiation *>(inst.get());
+    if (if_else && if_else->getElseScope()) append_locations(*if_else->getElseScope(), stream);
+  }
+}
+
+}  // namespace
+
+IncrementalInstantiation::IncrementalInstantiation() = default;
+
+IncrementalInstantiation::~IncrementalInstantiation()
+{
+  if (!store) return;
+  --store->sessions;
+  // A session which didn't instantiate any user modules doesn't tell what is still needed.
+  if (hit_count + miss_count == 0) return;
+  auto& definitions = store->definitions;
+  for (auto it = definitions.begin(); it != definitions.end();) {
+    auto& calls = it->second.calls;
+    for (auto call = calls.begin(); call != calls.end();) {
+      if (call->second.generation != store->generation) call = calls.erase(call);
+      else ++call;
+    }
+    if (calls.empty()) it = definitions.erase(it);
+    else ++it;
+  }
+}
+
+void IncrementalInstantiation::setDocument(const std::string& document)
+{
+  if (store) return;
+  store = &store_for(document);
+  ++store->generation;
+}
+
+const IncrementalInstantiation::ModuleInfo& IncrementalInstantiation::moduleInfo(
+  const UserModule& module, const std::shared_ptr<const Context>& defining_context)
+{
+  auto it = modules.find(&module);
+  if (it != modules.end()) return it->second;
+
+  ModuleInfo info;
+  auto analysis = analyze_module_purity(module, defining_context);
+  if (analysis.pure) {
+    std::ostringstream text;
+    auto bodies = std::make_shared<Bodies>();
+    for (const auto *definition : analysis.definitions) {
+      if (const auto *user_module = dynamic_cast<const UserModule *>(definition)) {
+        text << user_module->location().fileName() << ' ';
+        append_locations(*user_module->body, text);
+        bodies->push_back(user_module->body);
+      }
+      definition->print(text, "");
+    }
+    info.definition = &store->definitions[text.str()];
+    info.config_variables.assign(analysis.config_variables.begin(), analysis.config_variables.end());
+    info.bodies = std::move(bodies);
+  }
+  return modules.emplace(&module, std::move(info)).first->second;
+}
+
+boost::optional<IncrementalInstantiation::Key> IncrementalInstantiation::makeKey(
+  const UserModule& module, const ModuleInstantiation& inst,
+  const std::shared_ptr<const Context>& defining_context, const Context& module_context)
+{
+  // children() would instantiate the caller's children, which the key doesn't identify
+  if (!store || inst.scope->numElements() > 0) return boost::none;
+  if (!dynamic_cast<const FileContext *>(defining_context.get())) return boost::none;
+  const auto& info = moduleInfo(module, defining_context);
+  if (!info.definition) return boost::none;
+
+  Key key;
+  key.definition = info.definition;
+  for (const auto& parameter : module.parameters) {
+    const auto value = module_context.lookup_local_variable(parameter->getName());
+    if (!encode_value(value ? *value : Value::undefined, key.call)) return boost::none;
+  }
+  for (const auto& name : info.config_variables) {
+    const auto value = module_context.try_lookup_variable(name);
+    if (!encode_value(value ? *value : Value::undefined, key.call)) return boost::none;
+  }
+  // Coarse previews must not hand out their nodes to full ones, nor the other way around.
+  append_bytes(key.call, module_context.session()->fragmentLimit());
+  key.bodies = info.bodies;
+  key.mark = reused.size();
+  return key;
+}
+
+std::shared_ptr<AbstractNode> IncrementalInstantiation::lookup(const Key& key,
+                                                               const ModuleInstantiation *inst,
+                                                               const std::string& name)
+{
+  const auto it = key.definition->calls.find(key.call);
+  if (it == key.definition->calls.end()) {
+    ++miss_count;
+    return nullptr;
+  }
+  ++hit_count;
+  auto& entry = it->second;
+  entry.generation = store->generation;
+  reused.insert(reused.end(), entry.bodies.begin(), entry.bodies.end());
+  auto node = std::make_shared<GroupNode>(inst, name);
+  node->children = entry.children;
+  return node;
+}
+
+void IncrementalInstantiation::insert(Key key, const std::shared_ptr<AbstractNode>& node)
+{
+  std::vector<std::shared_ptr<const Bodies>> bodies(reused.begin() + key.mark, reused.end());
+  bodies.push_back(std::move(key.bodies));
+  std::sort(bodies.begin(), bodies.end());
+  bodies.erase(std::unique(bodies.begin(), bodies.end()), bodies.end());
+  key.definition->calls[std::move(key.call)] =
+    Definition::Entry{node->children, std::move(bodies), store->generation};
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/optional.hpp>
+
+class AbstractNode;
+class Context;
+class LocalScope;
+class ModuleInstantiation;
+class UserModule;
+
+/**
+ * Cache of user module instantiations kept across evaluations, enabled by the incremental-instantiation
+ * feature.
+ *
+ * After an edit, modules which don't depend on the edited code reuse the nodes built by previous
+ * evaluations instead of being instantiated again. A result is recorded together with everything it was
+ * built from, as found by analyze_module_purity():
+ * - the text and location of the modules and functions it follows,
+ * - the top-level assignments of their files,
+ * - the parameter values of the call, and the values of the special variables the module may read,
+ * - the fragment limit of the session.
+ * Files are parsed again for every evaluation, so definitions are identified by their text rather than
+ * by their AST nodes. A changed included or used file changes the text of what is defined in it.
+ *
+ * As with NodeSharing, only pure modules defined at the top-level of a file and instantiated without
+ * children are cached. A reused result gets a new node for its call site, whose children are those of
+ * the previous evaluation; the cache keeps the module bodies they were instantiated from alive.
+ *
+ * Results are kept per document, the root file passed to setDocument(). Those which the latest
+ * evaluation of the document neither reused nor created are dropped when its session ends. The results
+ * of the documents evaluated least recently are dropped when more than a few are open.
+ */
+class IncrementalInstantiation
+{
+public:
+  struct Definition;
+  struct Store;
+  using Bodies = std::vector<std::shared_ptr<LocalScope>>;
+
+  IncrementalInstantiation();
+  ~IncrementalInstantiation();
+
+  struct Key {
+    Definition *definition = nullptr;
+    // Parameter values followed by those of the special variables the module may read, encoded.
+    std::string call;
+    // The bodies of the modules followed, which the nodes of the instantiation refer to.
+    std::shared_ptr<const Bodies> bodies;
+    // Bodies kept alive for reused results are logged in reused; those from mark on are nested in this
+    // instantiation.
+    size_t mark = 0;
+  };
+
+  // Selects the results of the given root file. Nothing is cached before it is called.
+  void setDocument(const std::string& document);
+
+  // The key for an instantiation, or none if its result must not be cached.
+  boost::optional<Key> makeKey(const UserModule& module, const ModuleInstantiation& inst,
+                               const std::shared_ptr<const Context>& defining_context,
+                               const Context& module_context);
+  // A node for the call site inst with the children of a previous instantiation, or null.
+  std::shared_ptr<AbstractNode> lookup(const Key& key, const ModuleInstantiation *inst,
+                                       const std::string& name);
+  void insert(Key key, const std::shared_ptr<AbstractNode>& node);
+
+  [[nodiscard]] size_t hits() const { return hit_count; }
+  [[nodiscard]] size_t misses() const { return miss_count; }
+
+private:
+  struct ModuleInfo {
+    // null if the module isn't cached
+    Definition *definition = nullptr;
+    std::vector<std::string> config_variables;
+    std::shared_ptr<const Bodies> bodies;
+  };
+
+  const ModuleInfo& moduleInfo(const UserModule& module,
+                               const std::shared_ptr<const Context>& defining_context);
+
+  Store *store = nullptr;
+  std::unordered_map<const UserModule *, ModuleInfo> modules;
+  std::vector<std::shared_ptr<const Bodies>> reused;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+};
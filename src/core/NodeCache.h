@@ -34,6 +34,15 @@ public:
     return rootString.substr(indexpair.first, indexpair.second - indexpair.first);
   }
 
+  // Nodes shared by several parents (see NodeSharing) are dumped once per parent,
+  // only the first occurrence is recorded.
+  bool hasStart(const size_t nodeidx) const { return this->cache.count(nodeidx) != 0; }
+  bool hasEnd(const size_t nodeidx) const
+  {
+    auto result = this->cache.find(nodeidx);
+    return result != this->cache.end() && result->second.second >= 0L;
+  }
+
   void insertStart(const size_t nodeidx, const long startindex)
   {
     assert(this->cache.count(nodeidx) == 0 && "start index inserted twice");
@@ -30,6 +30,8 @@ int GroupNodeChecker::getChildCount(int groupNodeIndex) const
 Response GroupNodeChecker::visit(State& state, const GroupNode& node)
 {
   if (state.isPrefix()) {
+    // shared nodes have been counted at their first occurrence
+    if (!this->visited.insert(node.index()).second) return Response::PruneTraversal;
     // create entry for group node, which children may increment
     this->groupChildCounts.emplace(node.index(), 0);
   } else if (state.isPostfix()) {
@@ -40,9 +42,11 @@ Response GroupNodeChecker::visit(State& state, const GroupNode& node)
   return Response::ContinueTraversal;
 }
 
-Response GroupNodeChecker::visit(State& state, const AbstractNode&)
+Response GroupNodeChecker::visit(State& state, const AbstractNode& node)
 {
-  if (state.isPostfix() && state.parent()) {
+  if (state.isPrefix()) {
+    if (!this->visited.insert(node.index()).second) return Response::PruneTraversal;
+  } else if (state.isPostfix() && state.parent()) {
     this->incChildCount(state.parent()->index());
   }
   return Response::ContinueTraversal;
@@ -91,7 +95,9 @@ Response NodeDumper::visit(State& state, const GroupNode& node)
 #endif
 
     // insert start index
-    this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    if (!this->cache.hasStart(node.index())) {
+      this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    }
 
     if (this->groupChecker.getChildCount(node.index()) > 1) {
       this->dumpstream << node << "{";
@@ -103,7 +109,9 @@ Response NodeDumper::visit(State& state, const GroupNode& node)
       this->dumpstream << "}";
     }
     // insert end index
-    this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    if (!this->cache.hasEnd(node.index())) {
+      this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    }
 
     // For handling root modifier '!'
     // Check if we are processing the root of the current Tree and finalize cache
@@ -139,7 +147,9 @@ Response NodeDumper::visit(State& state, const AbstractNode& node)
 #endif
 
     // insert start index
-    this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    if (!this->cache.hasStart(node.index())) {
+      this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    }
 
     if (this->idString) {
       static const boost::regex re(R"([^\s\"]+|\"(?:[^\"\\]|\\.)*\")");
@@ -185,7 +195,9 @@ Response NodeDumper::visit(State& state, const AbstractNode& node)
     }
 
     // insert end index
-    this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    if (!this->cache.hasEnd(node.index())) {
+      this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    }
 
     // For handling root modifier '!'
     // Check if we are processing the root of the current Tree and finalize cache
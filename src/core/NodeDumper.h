@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include "core/NodeVisitor.h"
 #include "core/node.h"
@@ -23,11 +24,17 @@ public:
   Response visit(State& state, const GroupNode& node) override;
   void incChildCount(int groupNodeIndex);
   int getChildCount(int groupNodeIndex) const;
-  void reset() { groupChildCounts.clear(); }
+  void reset()
+  {
+    groupChildCounts.clear();
+    visited.clear();
+  }
 
 private:
   // stores <node_idx,nonEmptyChildCount> for each group node
   std::unordered_map<int, int> groupChildCounts;
+  // nodes shared by several parents (see NodeSharing) are only traversed once
+  std::unordered_set<int> visited;
 };
 
 class NodeDumper : public NodeVisitor
@@ -0,0 +1,85 @@
+#include "core/NodeSharing.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
+
+#include "core/Context.h"
+#include "core/ExpressionPurity.h"
+#include "core/FunctionMemo.h"
+#include "core/LocalScope.h"
+#include "core/ModuleInstantiation.h"
+#include "core/node.h"
+#include "core/ScopeContext.h"
+#include "core/UserModule.h"
+#include "core/Value.h"
+
+bool NodeSharing::Key::operator==(const Key& other) const
+{
+  return module == other.module && inst == other.inst && file == other.file &&
+         equal_call_values(values, other.values);
+}
+
+const NodeSharing::ModuleInfo& NodeSharing::moduleInfo(
+  const UserModule& module, const std::shared_ptr<const Context>& defining_context)
+{
+  auto it = modules.find(&module);
+  if (it == modules.end()) {
+    auto analysis = analyze_module_purity(module, defining_context);
+    it = modules
+           .emplace(&module, ModuleInfo{analysis.pure, {analysis.config_variables.begin(),
+                                                        analysis.config_variables.end()}})
+           .first;
+  }
+  return it->second;
+}
+
+boost::optional<NodeSharing::Key> NodeSharing::makeKey(
+  const UserModule& module, const ModuleInstantiation& inst,
+  const std::shared_ptr<const Context>& defining_context, const Context& module_context)
+{
+  // children() would instantiate the caller's children, which the key doesn't identify
+  if (inst.scope->numElements() > 0) return boost::none;
+  const auto *file_context = dynamic_cast<const FileContext *>(defining_context.get());
+  if (!file_context) return boost::none;
+  const auto& info = moduleInfo(module, defining_context);
+  if (!info.pure) return boost::none;
+
+  Key key;
+  key.module = &module;
+  key.inst = &inst;
+  key.file = file_context->sourceFile();
+  key.values.reserve(module.parameters.size() + info.config_variables.size());
+  for (const auto& parameter : module.parameters) {
+    const auto value = module_context.lookup_local_variable(parameter->getName());
+    key.values.push_back(value ? value->clone() : Value::undefined.clone());
+  }
+  for (const auto& name : info.config_variables) {
+    const auto value = module_context.try_lookup_variable(name);
+    key.values.push_back(value ? value->clone() : Value::undefined.clone());
+  }
+
+  size_t seed = std::hash<const void *>()(key.module);
+  boost::hash_combine(seed, key.inst);
+  key.hash = hash_call_values(seed, key.values);
+  return key;
+}
+
+std::shared_ptr<AbstractNode> NodeSharing::lookup(const Key& key)
+{
+  auto it = nodes.find(key);
+  if (it == nodes.end()) {
+    ++miss_count;
+    return nullptr;
+  }
+  ++hit_count;
+  return it->second;
+}
+
+void NodeSharing::insert(Key key, std::shared_ptr<AbstractNode> node)
+{
+  nodes.emplace(std::move(key), std::move(node));
+}
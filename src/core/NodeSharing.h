@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "core/Value.h"
+
+class AbstractNode;
+class Context;
+class ModuleInstantiation;
+class SourceFile;
+class UserModule;
+
+/**
+ * Per-session table of user module instantiations, enabled by the node-sharing feature.
+ *
+ * Repeated instantiations of a pure module (see analyze_module_purity()) from the same call site,
+ * with the same parameter and special variable values, return the very same node. The node tree
+ * thus becomes a DAG, and visitors see shared subtrees once per parent (see NodeCache).
+ *
+ * Only modules defined at the top-level of a file and instantiated without children are shared.
+ * The call site is part of the key, as the module's node refers to it for its location and modifiers.
+ */
+class NodeSharing
+{
+public:
+  struct Key {
+    const UserModule *module = nullptr;
+    const ModuleInstantiation *inst = nullptr;
+    const SourceFile *file = nullptr;
+    // Parameters in declaration order, followed by the special variables the module may read.
+    std::vector<Value> values;
+    size_t hash = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  // The key for an instantiation whose parameters have been bound in module_context,
+  // or none if the resulting node must not be shared.
+  boost::optional<Key> makeKey(const UserModule& module, const ModuleInstantiation& inst,
+                               const std::shared_ptr<const Context>& defining_context,
+                               const Context& module_context);
+  std::shared_ptr<AbstractNode> lookup(const Key& key);
+  void insert(Key key, std::shared_ptr<AbstractNode> node);
+
+  [[nodiscard]] size_t hits() const { return hit_count; }
+  [[nodiscard]] size_t misses() const { return miss_count; }
+
+private:
+  struct ModuleInfo {
+    bool pure;
+    std::vector<std::string> config_variables;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  const ModuleInfo& moduleInfo(const UserModule& module,
+                               const std::shared_ptr<const Context>& defining_context);
+
+  std::unordered_map<const UserModule *, ModuleInfo> modules;
+  std::unordered_map<Key, std::shared_ptr<AbstractNode>, KeyHash> nodes;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+};
@@ -0,0 +1,156 @@
+#include "core/ParallelComprehension.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/Context.h"
+#include "core/ContextFrame.h"
+#include "core/EvaluationSession.h"
+#include "core/Expression.h"
+#include "core/ExpressionPurity.h"
+#include "core/Value.h"
+#include "utils/printutils.h"
+#include "utils/StackCheck.h"
+
+namespace {
+
+// Same limit as the serial loop, which warns about larger ranges.
+constexpr size_t MAX_RANGE_ITERATIONS = 1000000;
+
+// Workers read the variables of the loop's context chain and of the frames on the special variable
+// stack. Everything else they evaluate lives in contexts of their own.
+void freeze_shared_values(const Context& context)
+{
+  for (const Context *c = &context; c != nullptr; c = c->getParent().get()) {
+    for (const Value *value : c->list_embedded_values()) value->freeze();
+  }
+  for (const ContextFrame *frame : context.session()->frames()) {
+    for (const Value *value : frame->list_embedded_values()) value->freeze();
+  }
+}
+
+}  // namespace
+
+ParallelComprehension::ParallelComprehension()
+#ifdef __EMSCRIPTEN__
+  : threads(1)
+#else
+  : threads(std::thread::hardware_concurrency())
+#endif
+{
+}
+
+bool ParallelComprehension::evaluate(const std::string& name, const Value& values, const Expression& body,
+                                     const std::shared_ptr<const Context>& context, VectorType& output)
+{
+  size_t count;
+  if (values.type() == Value::Type::RANGE) {
+    count = values.toRange().numValues();
+    if (count >= MAX_RANGE_ITERATIONS) return false;
+  } else if (values.type() == Value::Type::VECTOR) {
+    count = values.toVector().size();
+  } else {
+    return false;
+  }
+  if (threads < 2 || count < MIN_ITERATIONS) return false;
+
+  values.freeze();
+  const auto value_at = [&values](size_t i) -> Value {
+    if (values.type() == Value::Type::RANGE) {
+      // as computed by RangeType::iterator
+      const auto& range = values.toRange();
+      return i == 0 ? range.begin_value() : range.begin_value() + range.step_value() * i;
+    }
+    return values.toVector()[i].clone();
+  };
+  const auto evaluate_serially = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ContextHandle<Context> iteration{Context::create<Context>(context)};
+      iteration->set_variable(name, value_at(i));
+      body.generate(output, *iteration);
+    }
+  };
+
+  output.reserve_additional(count);
+  const auto start = std::chrono::steady_clock::now();
+  evaluate_serially(0, PILOT_ITERATIONS);
+  const std::chrono::duration<double> estimate =
+    (std::chrono::steady_clock::now() - start) *
+    (static_cast<double>(count - PILOT_ITERATIONS) / PILOT_ITERATIONS);
+  if (estimate < MIN_PARALLEL_WORK || !analyze_expression_purity(body, {name}, context).pure) {
+    evaluate_serially(PILOT_ITERATIONS, count);
+    return true;
+  }
+
+  freeze_shared_values(*context);
+
+  struct Chunk {
+    size_t begin;
+    size_t end;
+    VectorType results{nullptr};
+    bool done = false;
+  };
+  const size_t remaining = count - PILOT_ITERATIONS;
+  const size_t num_chunks = std::min<size_t>(size_t{threads} * CHUNKS_PER_THREAD, remaining);
+  std::vector<Chunk> chunks(num_chunks);
+  for (size_t k = 0; k < num_chunks; ++k) {
+    chunks[k].begin = PILOT_ITERATIONS + remaining * k / num_chunks;
+    chunks[k].end = PILOT_ITERATIONS + remaining * (k + 1) / num_chunks;
+  }
+
+  // Chunks are handed out in order, so once one fails, the ones still to be handed out are useless.
+  std::atomic<size_t> next_chunk{0};
+  std::atomic<bool> failed{false};
+  EvaluationSession *session = context->session();
+  const auto work = [&]() {
+    StackCheck::inst().reset(WORKER_STACK_LIMIT);
+    EvaluationSession worker_session(session);
+    WorkerSessionScope scope(&worker_session);
+    for (size_t k; !failed && (k = next_chunk++) < num_chunks;) {
+      Chunk& chunk = chunks[k];
+      suppress_thread_messages(true);
+      try {
+        chunk.results = VectorType(&worker_session);
+        chunk.results.reserve(chunk.end - chunk.begin);
+        for (size_t i = chunk.begin; i < chunk.end && !suppressed_thread_message_count(); ++i) {
+          ContextHandle<Context> iteration{Context::create<Context>(context)};
+          iteration->set_variable(name, value_at(i));
+          body.generate(chunk.results, *iteration);
+        }
+        chunk.done = !suppressed_thread_message_count();
+      } catch (...) {
+      }
+      suppress_thread_messages(false);
+      if (!chunk.done) failed = true;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  try {
+    for (unsigned int i = 0; i < threads; ++i) workers.emplace_back(work);
+  } catch (const std::system_error&) {
+    // whatever isn't done is evaluated below
+    failed = true;
+  }
+  for (auto& worker : workers) worker.join();
+
+  size_t resume = count;
+  for (auto& chunk : chunks) {
+    if (!chunk.done) {
+      resume = chunk.begin;
+      break;
+    }
+    output.reserve_additional(chunk.results.size());
+    for (const auto& result : chunk.results) output.emplace_back(result.clone());
+  }
+  evaluate_serially(resume, count);
+  return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "core/Value.h"
+
+class Context;
+class Expression;
+
+/**
+ * Parallel evaluation of list comprehensions, enabled by the parallel-comprehensions feature.
+ *
+ * The iterations of `[for (i = values) body]` over a range or vector, with a body free of side effects
+ * according to analyze_expression_purity(), are split into chunks. Worker threads evaluate the chunks,
+ * each in a worker session of its own (see WorkerSessionScope), and the results are appended in order.
+ *
+ * The first iterations are evaluated on the calling thread to estimate the remaining work. Loops which
+ * would take less than MIN_PARALLEL_WORK are completed there as well.
+ *
+ * Workers don't print anything. From the first chunk on which failed or had anything to report, the
+ * workers' results are dropped and the calling thread evaluates the rest of the loop itself, so messages
+ * and errors are exactly those of serial evaluation.
+ */
+class ParallelComprehension
+{
+public:
+  ParallelComprehension();
+
+  // Generate body for each of values (a range or vector) bound to name in a child of context, appending
+  // the elements to output. Returns false without evaluating anything if the loop doesn't qualify.
+  bool evaluate(const std::string& name, const Value& values, const Expression& body,
+                const std::shared_ptr<const Context>& context, VectorType& output);
+
+  static constexpr size_t MIN_ITERATIONS = 64;
+  static constexpr size_t PILOT_ITERATIONS = 16;
+  static constexpr std::chrono::microseconds MIN_PARALLEL_WORK{2000};
+  // More chunks than threads, as the cost of iterations may vary.
+  static constexpr size_t CHUNKS_PER_THREAD = 4;
+  // Thread stacks may be as small as 512 KiB (macOS). Chunks recursing deeper fail over to the caller.
+  static constexpr unsigned long WORKER_STACK_LIMIT = 384ul * 1024ul;
+
+private:
+  unsigned int threads;
+};
@@ -64,6 +64,7 @@ public:
   ContextFrame to_context_frame() &&;
 
   const std::string& documentRoot() const { return frame.documentRoot(); }
+  EvaluationSession *session() const { return frame.session(); }
   const Location& location() const { return loc; }
 
   static constexpr auto THIS_PARAMETER = "this";
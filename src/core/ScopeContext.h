@@ -57,6 +57,7 @@ public:
                                                           const Location& loc) const override;
   boost::optional<InstantiableModule> lookup_local_module(const std::string& name,
                                                           const Location& loc) const override;
+  [[nodiscard]] const SourceFile *sourceFile() const { return source_file; }
 
 protected:
   FileContext(const std::shared_ptr<const Context>& parent, const SourceFile *source_file)
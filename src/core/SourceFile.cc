@@ -27,7 +27,10 @@
 #include "core/SourceFile.h"
 
 #include "core/EvaluationSession.h"
+#include "core/FunctionMemo.h"
+#include "core/IncrementalInstantiation.h"
 #include "core/node.h"
+#include "core/NodeSharing.h"
 #include "core/ScopeContext.h"
 #include "core/SourceFileCache.h"
 #include "core/parsersettings.h"
@@ -186,7 +189,31 @@ std::shared_ptr<AbstractNode> SourceFile::instantiate(
   try {
     ContextHandle<FileContext> file_context{Context::create<FileContext>(context, this)};
     *resulting_file_context = *file_context;
+    if (auto *incremental = context->session()->incrementalInstantiation()) {
+      incremental->setDocument(this->getFullpath());
+    }
     this->scope->instantiateModules(*file_context, node);
+    if (const auto *memo = context->session()->functionMemo()) {
+      const size_t calls = memo->hits() + memo->misses();
+      if (calls > 0) {
+        LOG("Function memoization: %1$d hits, %2$d misses (%3$d%% hit rate)", memo->hits(),
+            memo->misses(), 100 * memo->hits() / calls);
+      }
+    }
+    if (const auto *sharing = context->session()->nodeSharing()) {
+      const size_t instantiations = sharing->hits() + sharing->misses();
+      if (instantiations > 0) {
+        LOG("Node sharing: %1$d shared, %2$d instantiated (%3$d%% shared)", sharing->hits(),
+            sharing->misses(), 100 * sharing->hits() / instantiations);
+      }
+    }
+    if (const auto *incremental = context->session()->incrementalInstantiation()) {
+      const size_t instantiations = incremental->hits() + incremental->misses();
+      if (instantiations > 0) {
+        LOG("Incremental instantiation: %1$d reused, %2$d instantiated (%3$d%% reused)",
+            incremental->hits(), incremental->misses(), 100 * incremental->hits() / instantiations);
+      }
+    }
   } catch (HardWarningException& e) {
     throw;
   } catch (EvaluationException& e) {
@@ -32,9 +32,12 @@
 
 #include "core/AST.h"
 #include "core/Arguments.h"
+#include "core/EvaluationSession.h"
 #include "core/Expression.h"
+#include "core/IncrementalInstantiation.h"
 #include "core/ModuleInstantiation.h"
 #include "core/node.h"
+#include "core/NodeSharing.h"
 #include "core/ScopeContext.h"
 #include "utils/compiler_specific.h"
 #include "utils/exceptions.h"
@@ -43,6 +46,8 @@
 #include <cstddef>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <boost/optional.hpp>
 
 std::vector<std::string> StaticModuleNameStack::stack;
 
@@ -104,6 +109,31 @@ std::shared_ptr<AbstractNode> UserModule::instantiate(
   PRINTDB("%s", module_context->dump());
 #endif
 
+  NodeSharing *sharing = context->session()->nodeSharing();
+  boost::optional<NodeSharing::Key> key;
+  size_t message_count = 0;
+  if (sharing) {
+    key = sharing->makeKey(*this, *inst, defining_context, **module_context);
+    if (key) {
+      if (auto node = sharing->lookup(*key)) return node;
+      // a node whose instantiation printed anything must be instantiated again, to print it again
+      message_count = print_message_count();
+    }
+  }
+
+  IncrementalInstantiation *incremental = context->session()->incrementalInstantiation();
+  boost::optional<IncrementalInstantiation::Key> incremental_key;
+  if (incremental) {
+    incremental_key = incremental->makeKey(*this, *inst, defining_context, **module_context);
+    if (incremental_key) {
+      if (auto node = incremental->lookup(*incremental_key, inst, std::string("module ") + this->name)) {
+        if (key) sharing->insert(std::move(*key), node);
+        return node;
+      }
+      if (!key) message_count = print_message_count();
+    }
+  }
+
   std::shared_ptr<AbstractNode> ret;
   try {
     ret = this->body->instantiateModules(
@@ -115,6 +145,10 @@ std::shared_ptr<AbstractNode> UserModule::instantiate(
     }
     throw;
   }
+  if (print_message_count() == message_count) {
+    if (key) sharing->insert(std::move(*key), ret);
+    if (incremental_key) incremental->insert(std::move(*incremental_key), ret);
+  }
   return ret;
 }
 
@@ -26,6 +26,7 @@
 
 #include "core/Value.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <cmath>
 #include <variant>
@@ -42,6 +43,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "core/EvaluationSession.h"
+#include "core/VectorIndexCache.h"
 #include "io/fileutils.h"
 #include "utils/exceptions.h"
 #include "utils/printutils.h"
@@ -546,23 +548,74 @@ public:
 
 std::string Value::chrString() const { return std::visit(chr_visitor(), this->value); }
 
+void Value::freeze() const
+{
+  // Not recursive, as lists built by recursive functions can be nested arbitrarily deep.
+  std::vector<const Value *> pending{this};
+  while (!pending.empty()) {
+    const Value *v = pending.back();
+    pending.pop_back();
+    if (v->type() == Type::VECTOR || v->type() == Type::EMBEDDED_VECTOR) {
+      const VectorType& vector = v->type() == Type::VECTOR ? std::get<VectorType>(v->value)
+                                                            : std::get<EmbeddedVectorType>(v->value);
+      if (vector.ptr->frozen) continue;
+      if (vector.ptr->embed_excess) vector.flatten();
+      vector.ptr->frozen = true;
+      for (const auto& element : vector.ptr->vec) pending.push_back(&element);
+    } else if (v->type() == Type::OBJECT) {
+      const auto& object = std::get<ObjectType>(v->value);
+      object.contains(std::string());  // builds the key index
+      for (const auto& element : object.values()) pending.push_back(&element);
+    }
+  }
+}
+
+VectorType::VectorObject::~VectorObject() { delete index_cache.load(std::memory_order_relaxed); }
+
+void VectorType::VectorObject::drop_index_cache()
+{
+  if (index_cache.load(std::memory_order_relaxed)) delete index_cache.exchange(nullptr);
+}
+
+VectorIndexCache& VectorType::index_cache() const
+{
+  VectorIndexCache *cache = ptr->index_cache.load(std::memory_order_acquire);
+  if (!cache) {
+    auto fresh = std::make_unique<VectorIndexCache>();
+    if (ptr->index_cache.compare_exchange_strong(cache, fresh.get(), std::memory_order_acq_rel)) {
+      cache = fresh.release();
+    }
+  }
+  return *cache;
+}
+
 VectorType::VectorType(EvaluationSession *session)
   : ptr(std::shared_ptr<VectorObject>(new VectorObject(), VectorObjectDeleter()))
 {
-  ptr->evaluation_session = session;
+  ptr->evaluation_session = session ? session->valueSession() : nullptr;
 }
 
 VectorType::VectorType(class EvaluationSession *session, double x, double y, double z)
   : ptr(std::shared_ptr<VectorObject>(new VectorObject(), VectorObjectDeleter()))
 {
-  ptr->evaluation_session = session;
+  ptr->evaluation_session = session ? session->valueSession() : nullptr;
   emplace_back(x);
   emplace_back(y);
   emplace_back(z);
 }
 
+void VectorType::reserve_additional(size_t count)
+{
+  const size_t needed = ptr->vec.size() + count;
+  if (needed > ptr->vec.capacity()) {
+    ptr->vec.reserve(std::max(needed, 2 * ptr->vec.capacity()));
+  }
+}
+
 void VectorType::emplace_back(Value&& val)
 {
+  ptr->drop_index_cache();
+  ptr->frozen = false;
   if (val.type() == Value::Type::EMBEDDED_VECTOR) {
     emplace_back(std::move(val.toEmbeddedVectorNonConst()));
   } else {
@@ -580,6 +633,8 @@ void VectorType::emplace_back(EmbeddedVectorType&& mbed)
     // embed_excess represents how many to add to vec.size() to get the total elements after flattening,
     // the embedded vector itself already counts towards an element in the parent's size, so subtract 1
     // from its size.
+    ptr->drop_index_cache();
+    ptr->frozen = false;
     ptr->embed_excess += mbed.size() - 1;
     ptr->vec.emplace_back(std::move(mbed));
     if (ptr->evaluation_session) {
@@ -1361,7 +1416,7 @@ ObjectType::ObjectType(const std::shared_ptr<ObjectObject>& copy) : ptr(copy) {}
 
 ObjectType::ObjectType(EvaluationSession *session) : ptr(std::make_shared<ObjectObject>())
 {
-  ptr->evaluation_session = session;
+  ptr->evaluation_session = session ? session->valueSession() : nullptr;
 }
 
 const Value& ObjectType::get(const std::string& key) const { return ptr->get(key); }
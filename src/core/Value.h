@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <ostream>
 #include <memory>
@@ -20,6 +21,7 @@
 class tostring_visitor;
 class tostream_visitor;
 class EvaluationSession;
+class VectorIndexCache;
 class Expression;
 class Value;
 
@@ -121,6 +123,16 @@ public:
         0;  // Keep count of the number of embedded elements *excess of* vec.size()
       class EvaluationSession *evaluation_session =
         nullptr;  // Used for heap size bookkeeping. May be null for vectors of known small maximum size.
+      // Lazily built lookup()/search() acceleration structures, see VectorIndexCache.h.
+      // Owned by this object and discarded whenever the contents change.
+      mutable std::atomic<VectorIndexCache *> index_cache{nullptr};
+      // Set once this vector and all nested values are frozen, see Value::freeze().
+      bool frozen = false;
+      VectorObject() = default;
+      VectorObject(const VectorObject&) = delete;
+      VectorObject& operator=(const VectorObject&) = delete;
+      ~VectorObject();
+      void drop_index_cache();
       [[nodiscard]] size_type size() const { return vec.size() + embed_excess; }
       [[nodiscard]] bool empty() const { return vec.empty() && embed_excess == 0; }
     };
@@ -140,6 +152,7 @@ public:
     void flatten() const;  // flatten replaces VectorObject::vec with a new vector
                            // where any embedded elements are copied directly into the top level vec,
                            // leaving only true elements for straightforward indexing by operator[].
+    friend class Value;  // freeze() flattens nested vectors
     explicit VectorType(const std::shared_ptr<VectorObject>& copy) : ptr(copy) {}  // called by clone()
   public:
     using size_type = VectorObject::size_type;
@@ -235,6 +248,9 @@ public:
     static Value Empty() { return VectorType(nullptr); }
 
     void reserve(size_t size) { ptr->vec.reserve(size); }
+    // Make room for count more elements. Grows geometrically, as loops nested in a comprehension each
+    // reserve for their own elements of the same vector.
+    void reserve_additional(size_t count);
 
     [[nodiscard]] const_iterator begin() const { return iterator(ptr.get()); }
     [[nodiscard]] const_iterator end() const { return iterator(ptr.get(), true); }
@@ -257,6 +273,8 @@ public:
     Value operator<=(const VectorType& v) const;
     Value operator>=(const VectorType& v) const;
     [[nodiscard]] class EvaluationSession *evaluation_session() const { return ptr->evaluation_session; }
+    // Returns the index cache attached to this vector's contents, creating it on first use.
+    [[nodiscard]] VectorIndexCache& index_cache() const;
 
     void emplace_back(Value&& val);
     void emplace_back(EmbeddedVectorType&& mbed);
@@ -374,6 +392,10 @@ public:
   [[nodiscard]] const UndefType& toUndef() const;
   [[nodiscard]] std::string toUndefString() const;
   [[nodiscard]] std::string chrString() const;
+  // Complete the lazily built parts of the vectors and objects nested in this value (flattening of
+  // embedded vectors, key indexes of objects). Afterwards, reading the value no longer modifies it,
+  // so several threads can do so at once.
+  void freeze() const;
   bool getVec2(double& x, double& y, bool ignoreInfinite = false) const;
   bool getVec3(double& x, double& y, double& z) const;
   bool getVec3(double& x, double& y, double& z, double defaultval) const;
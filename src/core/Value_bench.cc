@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/AST.h"
+#include "core/BuiltinContext.h"
+#include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/Value.h"
+
+static void BM_Value_NumberArithmetic(benchmark::State& state)
+{
+  const Value a(1.5);
+  const Value b(2.25);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a * b + a / b - b);
+  }
+}
+BENCHMARK(BM_Value_NumberArithmetic);
+
+static void BM_Value_VectorArithmetic(benchmark::State& state)
+{
+  EvaluationSession session{""};
+  VectorType va(&session);
+  VectorType vb(&session);
+  for (int i = 0; i < state.range(0); ++i) {
+    va.emplace_back(double(i));
+    vb.emplace_back(double(2 * i));
+  }
+  const Value a(std::move(va));
+  const Value b(std::move(vb));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a + b);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Value_VectorArithmetic)->Arg(3)->Arg(1000);
+
+// Looks up a variable defined range(0) contexts up the chain, as for top-level variables in recursions.
+static void BM_Context_Lookup(benchmark::State& state)
+{
+  EvaluationSession session{""};
+  ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
+  std::vector<ContextHandle<Context>> chain;
+  chain.push_back(Context::create<Context>(*builtin_context));
+  chain.back()->set_variable("target", Value(1.0));
+  for (int i = 1; i < state.range(0); ++i) {
+    chain.push_back(Context::create<Context>(*chain.back()));
+    chain.back()->set_variable("v" + std::to_string(i), Value(double(i)));
+  }
+  const auto& innermost = chain.back();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(innermost->lookup_variable("target", Location::NONE));
+    benchmark::DoNotOptimize(innermost->lookup_variable("$fn", Location::NONE));
+  }
+  while (!chain.empty()) chain.pop_back();
+}
+BENCHMARK(BM_Context_Lookup)->Arg(1)->Arg(64);
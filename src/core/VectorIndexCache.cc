@@ -0,0 +1,137 @@
+#include "core/VectorIndexCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/Value.h"
+
+LookupTable::LookupTable(const VectorType& table)
+{
+  auto it = table.begin();
+  if (table.empty() || !it->getVec2(first.key, first.value) || std::isnan(first.key)) return;
+
+  entries.reserve(table.size());
+  for (; it != table.end(); ++it) {
+    double key, value;
+    // nan keys never compare as closer than any other entry, so they can't be selected
+    if (it->getVec2(key, value) && !std::isnan(key)) entries.push_back({key, value});
+  }
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry& a, const Entry& b) { return a.key < b.key; });
+  usable_ = true;
+}
+
+void LookupTable::find(double p, double& low_p, double& low_v, double& high_p, double& high_v) const
+{
+  const auto key_less = [](const Entry& e, double k) { return e.key < k; };
+  const auto less_key = [](double k, const Entry& e) { return k < e.key; };
+
+  // Low: first entry with the largest key <= p, or the first table entry if there is none.
+  auto above = std::upper_bound(entries.begin(), entries.end(), p, less_key);
+  const Entry& low =
+    above == entries.begin()
+      ? first
+      : *std::lower_bound(entries.begin(), entries.end(), std::prev(above)->key, key_less);
+  // High: first entry with the smallest key >= p, or the first table entry if there is none.
+  auto high_it = std::lower_bound(entries.begin(), entries.end(), p, key_less);
+  const Entry& high = high_it == entries.end() ? first : *high_it;
+
+  low_p = low.key;
+  low_v = low.value;
+  high_p = high.key;
+  high_v = high.value;
+}
+
+SearchColumnIndex::SearchColumnIndex(const VectorType& table, size_t column)
+  : first_short_row(table.size())
+{
+  uint32_t row = 0;
+  for (const auto& element : table) {
+    const auto& entry = element.toVector();
+
+    // search(number|vector, ...) compares the column value, or for column 0 also the row itself
+    const Value *candidate = nullptr;
+    if (column < entry.size()) candidate = &entry[column];
+    else if (column == 0 && element.type() != Value::Type::VECTOR) candidate = &element;
+    if (candidate) {
+      switch (candidate->type()) {
+      case Value::Type::NUMBER: {
+        const double d = candidate->toDouble();
+        if (!std::isnan(d)) numbers[d + 0.0].push_back(row);  // + 0.0 folds -0 into 0
+        break;
+      }
+      case Value::Type::STRING: strings[candidate->toString()].push_back(row); break;
+      case Value::Type::BOOL:   bools[candidate->toBool()].push_back(row); break;
+      default:                  break;
+      }
+    }
+
+    // search(string, ...) compares the first character of the column value
+    if (entry.size() <= column) {
+      first_short_row = std::min(first_short_row, static_cast<size_t>(row));
+    } else if (entry[column].type() == Value::Type::STRING &&
+               !entry[column].toStrUtf8Wrapper().empty()) {
+      first_chars[entry[column].toStrUtf8Wrapper().get_utf8_char()].push_back(row);
+    }
+    ++row;
+  }
+}
+
+const SearchColumnIndex::RowList *SearchColumnIndex::find(const Value& needle) const
+{
+  static const RowList none;
+  switch (needle.type()) {
+  case Value::Type::NUMBER: {
+    const double d = needle.toDouble();
+    if (std::isnan(d)) return &none;
+    auto it = numbers.find(d + 0.0);
+    return it == numbers.end() ? &none : &it->second;
+  }
+  case Value::Type::STRING: {
+    auto it = strings.find(needle.toString());
+    return it == strings.end() ? &none : &it->second;
+  }
+  case Value::Type::BOOL: return &bools[needle.toBool()];
+  default:                return nullptr;
+  }
+}
+
+const SearchColumnIndex::RowList& SearchColumnIndex::findChar(uint32_t ch) const
+{
+  static const RowList none;
+  auto it = first_chars.find(ch);
+  return it == first_chars.end() ? none : it->second;
+}
+
+bool VectorIndexCache::worthIndexing()
+{
+  return queries.fetch_add(1, std::memory_order_relaxed) + 1 >= INDEX_AFTER_QUERIES;
+}
+
+const LookupTable *VectorIndexCache::lookupTable(const VectorType& table)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!lookup) {
+    if (!worthIndexing()) return nullptr;
+    lookup = std::make_unique<LookupTable>(table);
+  }
+  return lookup->usable() ? lookup.get() : nullptr;
+}
+
+const SearchColumnIndex *VectorIndexCache::searchIndex(const VectorType& table, size_t column)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& index = search_columns[column];
+  if (!index) {
+    if (!worthIndexing()) return nullptr;
+    index = std::make_unique<SearchColumnIndex>(table, column);
+  }
+  return index.get();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Value.h"
+
+/**
+ * Sorted [key, value] table used to answer lookup() by binary search.
+ *
+ * Built from the same entries the linear scan in builtin_lookup() accepts (valid vec2 entries),
+ * and reproduces its tie-breaking: among entries with equal keys, the first one wins.
+ */
+class LookupTable
+{
+public:
+  explicit LookupTable(const VectorType& table);
+
+  // False if the table cannot be answered from the index (e.g. first key is nan),
+  // in which case the caller must fall back to the linear scan.
+  [[nodiscard]] bool usable() const { return usable_; }
+  void find(double p, double& low_p, double& low_v, double& high_p, double& high_v) const;
+
+private:
+  struct Entry {
+    double key;
+    double value;
+  };
+  std::vector<Entry> entries;  // sorted by key, stable w.r.t. the original order
+  Entry first{0, 0};           // the first table entry, which the linear scan starts from
+  bool usable_ = false;
+};
+
+/**
+ * Hash index over one column of a search() table.
+ *
+ * Rows are listed in ascending order for each key, so taking a prefix of a row list gives the
+ * same result as the linear scan stopping after num_returns_per_match matches.
+ */
+class SearchColumnIndex
+{
+public:
+  using RowList = std::vector<uint32_t>;
+  SearchColumnIndex(const VectorType& table, size_t column);
+
+  // Rows whose column value compares equal to needle, or nullptr if needle
+  // is not a hashable scalar (the caller must then fall back to the linear scan).
+  [[nodiscard]] const RowList *find(const Value& needle) const;
+  // Rows whose column value is a string starting with the given unicode character.
+  [[nodiscard]] const RowList& findChar(uint32_t ch) const;
+  // First row too short to contain the column, as reported by search(string, vector).
+  [[nodiscard]] size_t firstShortRow() const { return first_short_row; }
+
+private:
+  std::unordered_map<double, RowList> numbers;
+  std::unordered_map<std::string, RowList> strings;
+  RowList bools[2];
+  std::unordered_map<uint32_t, RowList> first_chars;
+  size_t first_short_row;
+};
+
+/**
+ * Acceleration structures attached to a VectorObject, see VectorType::index_cache().
+ *
+ * Since vector contents are immutable once built, indexes stay valid for the lifetime
+ * of the vector and are shared by every Value referring to it. Building one costs more
+ * than a single linear scan, so indexes are only built once a table is queried repeatedly.
+ */
+class VectorIndexCache
+{
+public:
+  // Return nullptr if the table has not been queried often enough to be worth indexing.
+  const LookupTable *lookupTable(const VectorType& table);
+  const SearchColumnIndex *searchIndex(const VectorType& table, size_t column);
+
+private:
+  bool worthIndexing();
+
+  static constexpr unsigned int INDEX_AFTER_QUERIES = 2;
+  std::atomic<unsigned int> queries{0};
+  std::mutex mutex;
+  std::unique_ptr<LookupTable> lookup;
+  std::unordered_map<size_t, std::unique_ptr<SearchColumnIndex>> search_columns;
+};
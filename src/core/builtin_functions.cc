@@ -35,6 +35,7 @@
 #include "core/FreetypeRenderer.h"
 #include "core/Parameters.h"
 #include "core/UserModule.h"
+#include "core/VectorIndexCache.h"
 #include "utils/printutils.h"
 #include "utils/degree_trig.h"
 #include "io/import.h"
@@ -411,11 +412,18 @@ Value builtin_ln(Arguments arguments, const Location& loc)
 
 Value builtin_str(Arguments arguments, const Location& /*loc*/)
 {
-  std::ostringstream stream;
+  // Strings are passed on as they are, so accumulating a string with repeated str() calls is linear.
+  std::vector<str_utf8_wrapper> pieces;
+  pieces.reserve(arguments.size());
   for (const auto& argument : arguments) {
-    stream << argument->toString();
+    if (argument->type() == Value::Type::STRING) {
+      pieces.push_back(argument->toStrUtf8Wrapper().clone());
+    } else {
+      pieces.emplace_back(argument->toString());
+    }
   }
-  return {stream.str()};
+  if (pieces.empty()) return {str_utf8_wrapper()};
+  return {str_utf8_wrapper::concat(std::move(pieces))};
 }
 
 Value builtin_chr(Arguments arguments, const Location& /*loc*/)
@@ -621,16 +629,22 @@ Value builtin_lookup(Arguments arguments, const Location& loc)
   high_p = low_p;
   high_v = low_v;
 
-  for (++it; it != vec.end(); ++it) {
-    double this_p, this_v;
-    if (it->getVec2(this_p, this_v)) {
-      if (this_p <= p && (this_p > low_p || low_p > p)) {
-        low_p = this_p;
-        low_v = this_v;
-      }
-      if (this_p >= p && (this_p < high_p || high_p < p)) {
-        high_p = this_p;
-        high_v = this_v;
+  // Tables which are queried repeatedly (interpolation tables, cam profiles etc.) get a sorted
+  // index attached to the vector, so lookups become a binary search.
+  if (const auto *table = vec.index_cache().lookupTable(vec)) {
+    table->find(p, low_p, low_v, high_p, high_v);
+  } else {
+    for (++it; it != vec.end(); ++it) {
+      double this_p, this_v;
+      if (it->getVec2(this_p, this_v)) {
+        if (this_p <= p && (this_p > low_p || low_p > p)) {
+          low_p = this_p;
+          low_v = this_v;
+        }
+        if (this_p >= p && (this_p < high_p || high_p < p)) {
+          high_p = this_p;
+          high_v = this_v;
+        }
       }
     }
   }
@@ -731,10 +745,42 @@ static VectorType search(const str_utf8_wrapper& find, const VectorType& table,
   // Unicode glyph count for the length
   unsigned int findThisSize = find.get_utf8_strlen();
   unsigned int searchTableSize = table.size();
+  const SearchColumnIndex *index =
+    findThisSize > 0 ? table.index_cache().searchIndex(table, index_col_num) : nullptr;
   for (size_t i = 0; i < findThisSize; ++i) {
     unsigned int matchCount = 0;
     VectorType resultvec(session);
     const auto ft = find[i];
+    if (index) {
+      // Same result as the scan below: take matches up to the first short row, and warn if
+      // the scan would have reached that row before collecting enough matches.
+      static const SearchColumnIndex::RowList none;
+      const auto& rows = ft.empty() ? none : index->findChar(ft.get_utf8_char());
+      for (uint32_t j : rows) {
+        if (j >= index->firstShortRow()) break;
+        matchCount++;
+        if (num_returns_per_match == 1) {
+          returnvec.emplace_back(double(j));
+          break;
+        } else {
+          resultvec.emplace_back(double(j));
+        }
+        if (num_returns_per_match > 1 && matchCount >= num_returns_per_match) break;
+      }
+      const bool done = num_returns_per_match != 0 && matchCount >= num_returns_per_match;
+      if (!done && index->firstShortRow() < searchTableSize) {
+        const size_t j = index->firstShortRow();
+        LOG(message_group::Warning, loc, session->documentRoot(),
+            "Invalid entry in search vector at index %1$d, required number of values in the entry: "
+            "%2$d. Invalid entry: %3$s",
+            j, (index_col_num + 1), table[j].toEchoStringNoThrow());
+        return {session};
+      }
+      if (num_returns_per_match == 0 || num_returns_per_match > 1) {
+        returnvec.emplace_back(std::move(resultvec));
+      }
+      continue;
+    }
     for (size_t j = 0; j < searchTableSize; ++j) {
       const auto& entryVec = table[j].toVector();
       if (entryVec.size() <= index_col_num) {
@@ -780,10 +826,19 @@ Value builtin_search(Arguments arguments, const Location& loc)
 
   VectorType returnvec(arguments.session());
 
+  const auto& tableVec = searchTable.toVector();
   if (findThis.type() == Value::Type::NUMBER) {
+    if (const auto *index = tableVec.index_cache().searchIndex(tableVec, index_col_num)) {
+      const auto& rows = *index->find(findThis);
+      const size_t count = num_returns_per_match == 0
+                             ? rows.size()
+                             : std::min(rows.size(), size_t(num_returns_per_match));
+      for (size_t k = 0; k < count; ++k) returnvec.emplace_back(double(rows[k]));
+      return std::move(returnvec);
+    }
     unsigned int matchCount = 0;
     size_t j = 0;
-    for (const auto& search_element : searchTable.toVector()) {
+    for (const auto& search_element : tableVec) {
       if ((index_col_num == 0 && (findThis == search_element).toBool()) ||
           (index_col_num < search_element.toVector().size() &&
            (findThis == search_element.toVector()[index_col_num]).toBool())) {
@@ -798,17 +853,33 @@ Value builtin_search(Arguments arguments, const Location& loc)
       returnvec = search(findThis.toStrUtf8Wrapper(), searchTable.toStrUtf8Wrapper(),
                          num_returns_per_match, arguments.session());
     } else {
-      returnvec = search(findThis.toStrUtf8Wrapper(), searchTable.toVector(), num_returns_per_match,
+      returnvec = search(findThis.toStrUtf8Wrapper(), tableVec, num_returns_per_match,
                          index_col_num, loc, arguments.session());
     }
   } else if (findThis.type() == Value::Type::VECTOR) {
     const auto& findVec = findThis.toVector();
+    const SearchColumnIndex *index =
+      findVec.empty() ? nullptr : tableVec.index_cache().searchIndex(tableVec, index_col_num);
     for (const auto& find_value : findVec) {
       unsigned int matchCount = 0;
       VectorType resultvec(arguments.session());
 
+      if (const auto *rows = index ? index->find(find_value) : nullptr) {
+        if (num_returns_per_match == 1) {
+          if (rows->empty()) returnvec.emplace_back(std::move(resultvec));
+          else returnvec.emplace_back(double(rows->front()));
+        } else {
+          const size_t count = num_returns_per_match == 0
+                                 ? rows->size()
+                                 : std::min(rows->size(), size_t(num_returns_per_match));
+          for (size_t k = 0; k < count; ++k) resultvec.emplace_back(double((*rows)[k]));
+          returnvec.emplace_back(std::move(resultvec));
+        }
+        continue;
+      }
+
       size_t j = 0;
-      for (const auto& search_element : searchTable.toVector()) {
+      for (const auto& search_element : tableVec) {
         if ((index_col_num == 0 && (find_value == search_element).toBool()) ||
             (index_col_num < search_element.toVector().size() &&
              (find_value == search_element.toVector()[index_col_num]).toBool())) {
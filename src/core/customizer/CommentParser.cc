@@ -6,6 +6,7 @@
 #include "core/Expression.h"
 #include "core/customizer/Annotation.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <boost/range/adaptor/reversed.hpp>
 // gcc 4.8 and earlier have issues with std::regex see
@@ -21,6 +22,33 @@ struct GroupInfo {
 
 using GroupList = std::vector<GroupInfo>;
 
+/*
+   Offsets of the first character of each line, so lines can be located without scanning the text
+   from its beginning for every parameter.
+ */
+class LineIndex
+{
+public:
+  LineIndex(const std::string& fulltext) : length(fulltext.length())
+  {
+    starts.push_back(0);
+    for (std::size_t i = 0; i < fulltext.length(); ++i) {
+      if (fulltext[i] == '\n') starts.push_back(i + 1);
+    }
+  }
+
+  // Offset of the given 1-based line, or the length of the text if there are fewer lines.
+  std::size_t start(int line) const
+  {
+    if (line < 1) return 0;
+    return static_cast<std::size_t>(line) <= starts.size() ? starts[line - 1] : length;
+  }
+
+private:
+  std::vector<std::size_t> starts;
+  std::size_t length;
+};
+
 /*
    Finds line to break stop parsing parsing parameters
 
@@ -84,16 +112,12 @@ static int getLineToStop(const std::string& fulltext)
    Finds the given line in the given source code text, and
    extracts the comment (excluding the "//" prefix)
  */
-static std::string getComment(const std::string& fulltext, int line)
+static std::string getComment(const std::string& fulltext, const LineIndex& lines, int line)
 {
   if (line < 1) return "";
 
   // Locate line
-  std::size_t start = 0;
-  for (; start < fulltext.length(); ++start) {
-    if (line <= 1) break;
-    if (fulltext[start] == '\n') line--;
-  }
+  std::size_t start = lines.start(line);
 
   std::size_t end = start + 1;
   while (end < fulltext.size() && fulltext[end] != '\n') end++;
@@ -127,15 +151,11 @@ static std::string getComment(const std::string& fulltext, int line)
    Extracts a parameter description from comment on the given line.
    Returns description, without any "//"
  */
-static std::string getDescription(const std::string& fulltext, int line)
+static std::string getDescription(const std::string& fulltext, const LineIndex& lines, int line)
 {
   if (line < 1) return "";
 
-  unsigned int start = 0;
-  for (; start < fulltext.length(); ++start) {
-    if (line <= 1) break;
-    if (fulltext[start] == '\n') line--;
-  }
+  std::size_t start = lines.start(line);
 
   // not a valid description
   if (fulltext.compare(start, 2, "//") != 0) return "";
@@ -148,7 +168,7 @@ static std::string getDescription(const std::string& fulltext, int line)
   std::string retString = "";
 
   // go till the end of the line
-  while (fulltext[start] != '\n') {
+  while (start < fulltext.length() && fulltext[start] != '\n') {
     // replace // with space
     if (fulltext.compare(start, 2, "//") == 0) {
       retString += " ";
@@ -161,6 +181,20 @@ static std::string getDescription(const std::string& fulltext, int line)
   return retString;
 }
 
+/*
+   Parses a parameter annotation. Annotations of unchanged lines are parsed once, as the customizer
+   collects parameters again each time the file is parsed.
+ */
+static std::shared_ptr<Expression> parseAnnotation(const std::string& comment)
+{
+  static std::unordered_map<std::string, std::shared_ptr<Expression>> parsed;
+  auto it = parsed.find(comment);
+  if (it != parsed.end()) return it->second;
+  // Drop annotations of lines since edited, instead of growing while editing.
+  if (parsed.size() >= 4096) parsed.clear();
+  return parsed[comment] = CommentParser::parser(comment.c_str());
+}
+
 /*
    Create groups by parsing the multi line comment provided
  */
@@ -264,6 +298,7 @@ void CommentParser::collectParameters(const std::string& fulltext, SourceFile *r
   // Get all groups of parameters
   GroupList groupList = collectGroups(fulltext);
   int parseTill = getLineToStop(fulltext);
+  const LineIndex lines(fulltext);
   // Extract parameters for all literal assignments
   for (auto& assignment : root_file->scope->assignments) {
     if (!assignment->getExpr()->isLiteral()) continue;  // Only consider literals
@@ -284,11 +319,11 @@ void CommentParser::collectParameters(const std::string& fulltext, SourceFile *r
 
     // Extracting the parameter comment
     std::shared_ptr<Expression> params;
-    std::string comment = getComment(fulltext, firstLine);
+    std::string comment = getComment(fulltext, lines, firstLine);
     if (comment.length() >
         0) {  // don't parse what doesn't exist, so we don't get bogus errors from the parser
       // getting the node for parameter annotation
-      params = CommentParser::parser(comment.c_str());
+      params = parseAnnotation(comment);
     }
     if (!params) params = EmptyStringLiteral;
 
@@ -296,7 +331,7 @@ void CommentParser::collectParameters(const std::string& fulltext, SourceFile *r
     annotationList->push_back(Annotation("Parameter", params));
 
     // extracting the description
-    std::string descr = getDescription(fulltext, firstLine - 1);
+    std::string descr = getDescription(fulltext, lines, firstLine - 1);
     if (descr != "") {
       // creating node for description
       std::shared_ptr<Expression> expr(new Literal(descr));
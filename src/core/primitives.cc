@@ -45,20 +45,137 @@
 #include <cassert>
 #include <cstddef>
 #include <cmath>
-#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
 
 using namespace boost::assign;  // bring 'operator+=()' into scope
 
-template <class InsertIterator>
-static void generate_circle(InsertIterator iter, double r, double z, int fragments)
+namespace {
+
+/*
+   Tables shared by all primitives with the same number of fragments, so instances only scale them
+   instead of evaluating sin and cos for every vertex. Vertices are computed exactly as they were
+   without the tables, so results don't change.
+ */
+template <typename Key, typename Value>
+class PrimitiveTables
+{
+public:
+  template <typename Make>
+  std::shared_ptr<const Value> get(const Key& key, const Make& make)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = tables.find(key);
+    if (it != tables.end()) return it->second;
+    // Each $fn used creates a table, don't keep them without bound.
+    if (tables.size() >= MAX_TABLES) tables.clear();
+    return tables.emplace(key, std::make_shared<const Value>(make())).first->second;
+  }
+
+private:
+  static constexpr size_t MAX_TABLES = 1024;
+  std::mutex mutex;
+  std::map<Key, std::shared_ptr<const Value>> tables;
+};
+
+// cos and sin of the fragment angles of a circle
+std::shared_ptr<const std::vector<Vector2d>> unit_circle(int fragments)
+{
+  static PrimitiveTables<int, std::vector<Vector2d>> tables;
+  return tables.get(fragments, [fragments]() {
+    std::vector<Vector2d> circle(fragments);
+    for (int i = 0; i < fragments; ++i) {
+      double phi = (360.0 * i) / fragments;
+      circle[i] = {cos_degrees(phi), sin_degrees(phi)};
+    }
+    return circle;
+  });
+}
+
+// sin and cos of the polar angles of the rings of a sphere
+std::shared_ptr<const std::vector<Vector2d>> sphere_rings(int num_rings)
+{
+  static PrimitiveTables<int, std::vector<Vector2d>> tables;
+  return tables.get(num_rings, [num_rings]() {
+    std::vector<Vector2d> rings(num_rings);
+    for (int i = 0; i < num_rings; ++i) {
+      const double phi = (180.0 * (i + 0.5)) / num_rings;
+      rings[i] = {sin_degrees(phi), cos_degrees(phi)};
+    }
+    return rings;
+  });
+}
+
+// Faces of a sphere, which only depend on the number of fragments.
+PolygonIndices sphere_faces(int num_fragments, int num_rings)
+{
+  PolygonIndices indices;
+  indices.reserve(num_fragments * (num_rings - 1) + 2);
+  indices.emplace_back();
+  for (int i = 0; i < num_fragments; ++i) {
+    indices.back().push_back(i);
+  }
+
+  for (auto i = 0; i < num_rings - 1; ++i) {
+    for (auto r = 0; r < num_fragments; ++r) {
+      indices.push_back({
+        i * num_fragments + (r + 1) % num_fragments,
+        i * num_fragments + r,
+        (i + 1) * num_fragments + r,
+        (i + 1) * num_fragments + (r + 1) % num_fragments,
+      });
+    }
+  }
+
+  indices.emplace_back();
+  for (int i = 0; i < num_fragments; ++i) {
+    indices.back().push_back(num_rings * num_fragments - i - 1);
+  }
+  return indices;
+}
+
+// Faces of a cylinder, which only depend on the number of fragments and on it being a cone.
+PolygonIndices cylinder_faces(int num_fragments, bool cone, bool inverted_cone)
 {
+  PolygonIndices indices;
+  indices.reserve(num_fragments + 2);
+  for (int i = 0; i < num_fragments; ++i) {
+    int j = (i + 1) % num_fragments;
+    if (cone) indices.push_back({i, j, num_fragments});
+    else if (inverted_cone) indices.push_back({0, j + 1, i + 1});
+    else indices.push_back({i, j, j + num_fragments, i + num_fragments});
+  }
+
+  if (!inverted_cone) {
+    indices.emplace_back();
+    for (int i = 0; i < num_fragments; ++i) {
+      indices.back().push_back(num_fragments - i - 1);
+    }
+  }
+  if (!cone) {
+    indices.emplace_back();
+    int offset = inverted_cone ? 1 : num_fragments;
+    for (int i = 0; i < num_fragments; ++i) {
+      indices.back().push_back(offset + i);
+    }
+  }
+  return indices;
+}
+
+}  // namespace
+
+static void generate_circle(std::vector<Vector3d>& vertices, double r, double z, int fragments)
+{
+  const auto circle = unit_circle(fragments);
+  const auto offset = vertices.size();
+  vertices.resize(offset + fragments);
+  // Independent iterations over contiguous arrays, which compilers vectorize.
   for (int i = 0; i < fragments; ++i) {
-    double phi = (360.0 * i) / fragments;
-    *(iter++) = {r * cos_degrees(phi), r * sin_degrees(phi), z};
+    vertices[offset + i] = {r * (*circle)[i][0], r * (*circle)[i][1], z};
   }
 }
 
@@ -189,33 +306,14 @@ std::unique_ptr<const Geometry> SphereNode::createGeometry() const
   polyset->vertices.reserve(num_rings * num_fragments);
 
   // double offset = 0.5 * ((fragments / 2) % 2);
-  for (auto i = 0; i < num_rings; ++i) {
-    //                double phi = (180.0 * (i + offset)) / (fragments/2);
-    const double phi = (180.0 * (i + 0.5)) / num_rings;
-    const double radius = r * sin_degrees(phi);
-    generate_circle(std::back_inserter(polyset->vertices), radius, r * cos_degrees(phi), num_fragments);
+  // The polar angle of ring i is (180.0 * (i + 0.5)) / num_rings, see sphere_rings().
+  const auto rings = sphere_rings(num_rings);
+  for (const auto& ring : *rings) {
+    const double radius = r * ring[0];
+    generate_circle(polyset->vertices, radius, r * ring[1], num_fragments);
   }
 
-  polyset->indices.push_back({});
-  for (int i = 0; i < num_fragments; ++i) {
-    polyset->indices.back().push_back(i);
-  }
-
-  for (auto i = 0; i < num_rings - 1; ++i) {
-    for (auto r = 0; r < num_fragments; ++r) {
-      polyset->indices.push_back({
-        i * num_fragments + (r + 1) % num_fragments,
-        i * num_fragments + r,
-        (i + 1) * num_fragments + r,
-        (i + 1) * num_fragments + (r + 1) % num_fragments,
-      });
-    }
-  }
-
-  polyset->indices.push_back({});
-  for (int i = 0; i < num_fragments; ++i) {
-    polyset->indices.back().push_back(num_rings * num_fragments - i - 1);
-  }
+  polyset->indices = sphere_faces(num_fragments, num_rings);
 
   return polyset;
 }
@@ -273,34 +371,15 @@ std::unique_ptr<const Geometry> CylinderNode::createGeometry() const
   if (inverted_cone) {
     polyset->vertices.emplace_back(0.0, 0.0, z1);
   } else {
-    generate_circle(std::back_inserter(polyset->vertices), r1, z1, num_fragments);
+    generate_circle(polyset->vertices, r1, z1, num_fragments);
   }
   if (cone) {
     polyset->vertices.emplace_back(0.0, 0.0, z2);
   } else {
-    generate_circle(std::back_inserter(polyset->vertices), r2, z2, num_fragments);
-  }
-
-  for (int i = 0; i < num_fragments; ++i) {
-    int j = (i + 1) % num_fragments;
-    if (cone) polyset->indices.push_back({i, j, num_fragments});
-    else if (inverted_cone) polyset->indices.push_back({0, j + 1, i + 1});
-    else polyset->indices.push_back({i, j, j + num_fragments, i + num_fragments});
+    generate_circle(polyset->vertices, r2, z2, num_fragments);
   }
 
-  if (!inverted_cone) {
-    polyset->indices.push_back({});
-    for (int i = 0; i < num_fragments; ++i) {
-      polyset->indices.back().push_back(num_fragments - i - 1);
-    }
-  }
-  if (!cone) {
-    polyset->indices.push_back({});
-    int offset = inverted_cone ? 1 : num_fragments;
-    for (int i = 0; i < num_fragments; ++i) {
-      polyset->indices.back().push_back(offset + i);
-    }
-  }
+  polyset->indices = cylinder_faces(num_fragments, cone, inverted_cone);
 
   return polyset;
 }
@@ -562,11 +641,11 @@ std::unique_ptr<const Geometry> CircleNode::createGeometry() const
   }
 
   int num_fragments = discretizer.getCircularSegmentCount(this->r).value_or(3);
+  const auto circle = unit_circle(num_fragments);
   Outline2d o;
   o.vertices.resize(num_fragments);
   for (int i = 0; i < num_fragments; ++i) {
-    double phi = (360.0 * i) / num_fragments;
-    o.vertices[i] = {this->r * cos_degrees(phi), this->r * sin_degrees(phi)};
+    o.vertices[i] = this->r * (*circle)[i];
   }
   return std::make_unique<Polygon2d>(o);
 }
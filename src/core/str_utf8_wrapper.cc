@@ -0,0 +1,97 @@
+#include "core/str_utf8_wrapper.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Ropes are shared between values which may be flattened concurrently.
+std::mutex flatten_mutex;
+
+}  // namespace
+
+str_utf8_wrapper::str_utf8_t::~str_utf8_t()
+{
+  // Ropes built by accumulation are as deep as the number of steps, so release them iteratively
+  // instead of recursing through the destructors.
+  auto pending = std::move(pieces);
+  while (!pending.empty()) {
+    auto piece = std::move(pending.back());
+    pending.pop_back();
+    if (piece.use_count() == 1) {
+      for (auto& child : piece->pieces) {
+        pending.push_back(std::move(child));
+      }
+      piece->pieces.clear();
+    }
+  }
+}
+
+void str_utf8_wrapper::str_utf8_t::flatten() const
+{
+  std::lock_guard<std::mutex> lock(flatten_mutex);
+  if (flat.load(std::memory_order_relaxed)) return;
+
+  std::string result;
+  result.reserve(bytes);
+  std::vector<const str_utf8_t *> stack;
+  stack.push_back(this);
+  while (!stack.empty()) {
+    const str_utf8_t *piece = stack.back();
+    stack.pop_back();
+    if (piece->flat.load(std::memory_order_relaxed)) {
+      result += piece->u8str;
+    } else {
+      for (auto it = piece->pieces.rbegin(); it != piece->pieces.rend(); ++it) {
+        stack.push_back(it->get());
+      }
+    }
+  }
+  u8str = std::move(result);
+  pieces.clear();
+  flat.store(true, std::memory_order_release);
+}
+
+str_utf8_wrapper str_utf8_wrapper::concat(std::vector<str_utf8_wrapper> pieces)
+{
+  if (pieces.size() == 1) return std::move(pieces.front());
+
+  size_t bytes = 0;
+  for (const auto& piece : pieces) {
+    bytes += piece.size();
+  }
+  if (bytes < MIN_ROPE_PIECE_SIZE) {
+    std::string result;
+    result.reserve(bytes);
+    for (const auto& piece : pieces) {
+      result += piece.toString();
+    }
+    return {result};
+  }
+
+  std::vector<std::shared_ptr<str_utf8_t>> parts;
+  std::string short_pieces;
+  size_t u8len = 0;
+  for (auto& piece : pieces) {
+    u8len += piece.get_utf8_strlen();
+    if (piece.size() < MIN_ROPE_PIECE_SIZE) {
+      short_pieces += piece.toString();
+    } else {
+      if (!short_pieces.empty()) {
+        parts.push_back(std::make_shared<str_utf8_t>(std::move(short_pieces)));
+        short_pieces.clear();
+      }
+      parts.push_back(std::move(piece.str_ptr));
+    }
+  }
+  if (!short_pieces.empty()) {
+    parts.push_back(std::make_shared<str_utf8_t>(std::move(short_pieces)));
+  }
+  if (parts.size() == 1) return str_utf8_wrapper(parts.front());
+  return str_utf8_wrapper(std::make_shared<str_utf8_t>(std::move(parts), bytes, u8len));
+}
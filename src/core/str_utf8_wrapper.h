@@ -1,11 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <iterator>
 #include <utility>
 #include <cstdint>
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <glib.h>
 
@@ -13,14 +15,35 @@ class str_utf8_wrapper
 {
 private:
   // store the cached length in glong, paired with its string
+  //
+  // The result of concatenating long strings (see concat()) is a rope referring to its pieces, so
+  // accumulating a string piece by piece takes linear time. It is flattened when its contents are
+  // needed, its size and length are known without flattening.
   struct str_utf8_t {
     static constexpr size_t LENGTH_UNKNOWN = -1;
-    str_utf8_t() : u8str(), u8len(0) {}
-    str_utf8_t(std::string s) : u8str(std::move(s)) {}
-    str_utf8_t(const char *cstr) : u8str(cstr) {}
-    str_utf8_t(const char *cstr, size_t size, size_t u8len) : u8str(cstr, size), u8len(u8len) {}
-    const std::string u8str;
-    size_t u8len = LENGTH_UNKNOWN;
+    str_utf8_t() : u8len(0) {}
+    str_utf8_t(std::string s) : u8str(std::move(s)), bytes(u8str.size()) {}
+    str_utf8_t(const char *cstr) : u8str(cstr), bytes(u8str.size()) {}
+    str_utf8_t(const char *cstr, size_t size, size_t u8len)
+      : u8str(cstr, size), bytes(size), u8len(u8len) {}
+    str_utf8_t(std::vector<std::shared_ptr<str_utf8_t>> pieces, size_t bytes, size_t u8len)
+      : pieces(std::move(pieces)), bytes(bytes), u8len(u8len), flat(false) {}
+    ~str_utf8_t();
+
+    const std::string& str() const
+    {
+      if (!flat.load(std::memory_order_acquire)) flatten();
+      return u8str;
+    }
+    void flatten() const;
+
+    mutable std::string u8str;
+    mutable std::vector<std::shared_ptr<str_utf8_t>> pieces;  // empty once flattened
+    const size_t bytes = 0;
+    // Computed on first use, possibly by several threads sharing a frozen value. They all store the
+    // same length, so relaxed accesses suffice.
+    mutable std::atomic<size_t> u8len{LENGTH_UNKNOWN};
+    mutable std::atomic<bool> flat{true};
   };
   // private constructor for copying members
   explicit str_utf8_wrapper(const std::shared_ptr<str_utf8_t>& str_in) : str_ptr(str_in) {}
@@ -86,35 +109,40 @@ public:
     return str_utf8_wrapper(this->str_ptr);
   }  // makes a copy of shared_ptr
 
+  // Concatenation of pieces, referring to long pieces instead of copying them.
+  static str_utf8_wrapper concat(std::vector<str_utf8_wrapper> pieces);
+  // Pieces shorter than this are copied into the result of concat().
+  static constexpr size_t MIN_ROPE_PIECE_SIZE = 256;
+
   bool operator==(const str_utf8_wrapper& rhs) const
   {
-    return this->str_ptr->u8str == rhs.str_ptr->u8str;
+    return this->str_ptr->str() == rhs.str_ptr->str();
   }
   bool operator!=(const str_utf8_wrapper& rhs) const
   {
-    return this->str_ptr->u8str != rhs.str_ptr->u8str;
+    return this->str_ptr->str() != rhs.str_ptr->str();
   }
-  bool operator<(const str_utf8_wrapper& rhs) const { return this->str_ptr->u8str < rhs.str_ptr->u8str; }
-  bool operator>(const str_utf8_wrapper& rhs) const { return this->str_ptr->u8str > rhs.str_ptr->u8str; }
+  bool operator<(const str_utf8_wrapper& rhs) const { return this->str_ptr->str() < rhs.str_ptr->str(); }
+  bool operator>(const str_utf8_wrapper& rhs) const { return this->str_ptr->str() > rhs.str_ptr->str(); }
   bool operator<=(const str_utf8_wrapper& rhs) const
   {
-    return this->str_ptr->u8str <= rhs.str_ptr->u8str;
+    return this->str_ptr->str() <= rhs.str_ptr->str();
   }
   bool operator>=(const str_utf8_wrapper& rhs) const
   {
-    return this->str_ptr->u8str >= rhs.str_ptr->u8str;
+    return this->str_ptr->str() >= rhs.str_ptr->str();
   }
-  [[nodiscard]] bool empty() const { return this->str_ptr->u8str.empty(); }
-  [[nodiscard]] const char *c_str() const { return this->str_ptr->u8str.c_str(); }
-  [[nodiscard]] const std::string& toString() const { return this->str_ptr->u8str; }
-  [[nodiscard]] size_t size() const { return this->str_ptr->u8str.size(); }
+  [[nodiscard]] bool empty() const { return this->str_ptr->bytes == 0; }
+  [[nodiscard]] const char *c_str() const { return this->str_ptr->str().c_str(); }
+  [[nodiscard]] const std::string& toString() const { return this->str_ptr->str(); }
+  [[nodiscard]] size_t size() const { return this->str_ptr->bytes; }
   str_utf8_wrapper operator[](const size_t idx) const
   {
     if (idx < this->size()) {
       // Ensure character (not byte) index is inside the character/glyph array
       if (idx < this->get_utf8_strlen()) {
         gchar utf8_of_cp[6] = "";  // A buffer for a single unicode character to be copied into
-        auto ptr = g_utf8_offset_to_pointer(str_ptr->u8str.c_str(), idx);
+        auto ptr = g_utf8_offset_to_pointer(this->c_str(), idx);
         if (ptr) {
           g_utf8_strncpy(utf8_of_cp, ptr, 1);
         }
@@ -126,17 +154,19 @@ public:
 
   [[nodiscard]] size_t get_utf8_strlen() const
   {
-    if (str_ptr->u8len == str_utf8_t::LENGTH_UNKNOWN) {
-      str_ptr->u8len = g_utf8_strlen(str_ptr->u8str.c_str(), static_cast<gssize>(str_ptr->u8str.size()));
+    size_t u8len = str_ptr->u8len.load(std::memory_order_relaxed);
+    if (u8len == str_utf8_t::LENGTH_UNKNOWN) {
+      u8len = g_utf8_strlen(this->c_str(), static_cast<gssize>(this->size()));
+      str_ptr->u8len.store(u8len, std::memory_order_relaxed);
     }
-    return str_ptr->u8len;
+    return u8len;
   }
 
-  [[nodiscard]] uint32_t get_utf8_char() const { return g_utf8_get_char(str_ptr->u8str.c_str()); }
+  [[nodiscard]] uint32_t get_utf8_char() const { return g_utf8_get_char(this->c_str()); }
 
   [[nodiscard]] bool utf8_validate() const
   {
-    return g_utf8_validate(str_ptr->u8str.c_str(), -1, nullptr);
+    return g_utf8_validate(this->c_str(), -1, nullptr);
   }
 
 private:
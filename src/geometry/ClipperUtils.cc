@@ -209,6 +209,37 @@ std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree,
   return result;
 }
 
+std::vector<Clipper2Lib::Paths64> components(const Clipper2Lib::PolyTree64& polytree)
+{
+  std::vector<Clipper2Lib::Paths64> result;
+  auto processOutline = [&result](auto&& processOutline, const Clipper2Lib::PolyPath64& node) -> void {
+    Clipper2Lib::Paths64 component{node.Polygon()};
+    for (const auto& hole : node) {
+      component.push_back(hole->Polygon());
+      // Outlines within holes are components of their own
+      for (const auto& child : *hole) processOutline(processOutline, *child);
+    }
+    result.push_back(std::move(component));
+  };
+  for (const auto& node : polytree) {
+    processOutline(processOutline, *node);
+  }
+  return result;
+}
+
+Clipper2Lib::Point64 moveToOrigin(Clipper2Lib::Paths64& paths)
+{
+  if (paths.empty() || paths.front().empty()) return {};
+  const auto origin = paths.front().front();
+  for (auto& path : paths) {
+    for (auto& p : path) {
+      p.x -= origin.x;
+      p.y -= origin.y;
+    }
+  }
+  return origin;
+}
+
 /*!
    Apply the clipper operator to the given paths.
 
@@ -19,6 +19,11 @@ std::unique_ptr<Polygon2d> sanitize(const Polygon2d& poly);
 
 Clipper2Lib::Paths64 fromPolygon2d(const Polygon2d& poly, int scale_bits);
 std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& poly, int scale_bits);
+// Splits a polytree into independent components, each an outline followed by its holes.
+std::vector<Clipper2Lib::Paths64> components(const Clipper2Lib::PolyTree64& polytree);
+// Moves paths so their first vertex is at the origin, and returns where it was. Copies of a shape at
+// different positions then have the same vertices.
+Clipper2Lib::Point64 moveToOrigin(Clipper2Lib::Paths64& paths);
 
 std::unique_ptr<Polygon2d> applyOffset(const Polygon2d& poly, double offset,
                                        Clipper2Lib::JoinType joinType, double miter_limit,
@@ -28,4 +33,6 @@ std::unique_ptr<Polygon2d> applyProjection(
   const std::vector<std::shared_ptr<const Polygon2d>>& polygons);
 std::unique_ptr<Polygon2d> apply(const std::vector<std::shared_ptr<const Polygon2d>>& polygons,
                                  Clipper2Lib::ClipType);
+std::unique_ptr<Polygon2d> apply(const std::vector<Clipper2Lib::Paths64>& pathsvector,
+                                 Clipper2Lib::ClipType clipType, int scale_bits);
 }  // namespace ClipperUtils
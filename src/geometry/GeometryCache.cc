@@ -47,6 +47,10 @@ void GeometryCache::print()
 {
   LOG("Geometries in cache: %1$d", this->cache.size());
   LOG("Geometry cache size in bytes: %1$d", this->cache.totalCost());
+  if (const size_t lookups = factored_hits + factored_misses; lookups > 0) {
+    LOG("Rigid transform factored lookups: %1$d hits, %2$d misses (%3$d%% hit rate)", factored_hits,
+        factored_misses, 100 * factored_hits / lookups);
+  }
 }
 
 GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom) : geom(geom)
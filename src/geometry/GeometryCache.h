@@ -21,12 +21,17 @@ public:
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const class Geometry> get(const std::string& id) const;
   bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom);
+  // Keeps a cached geometry from being evicted until unpinned, see Cache::pin().
+  bool pin(const std::string& id) { return this->cache.pin(id); }
+  void unpin(const std::string& id) { this->cache.unpin(id); }
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
   void setMaxSizeMB(size_t limit);
   void clear() { cache.clear(); }
   void print();
+  // Lookups of results cached without a rigid transform, see GeometryEvaluator::factorRigidTransform().
+  void countFactoredLookup(bool hit) { ++(hit ? factored_hits : factored_misses); }
 
 private:
   static GeometryCache *inst;
@@ -38,4 +43,6 @@ private:
   };
 
   Cache<std::string, cache_entry> cache;
+  size_t factored_hits = 0;
+  size_t factored_misses = 0;
 };
@@ -37,6 +37,7 @@
 #include "utils/degree_trig.h"
 #include "utils/printutils.h"
 
+#include <algorithm>
 #include <iterator>
 #include <cassert>
 #include <list>
@@ -74,14 +75,23 @@ std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const Abstra
 {
   auto result = smartCacheGet(node, allownef);
   if (!result) {
-    // If not found in any caches, we need to evaluate the geometry
-    // traverse() will set this->root to a geometry, which can be any geometry
-    // (including GeometryList if the lazyunions feature is enabled)
-    this->traverse(node);
-    result = this->root;
-
-    // Insert the raw result into the cache.
-    smartCacheInsert(node, result);
+    const bool plan = Feature::ExperimentalCacheAwareEvaluation.is_enabled() && this->shared.empty();
+    try {
+      if (plan) planSharedSubtrees(node);
+      // If not found in any caches, we need to evaluate the geometry
+      // traverse() will set this->root to a geometry, which can be any geometry
+      // (including GeometryList if the lazyunions feature is enabled)
+      this->traverse(node);
+      result = this->root;
+
+      // Insert the raw result into the cache.
+      smartCacheInsert(node, result);
+    } catch (...) {
+      // Don't leave geometries pinned when evaluation is cancelled or fails.
+      if (plan) releaseShared();
+      throw;
+    }
+    if (plan) releaseShared();
   }
 
   // Convert engine-specific 3D geometry to PolySet if needed
@@ -322,6 +332,99 @@ std::vector<std::shared_ptr<const Polygon2d>> GeometryEvaluator::collectChildren
   return children;
 }
 
+/*!
+   With the cache-aware-evaluation feature, subtrees referenced more than once (e.g. a module
+   instantiated in a loop) are found before evaluation, by counting how often each node id occurs.
+
+   Their geometries are pinned in the caches from the time they are evaluated until their last use, so
+   evaluating siblings in between can't evict them. Shared subtrees which are not leaves are evaluated
+   first, the largest ones first, so the subtrees they contain are evaluated as part of them.
+ */
+void GeometryEvaluator::planSharedSubtrees(const AbstractNode& node)
+{
+  std::unordered_map<std::string, SharedSubtree> subtrees;
+  countSubtreeUses(node, subtrees);
+  for (auto& [key, subtree] : subtrees) {
+    if (subtree.uses > 1 && subtree.node != &node) this->shared.emplace(key, subtree);
+  }
+
+  // Pin geometries already cached before evaluating others which could evict them.
+  std::vector<std::pair<std::string, SharedSubtree>> order;
+  for (const auto& [key, subtree] : this->shared) {
+    if (isSmartCached(key)) pinShared(key);
+    else if (subtree.cost > 1 && !dynamic_cast<const ListNode *>(subtree.node)) {
+      order.emplace_back(key, subtree);
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [](const auto& a, const auto& b) { return a.second.cost > b.second.cost; });
+
+  for (const auto& [key, subtree] : order) {
+    // Evaluated, and possibly already used up, as part of a larger shared subtree
+    auto it = this->shared.find(key);
+    if (it == this->shared.end() || isSmartCached(key)) continue;
+    // This evaluation is ahead of all uses, so it isn't one of them.
+    ++it->second.uses;
+    this->traverse(*subtree.node);
+    smartCacheInsert(key, this->root);
+  }
+  this->root.reset();
+}
+
+/*!
+   Counts the occurrences of each subtree, in the order traverse() visits them, and returns the
+   number of nodes in the given subtree. Children of repeated or cached subtrees are not visited
+   there, so they are not counted. Background (%) subtrees are not counted either, as their geometry
+   is left out of the result and not worth evaluating ahead or pinning.
+ */
+size_t GeometryEvaluator::countSubtreeUses(const AbstractNode& node,
+                                           std::unordered_map<std::string, SharedSubtree>& subtrees)
+{
+  if (node.modinst->isBackground()) return 0;
+  const std::string key = this->tree.getIdString(node);
+  SharedSubtree& subtree = subtrees[key];
+  if (subtree.uses++ > 0) return subtree.cost;
+  subtree.node = &node;
+  size_t cost = 1;
+  if (!isSmartCached(key)) {
+    for (const auto& child : node.getChildren()) cost += countSubtreeUses(*child, subtrees);
+  }
+  // Not using subtree, since inserting into subtrees above may have rehashed it
+  subtrees[key].cost = cost;
+  return cost;
+}
+
+void GeometryEvaluator::pinShared(const std::string& key)
+{
+  auto it = this->shared.find(key);
+  if (it == this->shared.end() || it->second.pinned) return;
+  const bool geom = GeometryCache::instance()->pin(key);
+  const bool cgal = CGALCache::instance()->pin(key);
+  it->second.pinned = geom || cgal;
+}
+
+// Counts a lookup of a shared subtree, unpinning its geometry after the last one.
+void GeometryEvaluator::useShared(const std::string& key)
+{
+  auto it = this->shared.find(key);
+  if (it == this->shared.end() || --it->second.uses > 0) return;
+  if (it->second.pinned) {
+    GeometryCache::instance()->unpin(key);
+    CGALCache::instance()->unpin(key);
+  }
+  this->shared.erase(it);
+}
+
+void GeometryEvaluator::releaseShared()
+{
+  for (const auto& [key, subtree] : this->shared) {
+    if (!subtree.pinned) continue;
+    GeometryCache::instance()->unpin(key);
+    CGALCache::instance()->unpin(key);
+  }
+  this->shared.clear();
+}
+
 /*!
    Since we can generate both Nef and non-Nef geometry, we need to insert it into
    the appropriate cache.
@@ -330,11 +433,16 @@ std::vector<std::shared_ptr<const Polygon2d>> GeometryEvaluator::collectChildren
 void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
                                          const std::shared_ptr<const Geometry>& geom)
 {
-  const std::string& key = this->tree.getIdString(node);
+  smartCacheInsert(this->tree.getIdString(node), geom);
+}
 
+void GeometryEvaluator::smartCacheInsert(const std::string& key,
+                                         const std::shared_ptr<const Geometry>& geom)
+{
+  bool inserted = false;
   if (CGALCache::acceptsGeometry(geom)) {
     if (!CGALCache::instance()->contains(key)) {
-      CGALCache::instance()->insert(key, geom);
+      inserted = CGALCache::instance()->insert(key, geom);
     }
   } else if (!GeometryCache::instance()->contains(key)) {
     // FIXME: Sanity-check Polygon2d as well?
@@ -343,27 +451,117 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
     // }
 
     // Perhaps add acceptsGeometry() to GeometryCache as well?
-    if (!GeometryCache::instance()->insert(key, geom)) {
+    inserted = GeometryCache::instance()->insert(key, geom);
+    if (!inserted) {
       LOG(message_group::Warning, "GeometryEvaluator: Node didn't fit into cache.");
     }
   }
+  // The evaluation of a shared subtree is its first use.
+  if (inserted && !this->shared.empty()) {
+    pinShared(key);
+    useShared(key);
+  }
 }
 
 bool GeometryEvaluator::isSmartCached(const AbstractNode& node)
 {
-  const std::string& key = this->tree.getIdString(node);
+  return isSmartCached(this->tree.getIdString(node));
+}
+
+bool GeometryEvaluator::isSmartCached(const std::string& key)
+{
   return GeometryCache::instance()->contains(key) || CGALCache::instance()->contains(key);
 }
 
 std::shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const AbstractNode& node,
                                                                  bool preferNef)
 {
-  const std::string& key = this->tree.getIdString(node);
+  return smartCacheGet(this->tree.getIdString(node), preferNef);
+}
+
+std::shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const std::string& key, bool preferNef)
+{
   const bool hasgeom = GeometryCache::instance()->contains(key);
   const bool hascgal = CGALCache::instance()->contains(key);
-  if (hascgal && (preferNef || !hasgeom)) return CGALCache::instance()->get(key);
-  if (hasgeom) return GeometryCache::instance()->get(key);
-  return {};
+  std::shared_ptr<const Geometry> geom;
+  if (hascgal && (preferNef || !hasgeom)) geom = CGALCache::instance()->get(key);
+  else if (hasgeom) geom = GeometryCache::instance()->get(key);
+  if ((hasgeom || hascgal) && !this->shared.empty()) useShared(key);
+  return geom;
+}
+
+/*!
+   With the transform-invariant-cache feature, a boolean whose children all apply the same rigid
+   transform to their content is also cached without that transform, under a key built from the
+   content alone. The same boolean under another rigid transform then reuses it, and only applies the
+   transform.
+
+   Only transforms directly below the boolean are factored out, and none of the nodes involved may
+   have the background modifier.
+ */
+std::optional<GeometryEvaluator::FactoredTransform> GeometryEvaluator::factorRigidTransform(
+  const CsgOpNode& node)
+{
+  if (!Feature::ExperimentalTransformInvariantCache.is_enabled() || node.children.size() < 2) {
+    return {};
+  }
+  const TransformNode *first = nullptr;
+  std::string key = "rigid-factored " + node.toString() + "{";
+  for (const auto& child : node.children) {
+    const auto *transform = dynamic_cast<const TransformNode *>(child.get());
+    if (!transform || transform->modinst->isBackground()) return {};
+    if (!first) {
+      const Eigen::Matrix3d linear = transform->matrix.linear();
+      if (transform->matrix.matrix().row(3) != Eigen::RowVector4d(0, 0, 0, 1) ||
+          !(linear.transpose() * linear).isIdentity(1e-12) || linear.determinant() <= 0) {
+        return {};
+      }
+      first = transform;
+    } else if (transform->matrix.matrix() != first->matrix.matrix()) {
+      return {};
+    }
+    key += "{";
+    for (const auto& grandchild : transform->children) {
+      if (grandchild->modinst->isBackground()) return {};
+      key += this->tree.getIdString(*grandchild);
+    }
+    key += "}";
+  }
+  key += "}";
+  return FactoredTransform{first->matrix, std::move(key)};
+}
+
+std::shared_ptr<const Geometry> GeometryEvaluator::factoredCacheGet(const FactoredTransform& factored,
+                                                                    bool preferNef)
+{
+  const auto geom = smartCacheGet(factored.key, preferNef);
+  GeometryCache::instance()->countFactoredLookup(geom != nullptr);
+  if (!geom) return nullptr;
+  std::shared_ptr<Geometry> transformed = geom->copy();
+  transformed->transform(factored.matrix);
+  return transformed;
+}
+
+// Whether the first child with geometry has the given dimension, which applyToChildren() then
+// evaluates the node in.
+bool GeometryEvaluator::hasChildrenOfDimension(const AbstractNode& node, unsigned int dim) const
+{
+  const auto it = this->visitedchildren.find(node.index());
+  if (it == this->visitedchildren.end()) return false;
+  for (const auto& [chnode, chgeom] : it->second) {
+    if (!chnode->modinst->isBackground() && chgeom) return chgeom->getDimension() == dim;
+  }
+  return false;
+}
+
+void GeometryEvaluator::factoredCacheInsert(const FactoredTransform& factored,
+                                            const std::shared_ptr<const Geometry>& geom)
+{
+  // 2D geometries are transformed differently, see visit(TransformNode), and lists not at all
+  if (!geom || geom->getDimension() != 3 || std::dynamic_pointer_cast<const GeometryList>(geom)) return;
+  std::shared_ptr<Geometry> untransformed = geom->copy();
+  untransformed->transform(factored.matrix.inverse(Eigen::Isometry));
+  smartCacheInsert(factored.key, untransformed);
 }
 
 /*!
@@ -600,7 +798,17 @@ Response GeometryEvaluator::visit(State& state, const OffsetNode& node)
   if (state.isPostfix()) {
     std::shared_ptr<const Geometry> geom;
     if (!isSmartCached(node)) {
-      if (const auto polygon = applyToChildren2D(node, OpenSCADOperator::UNION)) {
+      // With offset-3d, any 3D child makes this a 3D offset, whichever child comes first. Children of
+      // the other dimension are then ignored with a warning, see collectChildren2D/3D().
+      const auto& children = this->visitedchildren[node.index()];
+      const bool offset3d = Feature::ExperimentalOffset3D.is_enabled() &&
+                            std::any_of(children.begin(), children.end(), [](const auto& item) {
+                              return !item.first->modinst->isBackground() && item.second &&
+                                     !item.second->isEmpty() && item.second->getDimension() == 3;
+                            });
+      if (offset3d) {
+        geom = offset3D(node);
+      } else if (const auto polygon = applyToChildren2D(node, OpenSCADOperator::UNION)) {
         // ClipperLib documentation: The formula for the number of steps in a full
         // circular arc is ... Pi / acos(1 - arc_tolerance / abs(delta))
         double n = node.discretizer.getCircularSegmentCount(std::abs(node.delta)).value_or(3);
@@ -618,6 +826,37 @@ Response GeometryEvaluator::visit(State& state, const OffsetNode& node)
   return Response::ContinueTraversal;
 }
 
+/*!
+   Offsets the union of the 3D children by r or delta, always rounding edges and corners. The offset
+   is sampled every 2*PI*|r|/n, n being the number of fragments $fn, $fa and $fs give a circle of
+   radius |r|, but at least every |r|/2. With the default $fa and $fs, small radii get few fragments,
+   e.g. 5 for r=1, and coarser samples would miss the rounding altogether.
+ */
+std::shared_ptr<const Geometry> GeometryEvaluator::offset3D(const OffsetNode& node)
+{
+  std::shared_ptr<const Geometry> geom = applyToChildren3D(node, OpenSCADOperator::UNION).constptr();
+  if (!geom || node.delta == 0) return geom;
+  if (node.join_type != Clipper2Lib::JoinType::Round) {
+    LOG(message_group::Warning, node.modinst->location(), this->tree.getDocumentPath(),
+        "offset() of 3D objects rounds edges, delta is treated as r");
+  }
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
+    const auto manifold = ManifoldUtils::createManifoldFromGeometry(geom);
+    if (manifold) {
+      const double r = std::abs(node.delta);
+      const double n = node.discretizer.getCircularSegmentCount(r).value_or(3);
+      const double spacing = std::min(2 * M_PI * r / n, r / 2);
+      return ManifoldUtils::applyOffset3D(*manifold, node.delta, spacing);
+    }
+    return geom;
+  }
+#endif
+  LOG(message_group::Warning, node.modinst->location(), this->tree.getDocumentPath(),
+      "offset() of 3D objects requires the Manifold backend, ignoring offset");
+  return geom;
+}
+
 /*!
    RenderNodes just pass on convexity
  */
@@ -698,12 +937,22 @@ Response GeometryEvaluator::visit(State& state, const CsgOpNode& node)
 {
   if (state.isPrefix()) {
     if (isSmartCached(node)) return Response::PruneTraversal;
+    const auto factored = factorRigidTransform(node);
+    if (factored && isSmartCached(factored->key)) return Response::PruneTraversal;
     state.setPreferNef(true);  // Improve quality of CSG by avoiding conversion loss
   }
   if (state.isPostfix()) {
     std::shared_ptr<const Geometry> geom;
     if (!isSmartCached(node)) {
-      geom = applyToChildren(node, node.type).constptr();
+      auto factored = factorRigidTransform(node);
+      if (factored && !isSmartCached(factored->key) && !hasChildrenOfDimension(node, 3)) {
+        // Only 3D results are cached without their transform, see factoredCacheInsert().
+        factored.reset();
+      }
+      if (!factored || !(geom = factoredCacheGet(*factored, state.preferNef()))) {
+        geom = applyToChildren(node, node.type).constptr();
+        if (factored) factoredCacheInsert(*factored, geom);
+      }
     } else {
       geom = smartCacheGet(node, state.preferNef());
     }
@@ -7,6 +7,9 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <map>
@@ -102,10 +105,40 @@ private:
     std::shared_ptr<const Geometry> const_pointer;
   };
 
+  // A rigid transform shared by the children of a boolean, and the cache key of the boolean without it.
+  struct FactoredTransform {
+    Transform3d matrix;
+    std::string key;
+  };
+
+  // A subtree referenced more than once in the tree being evaluated, see planSharedSubtrees().
+  struct SharedSubtree {
+    const AbstractNode *node = nullptr;
+    // Lookups of its geometry still expected, counting the one evaluating it.
+    size_t uses = 0;
+    // Number of nodes in the subtree, as an estimate of how expensive it is to evaluate.
+    size_t cost = 0;
+    bool pinned = false;
+  };
+
+  void planSharedSubtrees(const AbstractNode& node);
+  size_t countSubtreeUses(const AbstractNode& node,
+                          std::unordered_map<std::string, SharedSubtree>& subtrees);
+  void pinShared(const std::string& key);
+  void useShared(const std::string& key);
+  void releaseShared();
+
   void smartCacheInsert(const AbstractNode& node, const std::shared_ptr<const Geometry>& geom);
+  void smartCacheInsert(const std::string& key, const std::shared_ptr<const Geometry>& geom);
   std::shared_ptr<const Geometry> smartCacheGet(const AbstractNode& node, bool preferNef);
+  std::shared_ptr<const Geometry> smartCacheGet(const std::string& key, bool preferNef);
   bool isSmartCached(const AbstractNode& node);
+  bool isSmartCached(const std::string& key);
+  std::optional<FactoredTransform> factorRigidTransform(const CsgOpNode& node);
+  std::shared_ptr<const Geometry> factoredCacheGet(const FactoredTransform& factored, bool preferNef);
+  void factoredCacheInsert(const FactoredTransform& factored, const std::shared_ptr<const Geometry>& geom);
   bool isValidDim(const Geometry::GeometryItem& item, unsigned int& dim) const;
+  bool hasChildrenOfDimension(const AbstractNode& node, unsigned int dim) const;
   std::vector<std::shared_ptr<const Polygon2d>> collectChildren2D(const AbstractNode& node);
   Geometry::Geometries collectChildren3D(const AbstractNode& node);
   std::unique_ptr<Polygon2d> applyMinkowski2D(const AbstractNode& node);
@@ -119,12 +152,14 @@ private:
   ResultObject applyToChildren(const AbstractNode& node, OpenSCADOperator op);
   std::shared_ptr<const Geometry> projectionCut(const ProjectionNode& node);
   std::shared_ptr<const Geometry> projectionNoCut(const ProjectionNode& node);
+  std::shared_ptr<const Geometry> offset3D(const OffsetNode& node);
 
   void addToParent(const State& state, const AbstractNode& node,
                    const std::shared_ptr<const Geometry>& geom);
   Response lazyEvaluateRootNode(State& state, const AbstractNode& node);
 
   std::map<int, Geometry::Geometries> visitedchildren;
+  std::unordered_map<std::string, SharedSubtree> shared;
   const Tree& tree;
   std::shared_ptr<const Geometry> root;
 
@@ -0,0 +1,129 @@
+#ifdef ENABLE_MANIFOLD
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "core/BuiltinContext.h"
+#include "core/Builtins.h"
+#include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/node.h"
+#include "core/progress.h"
+#include "core/SourceFile.h"
+#include "core/Tree.h"
+#include "Feature.h"
+#include "geometry/Geometry.h"
+#include "geometry/GeometryCache.h"
+#include "geometry/GeometryEvaluator.h"
+#include "glview/RenderSettings.h"
+#include "openscad.h"
+
+namespace {
+
+struct Evaluation {
+  std::shared_ptr<const Geometry> geometry;
+  // How often a cylinder was evaluated, i.e. not looked up in the cache with its parent
+  size_t cylinders = 0;
+};
+
+void count_cylinders(const std::shared_ptr<const AbstractNode>& node, void *userdata, int /*mark*/)
+{
+  if (node && node->name() == "cylinder") ++static_cast<Evaluation *>(userdata)->cylinders;
+}
+
+Evaluation evaluate(const std::string& scad)
+{
+  static const bool initialized = [] {
+    Builtins::instance()->initialize();
+    return true;
+  }();
+  (void)initialized;
+
+  SourceFile *file = nullptr;
+  REQUIRE(parse(file, scad, "test.scad", "test.scad", false));
+  const std::unique_ptr<SourceFile> source(file);
+  EvaluationSession session{"."};
+  ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
+  std::shared_ptr<const FileContext> file_context;
+  const std::shared_ptr<AbstractNode> root = source->instantiate(*builtin_context, &file_context);
+  REQUIRE(root);
+
+  Evaluation evaluation;
+  const Tree tree(root, ".");
+  GeometryEvaluator evaluator(tree);
+  progress_report_prep(root, count_cylinders, &evaluation);
+  evaluation.geometry = evaluator.evaluateGeometry(*root, true);
+  progress_report_fin();
+  return evaluation;
+}
+
+}  // namespace
+
+TEST_CASE("cache-aware-evaluation keeps shared subtrees in a cache smaller than their siblings",
+          "[GeometryEvaluator][Cache]")
+{
+  auto *cache = GeometryCache::instance();
+  const size_t max_size_mb = cache->maxSizeMB();
+  const auto backend = RenderSettings::inst()->backend3D;
+  RenderSettings::inst()->backend3D = RenderBackend3D::ManifoldBackend;
+
+  // Room for one sibling, but not for two of them
+  cache->clear();
+  const auto sibling = evaluate("sphere(25, $fn=400);").geometry;
+  REQUIRE(sibling);
+  const size_t mb = 1024ul * 1024ul;
+  REQUIRE(sibling->memsize() > mb);
+  cache->setMaxSizeMB(sibling->memsize() / mb + 1);
+
+  // The shared subtree is used before and after the siblings, which evict everything else. Child
+  // geometries are cached when their parent collects them, so the siblings' spheres must differ.
+  const std::string scad = R"(
+    module shared() union() { cylinder(h=1, r=2); cube(1); }
+    module sibling(x) translate([x, 0, 0]) sphere(x / 2, $fn=400);
+    shared();
+    sibling(50);
+    sibling(100);
+    translate([0, 10, 0]) shared();
+  )";
+
+  SECTION("without it, the shared subtree is evaluated again")
+  {
+    cache->clear();
+    CHECK(evaluate(scad).cylinders == 2);
+  }
+
+  SECTION("with it, the shared subtree is evaluated once")
+  {
+    Feature::enable_feature("cache-aware-evaluation");
+    cache->clear();
+    const auto evaluation = evaluate(scad);
+    Feature::enable_feature("cache-aware-evaluation", false);
+    CHECK(evaluation.cylinders == 1);
+    CHECK(evaluation.geometry);
+  }
+
+  SECTION("background subtrees are neither evaluated ahead nor pinned")
+  {
+    Feature::enable_feature("cache-aware-evaluation");
+    cache->clear();
+    const auto evaluation = evaluate(R"(
+      module shared() union() { cylinder(h=1, r=2); cube(1); }
+      module sibling(x) translate([x, 0, 0]) sphere(x / 2, $fn=400);
+      %shared();
+      sibling(50);
+      sibling(100);
+      %translate([0, 10, 0]) shared();
+    )");
+    Feature::enable_feature("cache-aware-evaluation", false);
+    CHECK(evaluation.cylinders == 2);
+  }
+
+  cache->clear();
+  cache->setMaxSizeMB(max_size_mb);
+  RenderSettings::inst()->backend3D = backend;
+}
+
+#endif  // ENABLE_MANIFOLD
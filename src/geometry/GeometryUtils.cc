@@ -8,6 +8,7 @@
 #include <boost/functional/hash.hpp>
 #include <cstddef>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -29,17 +30,63 @@
 #include "geometry/manifold/ManifoldGeometry.h"
 #endif
 
-static void *stdAlloc(void *userData, unsigned int size)
-{
-  TESS_NOTUSED(userData);
-  return malloc(size);
-}
+namespace {
+
+/*!
+   Bump allocator for libtess2, one per thread.
 
-static void stdFree(void *userData, void *ptr)
+   A tessellator frees everything it allocated when it is deleted, so freeing is a no-op and the
+   arena is rewound after each polygon. The blocks are kept for the next polygon, so tessellating
+   many faces doesn't go to malloc once the arena has grown to fit the largest of them.
+ */
+class TessArena
 {
-  TESS_NOTUSED(userData);
-  free(ptr);
-}
+public:
+  static void *alloc(void *userData, unsigned int size)
+  {
+    return static_cast<TessArena *>(userData)->allocate(size);
+  }
+  static void free(void * /*userData*/, void * /*ptr*/) {}
+
+  void *allocate(size_t size)
+  {
+    size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    while (current < blocks.size() && used + size > blocks[current].size) {
+      ++current;
+      used = 0;
+    }
+    if (current == blocks.size()) {
+      const auto block_size = std::max(size, BLOCK_SIZE);
+      blocks.push_back({std::make_unique<unsigned char[]>(block_size), block_size});
+    }
+    void *ptr = blocks[current].data.get() + used;
+    used += size;
+    return ptr;
+  }
+
+  void reset()
+  {
+    // Don't hold on to the memory of an exceptionally large polygon.
+    if (blocks.size() > MAX_BLOCKS) blocks.clear();
+    current = 0;
+    used = 0;
+  }
+
+private:
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+  static constexpr size_t BLOCK_SIZE = 256 * 1024;
+  static constexpr size_t MAX_BLOCKS = 64;
+
+  struct Block {
+    std::unique_ptr<unsigned char[]> data;
+    size_t size;
+  };
+  std::vector<Block> blocks;
+  size_t current = 0;
+  size_t used = 0;
+};
+
+}  // namespace
 
 using IndexedEdge = std::pair<int, int>;
 
@@ -290,12 +337,18 @@ bool GeometryUtils::tessellatePolygonWithHoles(const std::vector<Vector3f>& vert
     normalvec = passednormal;
   }
 
+  thread_local TessArena arena;
+  // Rewinds the arena however we leave, the tessellator doesn't outlive this function.
+  const std::unique_ptr<TessArena, void (*)(TessArena *)> arena_guard(
+    &arena, [](TessArena *arena) { arena->reset(); });
+
   TESSalloc ma;
   TESStesselator *tess = nullptr;
 
   memset(&ma, 0, sizeof(ma));
-  ma.memalloc = stdAlloc;
-  ma.memfree = stdFree;
+  ma.memalloc = TessArena::alloc;
+  ma.memfree = TessArena::free;
+  ma.userData = &arena;
   ma.extraVertices = 256;  // realloc not provided, allow 256 extra vertices.
 
   if (!(tess = tessNewTess(&ma))) return true;
@@ -317,8 +370,10 @@ bool GeometryUtils::tessellatePolygonWithHoles(const std::vector<Vector3f>& vert
     tessAddContour(tess, 3, &contour.front(), sizeof(TESSreal) * 3, face.size());
   }
 
-  if (!tessTesselate(tess, TESS_WINDING_ODD, TESS_CONSTRAINED_DELAUNAY_TRIANGLES, 3, 3, normalvec))
+  if (!tessTesselate(tess, TESS_WINDING_ODD, TESS_CONSTRAINED_DELAUNAY_TRIANGLES, 3, 3, normalvec)) {
+    tessDeleteTess(tess);
     return false;
+  }
 
   const auto vindices = tessGetVertexIndices(tess);
   const auto elements = tessGetElements(tess);
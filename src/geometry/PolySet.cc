@@ -30,9 +30,14 @@
 #include "geometry/linalg.h"
 #include "utils/printutils.h"
 #include "geometry/Grid.h"
+#ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/ManifoldGeometry.h"
+#endif
 #include <algorithm>
 #include <sstream>
 #include <memory>
+#include <string_view>
+#include <boost/functional/hash.hpp>
 #include <Eigen/LU>
 #include <cstddef>
 #include <string>
@@ -88,14 +93,60 @@ size_t PolySet::memsize() const
   for (const auto& p : this->indices) mem += p.size() * sizeof(int);
   for (const auto& p : this->vertices) mem += p.size() * sizeof(Vector3d);
   mem += sizeof(PolySet);
+#ifdef ENABLE_MANIFOLD
+  // The Manifold is kept alive by this PolySet. Estimate its vertex positions, half edges and face
+  // normals without asking it for its mesh.
+  if (manifold_source_) {
+    mem += manifold_source_->numVertices() * sizeof(Vector3d) +
+           manifold_source_->numFacets() * (3 * 4 * sizeof(int) + sizeof(Vector3d));
+  }
+#endif
   return mem;
 }
+
+namespace {
+
+template <typename Container>
+std::string_view as_bytes(const Container& elements)
+{
+  using T = typename Container::value_type;
+  return {reinterpret_cast<const char *>(elements.data()), elements.size() * sizeof(T)};
+}
+
+}  // namespace
+
+size_t PolySet::meshHash() const
+{
+  size_t seed = 0;
+  boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(vertices)));
+  for (const auto& polygon : indices) {
+    boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(polygon)));
+  }
+  boost::hash_combine(seed, indices.size());
+  boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(color_indices)));
+  boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(colors)));
+  return seed;
+}
+
+std::shared_ptr<const ManifoldGeometry> PolySet::manifoldSource() const
+{
+  // The members can be modified directly, so check the mesh is still the one converted
+  if (!manifold_source_ || meshHash() != manifold_source_hash_) return nullptr;
+  return manifold_source_;
+}
+
+void PolySet::setManifoldSource(std::shared_ptr<const ManifoldGeometry> source)
+{
+  manifold_source_ = std::move(source);
+  manifold_source_hash_ = manifold_source_ ? meshHash() : 0;
+}
 void PolySet::transform(const Transform3d& mat)
 {
   // If mirroring transform, flip faces to avoid the object to end up being inside-out
   bool mirrored = mat.matrix().determinant() < 0;
 
   for (auto& v : this->vertices) v = mat * v;
+  manifold_source_.reset();
 
   if (mirrored)
     for (auto& p : this->indices) {
@@ -108,6 +159,7 @@ void PolySet::setColor(const Color4f& c)
 {
   colors = {c};
   color_indices.assign(indices.size(), 0);
+  manifold_source_.reset();
 }
 
 bool PolySet::isConvex() const
@@ -132,6 +184,8 @@ void PolySet::resize(const Vector3d& newsize, const Eigen::Matrix<bool, 3, 1>& a
 void PolySet::quantizeVertices(std::vector<Vector3d> *pPointsOut)
 {
   const bool has_colors = !this->color_indices.empty();
+  is_welded_ = false;
+  manifold_source_.reset();
   Grid3d<unsigned int> grid(GRID_FINE);
   std::vector<unsigned int> polygon_indices;  // Vertex indices in one polygon
   for (size_t i = 0; i < this->indices.size();) {
@@ -10,8 +10,10 @@
 #include <memory>
 #include <cstddef>
 #include <string>
+#include <utility>
 #include <vector>
 
+class ManifoldGeometry;
 class PolySetBuilder;
 
 class PolySet : public Geometry
@@ -50,6 +52,16 @@ public:
   bool isTriangular() const { return is_triangular_; }
   void setTriangular(bool triangular) { is_triangular_ = triangular; }
 
+  // Whether vertices closer than the Manifold tolerance were already merged.
+  bool isWelded() const { return is_welded_; }
+  void setWelded(bool welded) { is_welded_ = welded; }
+
+  // The ManifoldGeometry this PolySet was converted from, or null if the vertices, polygons or colors
+  // changed since setManifoldSource(), which must be called once they are complete. Transforming,
+  // resizing, recoloring and quantizing clear it.
+  std::shared_ptr<const ManifoldGeometry> manifoldSource() const;
+  void setManifoldSource(std::shared_ptr<const ManifoldGeometry> source);
+
   static std::unique_ptr<PolySet> createEmpty() { return std::make_unique<PolySet>(3); }
 
 private:
@@ -63,4 +75,12 @@ private:
   // "Manifold" is defined as an ε-valid mesh, see
   // https://github.com/elalish/manifold/wiki/Manifold-Library#definition-of-%CE%B5-valid
   bool is_manifold_ = false;  // false means "unknown"
+  bool is_welded_ = false;    // false means "unknown"
+  // Lets ManifoldUtils::createManifoldFromPolySet() reuse the Manifold instead of rebuilding,
+  // merging and validating it from a copy of its own mesh.
+  std::shared_ptr<const ManifoldGeometry> manifold_source_;
+  // meshHash() when manifold_source_ was set
+  size_t manifold_source_hash_ = 0;
+
+  size_t meshHash() const;
 };
@@ -16,6 +16,7 @@
 #include "geometry/Polygon2d.h"
 #include "utils/printutils.h"
 #include "geometry/GeometryUtils.h"
+#include "utils/parallel.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
 #endif
@@ -70,12 +71,14 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
   result->setConvexity(polyset.getConvexity());
   result->setTriangular(true);
   result->setManifold(polyset.isManifold());
+  result->setWelded(polyset.isWelded());
   // ideally this should not require a copy...
   if (polyset.isTriangular()) {
     result->vertices = polyset.vertices;
     result->indices = polyset.indices;
     result->color_indices = polyset.color_indices;
     result->colors = polyset.colors;
+    result->setManifoldSource(polyset.manifoldSource());
     return result;
   }
   result->vertices.reserve(polyset.vertices.size());
@@ -134,27 +137,33 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
     }
   }
 
-  // we will reuse this memory instead of reallocating for each polygon
-  std::vector<IndexedTriangle> triangles;
-  std::vector<IndexedFace> facesBuffer(1);
+  // Quads seem trivial, but can be concave, and can have degenerate cases.
+  // So everything more complex than triangles goes into the general case, tessellated in parallel.
+  std::vector<size_t> complex_faces;
+  for (size_t i = 0, n = polygons.size(); i < n; i++) {
+    if (polygons[i].size() > 3) complex_faces.push_back(i);
+  }
+  const auto tessellate = [&](size_t i) {
+    std::vector<IndexedTriangle> triangles;
+    const std::vector<IndexedFace> faces{polygons[i]};
+    if (GeometryUtils::tessellatePolygonWithHoles(verts, faces, triangles)) triangles.clear();
+    return triangles;
+  };
+  std::vector<std::vector<IndexedTriangle>> tessellated(complex_faces.size());
+  parallelizable_transform(complex_faces.begin(), complex_faces.end(), tessellated.begin(), tessellate);
+
+  result->indices.reserve(polygons.size() + complex_faces.size());
+  auto next_complex = tessellated.begin();
   for (size_t i = 0, n = polygons.size(); i < n; i++) {
     const auto& face = polygons[i];
     if (face.size() == 3) {
       // trivial case - triangles cannot be concave or have holes
       result->indices.push_back({face[0], face[1], face[2]});
       if (has_colors) result->color_indices.push_back(polygon_color_indices[i]);
-    }
-    // Quads seem trivial, but can be concave, and can have degenerate cases.
-    // So everything more complex than triangles goes into the general case.
-    else {
-      triangles.clear();
-      facesBuffer[0] = face;
-      auto err = GeometryUtils::tessellatePolygonWithHoles(verts, facesBuffer, triangles, nullptr);
-      if (!err) {
-        for (const auto& t : triangles) {
-          result->indices.push_back({t[0], t[1], t[2]});
-          if (has_colors) result->color_indices.push_back(polygon_color_indices[i]);
-        }
+    } else {
+      for (const auto& t : *next_complex++) {
+        result->indices.push_back({t[0], t[1], t[2]});
+        if (has_colors) result->color_indices.push_back(polygon_color_indices[i]);
       }
     }
   }
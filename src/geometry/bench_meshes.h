@@ -0,0 +1,8 @@
+#pragma once
+
+#include <memory>
+
+class PolySet;
+
+// Closed, consistently oriented torus with segments x segments quads, for benchmarks.
+std::unique_ptr<PolySet> bench_torus(int segments, double offset = 0.0);
@@ -21,6 +21,8 @@ public:
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const Geometry> get(const std::string& id) const;
   bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N);
+  bool pin(const std::string& id) { return this->cache.pin(id); }
+  void unpin(const std::string& id) { this->cache.unpin(id); }
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "geometry/bench_meshes.h"
+#include "geometry/ClipperUtils.h"
+#include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetBuilder.h"
+#include "geometry/Reindexer.h"
+
+#ifdef ENABLE_MANIFOLD
+#include "core/enums.h"
+#include "geometry/manifold/manifoldutils.h"
+#endif
+
+std::unique_ptr<PolySet> bench_torus(int segments, double offset)
+{
+  constexpr double R = 10.0;
+  constexpr double r = 3.0;
+  PolySetBuilder builder(segments * segments, segments * segments);
+  std::vector<int> indices(segments * segments);
+  for (int i = 0; i < segments; ++i) {
+    const double u = 2 * M_PI * i / segments;
+    for (int j = 0; j < segments; ++j) {
+      const double v = 2 * M_PI * j / segments;
+      indices[i * segments + j] = builder.vertexIndex(Vector3d(
+        offset + (R + r * std::cos(v)) * std::cos(u), (R + r * std::cos(v)) * std::sin(u), r * std::sin(v)));
+    }
+  }
+  for (int i = 0; i < segments; ++i) {
+    const int i1 = (i + 1) % segments;
+    for (int j = 0; j < segments; ++j) {
+      const int j1 = (j + 1) % segments;
+      builder.appendPolygon({indices[i * segments + j], indices[i1 * segments + j],
+                             indices[i1 * segments + j1], indices[i * segments + j1]});
+    }
+  }
+  return builder.build();
+}
+
+static void BM_PolySetBuilder_Torus(benchmark::State& state)
+{
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bench_torus(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_PolySetBuilder_Torus)->Arg(64)->Arg(256);
+
+static void BM_Reindexer_Vertices(benchmark::State& state)
+{
+  const auto torus = bench_torus(state.range(0));
+  for (auto _ : state) {
+    Reindexer<Vector3d> reindexer;
+    for (const auto& polygon : torus->indices) {
+      for (const auto index : polygon) {
+        benchmark::DoNotOptimize(reindexer.lookup(torus->vertices[index]));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * torus->indices.size() * 4);
+}
+BENCHMARK(BM_Reindexer_Vertices)->Arg(64)->Arg(256);
+
+static std::vector<std::shared_ptr<const Polygon2d>> square_grid(int n)
+{
+  std::vector<std::shared_ptr<const Polygon2d>> squares;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      Outline2d outline;
+      outline.vertices = {{i, j}, {i + 1.5, j}, {i + 1.5, j + 1.5}, {i, j + 1.5}};
+      squares.push_back(std::make_shared<Polygon2d>(std::move(outline)));
+    }
+  }
+  return squares;
+}
+
+static void BM_Clipper_Union(benchmark::State& state)
+{
+  const auto squares = square_grid(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ClipperUtils::apply(squares, Clipper2Lib::ClipType::Union));
+  }
+  state.SetItemsProcessed(state.iterations() * squares.size());
+}
+BENCHMARK(BM_Clipper_Union)->Arg(16)->Arg(64);
+
+static void BM_Clipper_Offset(benchmark::State& state)
+{
+  const auto squares = square_grid(state.range(0));
+  const auto polygon = ClipperUtils::apply(squares, Clipper2Lib::ClipType::Union);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+      ClipperUtils::applyOffset(*polygon, 0.25, Clipper2Lib::JoinType::Round, 2.0, 0.01));
+  }
+}
+BENCHMARK(BM_Clipper_Offset)->Arg(16)->Arg(64);
+
+#ifdef ENABLE_MANIFOLD
+static void BM_Manifold_FromPolySet(benchmark::State& state)
+{
+  const auto torus = bench_torus(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ManifoldUtils::createManifoldFromPolySet(*torus));
+  }
+  state.SetItemsProcessed(state.iterations() * torus->indices.size());
+}
+BENCHMARK(BM_Manifold_FromPolySet)->Arg(64)->Arg(256);
+
+static void BM_Manifold_ToPolySet(benchmark::State& state)
+{
+  const auto manifold = ManifoldUtils::createManifoldFromPolySet(*bench_torus(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manifold->toPolySet());
+  }
+}
+BENCHMARK(BM_Manifold_ToPolySet)->Arg(64)->Arg(256);
+
+static void BM_Manifold_Union(benchmark::State& state)
+{
+  const Geometry::Geometries children = {
+    {nullptr, ManifoldUtils::createManifoldFromPolySet(*bench_torus(state.range(0)))},
+    {nullptr, ManifoldUtils::createManifoldFromPolySet(*bench_torus(state.range(0), 5.0))},
+  };
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::UNION));
+  }
+}
+BENCHMARK(BM_Manifold_Union)->Arg(64)->Arg(256);
+#endif  // ENABLE_MANIFOLD
@@ -107,6 +107,8 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const
   ps->indices.reserve(mesh.NumTri());
   ps->setConvexity(convexity);
   ps->setManifold(true);
+  // Vertices are shared between triangles, as Manifold merged them.
+  ps->setWelded(true);
 
   // first 3 channels are xyz coordinate
   for (size_t i = 0; i < mesh.vertProperties.size(); i += mesh.numProp)
@@ -178,6 +180,8 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const
     }
     start = end;
   }
+  // Copying shares the Manifold's mesh rather than copying it.
+  ps->setManifoldSource(std::make_shared<ManifoldGeometry>(*this));
   return ps;
 }
 
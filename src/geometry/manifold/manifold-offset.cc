@@ -0,0 +1,220 @@
+#ifdef ENABLE_MANIFOLD
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <manifold/manifold.h>
+
+#include "geometry/linalg.h"
+#include "geometry/manifold/manifoldutils.h"
+#include "geometry/manifold/ManifoldGeometry.h"
+#include "utils/printutils.h"
+
+namespace {
+
+struct Triangle {
+  Vector3d a, b, c;
+};
+
+// Squared distance from p to the closest point of the triangle, after Ericson, Real-Time Collision
+// Detection, 5.1.5.
+double sqr_distance(const Vector3d& p, const Triangle& t)
+{
+  const Vector3d ab = t.b - t.a, ac = t.c - t.a, ap = p - t.a;
+  const double d1 = ab.dot(ap), d2 = ac.dot(ap);
+  if (d1 <= 0 && d2 <= 0) return ap.squaredNorm();
+
+  const Vector3d bp = p - t.b;
+  const double d3 = ab.dot(bp), d4 = ac.dot(bp);
+  if (d3 >= 0 && d4 <= d3) return bp.squaredNorm();
+
+  const double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0 && d1 >= 0 && d3 <= 0) return (ap - ab * (d1 / (d1 - d3))).squaredNorm();
+
+  const Vector3d cp = p - t.c;
+  const double d5 = ab.dot(cp), d6 = ac.dot(cp);
+  if (d6 >= 0 && d5 <= d6) return cp.squaredNorm();
+
+  const double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0 && d2 >= 0 && d6 <= 0) return (ap - ac * (d2 / (d2 - d6))).squaredNorm();
+
+  const double va = d3 * d6 - d5 * d4;
+  if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+    return (bp - (t.c - t.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))).squaredNorm();
+  }
+
+  const double denom = 1 / (va + vb + vc);
+  return (ap - ab * (vb * denom) - ac * (vc * denom)).squaredNorm();
+}
+
+/*
+   Bounding volume hierarchy over the triangles of a mesh, answering distance queries limited to a
+   narrow band around the surface. Queries don't modify it, so it can be queried from several threads.
+ */
+class TriangleTree
+{
+public:
+  TriangleTree(std::vector<Triangle> triangles) : triangles(std::move(triangles))
+  {
+    std::vector<size_t> order(this->triangles.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (!order.empty()) {
+      nodes.resize(1);
+      build(order, 0, 0, order.size());
+    }
+    std::vector<Triangle> sorted;
+    sorted.reserve(order.size());
+    for (const auto i : order) sorted.push_back(this->triangles[i]);
+    this->triangles = std::move(sorted);
+  }
+
+  // Squared distance from p to the surface, or max_sqr if it is further away than that.
+  [[nodiscard]] double sqrDistance(const Vector3d& p, double max_sqr) const
+  {
+    double best = max_sqr;
+    if (nodes.empty()) return best;
+    std::array<uint32_t, 64> stack;
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node& node = nodes[stack[--top]];
+      if (node.box.squaredExteriorDistance(p) >= best) continue;
+      if (node.count > 0) {
+        for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+          best = std::min(best, sqr_distance(p, triangles[i]));
+        }
+      } else {
+        // Descend into the nearer child first, so the further one is more likely to be pruned.
+        const uint32_t left = node.first, right = node.first + 1;
+        const bool left_first =
+          nodes[left].box.squaredExteriorDistance(p) <= nodes[right].box.squaredExteriorDistance(p);
+        stack[top++] = left_first ? right : left;
+        stack[top++] = left_first ? left : right;
+      }
+    }
+    return best;
+  }
+
+private:
+  static constexpr size_t LEAF_SIZE = 8;
+
+  struct Node {
+    Eigen::AlignedBox3d box;
+    // For leaves the range of their triangles, otherwise the index of the first of two children.
+    uint32_t first = 0;
+    uint32_t count = 0;
+  };
+
+  // Builds nodes[index] for order[begin, end) and its descendants, sorting order so the triangles of
+  // each leaf are consecutive.
+  void build(std::vector<size_t>& order, size_t index, size_t begin, size_t end)
+  {
+    Eigen::AlignedBox3d box, centers;
+    for (size_t i = begin; i < end; ++i) {
+      const auto& t = triangles[order[i]];
+      box.extend(t.a).extend(t.b).extend(t.c);
+      centers.extend((t.a + t.b + t.c) / 3);
+    }
+    nodes[index].box = box;
+    if (end - begin <= LEAF_SIZE) {
+      nodes[index].first = begin;
+      nodes[index].count = end - begin;
+      return;
+    }
+
+    // Split at the median along the longest axis of the triangle centers
+    int axis;
+    centers.sizes().maxCoeff(&axis);
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                     [this, axis](size_t i, size_t j) {
+                       const auto& a = triangles[i];
+                       const auto& b = triangles[j];
+                       return a.a[axis] + a.b[axis] + a.c[axis] < b.a[axis] + b.b[axis] + b.c[axis];
+                     });
+    const size_t children = nodes.size();
+    nodes.resize(children + 2);
+    nodes[index].first = children;
+    build(order, children, begin, middle);
+    build(order, children + 1, middle, end);
+  }
+
+  std::vector<Triangle> triangles;
+  std::vector<Node> nodes;
+};
+
+}  // namespace
+
+namespace ManifoldUtils {
+
+/*!
+   Offsets a solid by r, outwards for positive r and inwards for negative r, rounding its edges and
+   corners.
+
+   The points within |r| of the surface form a shell, which is sampled on a grid of the given spacing
+   by manifold::Manifold::LevelSet(). Only distances in a narrow band around the shell's surface are
+   computed exactly. The solid is then united with the shell, or the shell is subtracted from it.
+   Unlike minkowski() with a sphere, this doesn't need a convex decomposition, and the samples are
+   computed in parallel.
+
+   tolerance is passed on to LevelSet(): if positive, vertices are moved to within it of the true
+   surface.
+ */
+std::shared_ptr<const ManifoldGeometry> applyOffset3D(const ManifoldGeometry& geom, double r,
+                                                      double spacing, double tolerance)
+{
+  if (r == 0 || geom.isEmpty()) return std::make_shared<ManifoldGeometry>(geom);
+
+  const manifold::MeshGL64 mesh = geom.getManifold().GetMeshGL64();
+  std::vector<Triangle> triangles;
+  triangles.reserve(mesh.NumTri());
+  auto vertex = [&mesh](uint64_t v) {
+    const auto *p = &mesh.vertProperties[v * mesh.numProp];
+    return Vector3d(p[0], p[1], p[2]);
+  };
+  for (size_t i = 0; i < mesh.triVerts.size(); i += 3) {
+    triangles.push_back(
+      {vertex(mesh.triVerts[i]), vertex(mesh.triVerts[i + 1]), vertex(mesh.triVerts[i + 2])});
+  }
+  const TriangleTree tree(std::move(triangles));
+
+  const double radius = std::abs(r);
+  const BoundingBox bounds = geom.getBoundingBox();
+  const Vector3d margin = Vector3d::Constant(radius + spacing);
+  const Vector3d min = bounds.min() - margin, max = bounds.max() + margin;
+
+  // Keep the grid to a size that can be sampled in reasonable time and memory.
+  constexpr double max_samples = 1 << 26;
+  const Vector3d size = max - min;
+  const double samples = (size / spacing).array().ceil().prod();
+  if (samples > max_samples) {
+    spacing *= std::cbrt(samples / max_samples);
+    LOG(message_group::Warning,
+        "offset() of a large 3D object: sampling every %1$g instead, increase $fs or decrease $fn to "
+        "avoid this",
+        spacing);
+  }
+
+  // Beyond the band, the distance is only needed to tell that a point is outside the shell.
+  const double band = radius + 2 * spacing;
+  const double band_sqr = band * band;
+  const manifold::Manifold shell = manifold::Manifold::LevelSet(
+    [&tree, radius, band, band_sqr](manifold::vec3 p) {
+      const double sqr = tree.sqrDistance(Vector3d(p.x, p.y, p.z), band_sqr);
+      return sqr >= band_sqr ? radius - band : radius - std::sqrt(sqr);
+    },
+    manifold::Box({min[0], min[1], min[2]}, {max[0], max[1], max[2]}), spacing, 0, tolerance);
+
+  const ManifoldGeometry shell_geom(shell);
+  return std::make_shared<ManifoldGeometry>(r > 0 ? geom + shell_geom : geom - shell_geom);
+}
+
+}  // namespace ManifoldUtils
+
+#endif  // ENABLE_MANIFOLD
@@ -84,7 +84,8 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const Poly
 
   auto mani = manifold::Manifold(mesh);
 
-  if (mani.Status() != Error::NoError) {
+  // Merging can't help if the vertices were already merged by Manifold.
+  if (mani.Status() != Error::NoError && !ps.isWelded()) {
     PRINTD("Manifold creation initially failed");
     bool merged = mesh.Merge();
     mani = manifold::Manifold(mesh);
@@ -126,6 +127,13 @@ const char *statusToString(Error status)
 
 std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps)
 {
+  // 0. A PolySet converted from a Manifold, and not modified since, converts back to that Manifold.
+  if (const auto source = ps.manifoldSource(); source && source->isValid()) {
+    auto mani = std::make_shared<ManifoldGeometry>(*source);
+    mani->setConvexity(ps.getConvexity());
+    return mani;
+  }
+
   // 1. If the PolySet is already manifold, we should be able to build a Manifold object directly
   // (through using manifold::Mesh).
   // We need to make sure our PolySet is triangulated before doing that.
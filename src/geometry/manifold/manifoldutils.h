@@ -32,5 +32,8 @@ Polygon2d polygonsToPolygon2d(const manifold::Polygons& polygons);
 std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children);
 #endif
 
+std::shared_ptr<const ManifoldGeometry> applyOffset3D(const ManifoldGeometry& geom, double r,
+                                                      double spacing, double tolerance = -1);
+
 std::unique_ptr<PolySet> createTriangulatedPolySetFromPolygon2d(const Polygon2d& polygon2d);
 };  // namespace ManifoldUtils
@@ -0,0 +1,52 @@
+#ifdef ENABLE_MANIFOLD
+
+#include <catch2/catch_all.hpp>
+
+#include <utility>
+
+#include <manifold/manifold.h>
+
+#include "geometry/linalg.h"
+#include "geometry/manifold/manifoldutils.h"
+#include "geometry/manifold/ManifoldGeometry.h"
+#include "geometry/PolySet.h"
+
+TEST_CASE("createManifoldFromPolySet reuses the Manifold of an unchanged PolySet",
+          "[Geometry][Manifold]")
+{
+  const ManifoldGeometry cube(manifold::Manifold::Cube({1, 1, 1}));
+  const auto ps = cube.toPolySet();
+  REQUIRE(ps->manifoldSource());
+
+  SECTION("unchanged")
+  {
+    const auto mani = ManifoldUtils::createManifoldFromPolySet(*ps);
+    CHECK(mani->getBoundingBox().max().x() == Catch::Approx(1));
+  }
+
+  SECTION("vertices moved through the public members")
+  {
+    for (auto& v : ps->vertices) {
+      if (v.x() > 0.5) v.x() = 2;
+    }
+    CHECK_FALSE(ps->manifoldSource());
+    const auto mani = ManifoldUtils::createManifoldFromPolySet(*ps);
+    CHECK(mani->getBoundingBox().max().x() == Catch::Approx(2));
+  }
+
+  SECTION("polygons reordered through the public members")
+  {
+    std::swap(ps->indices.front(), ps->indices.back());
+    CHECK_FALSE(ps->manifoldSource());
+  }
+
+  SECTION("the Manifold is counted until it is released")
+  {
+    const size_t with_source = ps->memsize();
+    ps->transform(Transform3d::Identity());
+    CHECK_FALSE(ps->manifoldSource());
+    CHECK(ps->memsize() < with_source);
+  }
+}
+
+#endif  // ENABLE_MANIFOLD
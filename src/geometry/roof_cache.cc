@@ -0,0 +1,102 @@
+#include "geometry/roof_cache.h"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "clipper2/clipper.h"
+
+namespace roof_cache {
+
+namespace {
+
+// The roofs least recently used are dropped once the cache holds more than MAX_BYTES.
+constexpr size_t MAX_BYTES = 32 * 1024 * 1024;
+
+struct Entry {
+  std::string key;
+  std::shared_ptr<const RoofFaces> roof;
+  size_t bytes;
+};
+
+std::mutex mutex;
+// Most recently used first
+std::list<Entry> entries;
+std::unordered_map<std::string, std::list<Entry>::iterator> index;
+size_t total_bytes = 0;
+
+std::string component_key(const Clipper2Lib::Paths64& component, const std::string& parameters)
+{
+  std::string key = parameters;
+  key.push_back('\0');
+  for (const auto& path : component) {
+    const size_t size = path.size();
+    key.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    for (const auto& p : path) {
+      key.append(reinterpret_cast<const char *>(&p.x), sizeof(p.x));
+      key.append(reinterpret_cast<const char *>(&p.y), sizeof(p.y));
+    }
+  }
+  return key;
+}
+
+size_t entry_bytes(const std::string& key, const RoofFaces& roof)
+{
+  // The key is held twice, by the entry and the index.
+  size_t bytes = sizeof(Entry) + 2 * key.size() + sizeof(RoofFaces);
+  for (const auto& face : roof) bytes += sizeof(face) + face.size() * sizeof(Vector3d);
+  return bytes;
+}
+
+// Must be called with mutex held.
+void insert(std::string key, std::shared_ptr<const RoofFaces> roof)
+{
+  const size_t bytes = entry_bytes(key, *roof);
+  if (bytes > MAX_BYTES || index.count(key)) return;
+
+  entries.push_front({key, std::move(roof), bytes});
+  index.emplace(std::move(key), entries.begin());
+  total_bytes += bytes;
+
+  while (total_bytes > MAX_BYTES) {
+    total_bytes -= entries.back().bytes;
+    index.erase(entries.back().key);
+    entries.pop_back();
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<const RoofFaces> get(const Clipper2Lib::Paths64& component,
+                                     const std::string& parameters,
+                                     const std::function<std::shared_ptr<const RoofFaces>()>& compute)
+{
+  std::string key = component_key(component, parameters);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = index.find(key);
+    if (it != index.end()) {
+      entries.splice(entries.begin(), entries, it->second);
+      return it->second->roof;
+    }
+  }
+  auto roof = compute();
+  std::lock_guard<std::mutex> lock(mutex);
+  insert(std::move(key), roof);
+  return roof;
+}
+
+void clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  index.clear();
+  entries.clear();
+  total_bytes = 0;
+}
+
+}  // namespace roof_cache
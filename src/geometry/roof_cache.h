@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "clipper2/clipper.h"
+#include "geometry/linalg.h"
+
+/*!
+   Roofs of single components, i.e. an outline with its holes, shared by both roof() methods.
+
+   Repeated shapes, e.g. the same letter in a text, are computed once. Components are moved to the
+   origin first (see ClipperUtils::moveToOrigin()), so copies at different positions share a roof.
+ */
+namespace roof_cache {
+
+// The faces of the roof over one component, each a convex polygon.
+using RoofFaces = std::vector<std::vector<Vector3d>>;
+
+// Returns the cached roof of component, or computes and caches it. parameters must identify the
+// method and everything else the roof depends on, e.g. the scale and the discretization.
+std::shared_ptr<const RoofFaces> get(const Clipper2Lib::Paths64& component,
+                                     const std::string& parameters,
+                                     const std::function<std::shared_ptr<const RoofFaces>()>& compute);
+void clear();
+
+}  // namespace roof_cache
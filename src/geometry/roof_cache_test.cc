@@ -0,0 +1,31 @@
+#include <catch2/catch_all.hpp>
+
+#include <memory>
+
+#include "clipper2/clipper.h"
+#include "geometry/roof_cache.h"
+
+TEST_CASE("roof_cache computes each component once until it is cleared", "[Geometry][roof]")
+{
+  const Clipper2Lib::Paths64 square{{{0, 0}, {10, 0}, {10, 10}, {0, 10}}};
+  int computed = 0;
+  const auto compute = [&computed] {
+    ++computed;
+    return std::make_shared<const roof_cache::RoofFaces>(
+      roof_cache::RoofFaces{{Vector3d(0, 0, 0), Vector3d(10, 0, 0), Vector3d(5, 5, 5)}});
+  };
+
+  roof_cache::clear();
+  const auto roof = roof_cache::get(square, "test", compute);
+  CHECK(roof_cache::get(square, "test", compute) == roof);
+  CHECK(computed == 1);
+
+  // Other parameters, e.g. another method, don't share the roof.
+  roof_cache::get(square, "other", compute);
+  CHECK(computed == 2);
+
+  roof_cache::clear();
+  roof_cache::get(square, "test", compute);
+  CHECK(computed == 3);
+  roof_cache::clear();
+}
@@ -6,7 +6,6 @@
 #include <vector>
 #include <clipper2/clipper.engine.h>
 #include <iterator>
-#include <functional>
 #include <memory>
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
@@ -19,14 +18,18 @@
 #endif
 
 #include <algorithm>
+#include <cstddef>
 #include <map>
+#include <string>
 
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/GeometryUtils.h"
 #include "geometry/ClipperUtils.h"
+#include "geometry/roof_cache.h"
 #include "core/RoofNode.h"
 #include "geometry/PolySetBuilder.h"
+#include "utils/parallel.h"
 
 #define RAISE_ROOF_EXCEPTION(message) \
   throw RoofNode::roof_exception(     \
@@ -61,83 +64,116 @@ CGAL_Polygon_2 to_cgal_polygon_2(const Clipper2Lib::Path64& path, int scale_bits
   return poly;
 }
 
-// break a list of outlines into polygons with holes
-std::vector<CGAL_Polygon_with_holes_2> polygons_with_holes(const Clipper2Lib::PolyTree64& polytree,
-                                                           int scale_bits)
+namespace {
+
+using roof_cache::RoofFaces;
+
+struct Vector2dLess {
+  bool operator()(const Vector2d& a, const Vector2d& b) const
+  {
+    return (a[0] < b[0]) || (a[0] == b[0] && a[1] < b[1]);
+  }
+};
+
+using Heights = std::map<Vector2d, double, Vector2dLess>;
+
+RoofFaces roof_facets(const CGAL_Polygon_2& face, const Heights& heights)
 {
-  std::vector<CGAL_Polygon_with_holes_2> ret;
-
-  // lambda for recursive walk through polytree
-  std::function<void(const Clipper2Lib::PolyPath64&)> walk = [&](const Clipper2Lib::PolyPath64& c) {
-    // outer path
-    CGAL_Polygon_with_holes_2 c_poly(to_cgal_polygon_2(c.Polygon(), scale_bits));
-    // holes
-    for (const auto& cc : c) {
-      c_poly.add_hole(to_cgal_polygon_2(cc->Polygon(), scale_bits));
-      for (const auto& ccc : *cc) walk(*ccc);
+  if (!face.is_simple()) {
+    RAISE_ROOF_EXCEPTION("A non-simple face in straight skeleton, likely cause is cgal issue #5177");
+  }
+
+  // do convex partition if necessary
+  std::vector<CGAL_PT::Polygon_2> facets;
+  CGAL::approx_convex_partition_2(face.vertices_begin(), face.vertices_end(),
+                                  std::back_inserter(facets));
+
+  RoofFaces roof;
+  for (const auto& facet : facets) {
+    auto& polygon = roof.emplace_back();
+    for (auto v = facet.vertices_begin(); v != facet.vertices_end(); v++) {
+      const auto height = heights.find(Vector2d(v->x(), v->y()));
+      polygon.emplace_back(v->x(), v->y(), height == heights.end() ? 0.0 : height->second);
     }
-    ret.push_back(c_poly);
-    return;
-  };
+  }
+  return roof;
+}
 
-  for (const auto& root_node : polytree) walk(*root_node);
+// The roof over an outline and its holes
+std::shared_ptr<const RoofFaces> component_roof(const Clipper2Lib::Paths64& component, int scale_bits)
+{
+  CGAL_Polygon_with_holes_2 shape(to_cgal_polygon_2(component.front(), scale_bits));
+  for (size_t i = 1; i < component.size(); ++i) {
+    shape.add_hole(to_cgal_polygon_2(component[i], scale_bits));
+  }
 
-  return ret;
+  const CGAL_SsPtr ss = CGAL::create_interior_straight_skeleton_2(shape);
+  // store heights of vertices
+  Heights heights;
+  for (auto v = ss->vertices_begin(); v != ss->vertices_end(); v++) {
+    const Vector2d p(v->point().x(), v->point().y());
+    heights[p] = v->time();
+  }
+
+  // convert ss faces to cgal polygons
+  std::vector<CGAL_Polygon_2> faces;
+  for (auto ss_face = ss->faces_begin(); ss_face != ss->faces_end(); ss_face++) {
+    auto& face = faces.emplace_back();
+    for (auto h = ss_face->halfedge();;) {
+      face.push_back(h->vertex()->point());
+      h = h->next();
+      if (h == ss_face->halfedge()) {
+        break;
+      }
+    }
+  }
+
+  std::vector<RoofFaces> facets(faces.size());
+  parallelizable_transform(faces.begin(), faces.end(), facets.begin(), [&heights](const auto& face) {
+    return roof_facets(face, heights);
+  });
+
+  auto roof = std::make_shared<RoofFaces>();
+  for (auto& face_facets : facets) {
+    std::move(face_facets.begin(), face_facets.end(), std::back_inserter(*roof));
+  }
+  return roof;
 }
 
+}  // namespace
+
 std::unique_ptr<PolySet> straight_skeleton_roof(const Polygon2d& poly)
 {
   PolySetBuilder hatbuilder;
 
   const int scale_bits = ClipperUtils::scaleBitsFromPrecision();
+  const double scale = std::ldexp(1.0, -scale_bits);
   const Clipper2Lib::Paths64 paths = ClipperUtils::fromPolygon2d(poly, scale_bits);
   const std::unique_ptr<Clipper2Lib::PolyTree64> polytree = ClipperUtils::sanitize(paths);
   auto poly_sanitized = ClipperUtils::toPolygon2d(*polytree, scale_bits);
 
   try {
-    // roof
-    const std::vector<CGAL_Polygon_with_holes_2> shapes = polygons_with_holes(*polytree, scale_bits);
-    for (const CGAL_Polygon_with_holes_2& shape : shapes) {
-      const CGAL_SsPtr ss = CGAL::create_interior_straight_skeleton_2(shape);
-      // store heights of vertices
-      auto vector2d_comp = [](const Vector2d& a, const Vector2d& b) {
-        return (a[0] < b[0]) || (a[0] == b[0] && a[1] < b[1]);
-      };
-      std::map<Vector2d, double, decltype(vector2d_comp)> heights(vector2d_comp);
-      for (auto v = ss->vertices_begin(); v != ss->vertices_end(); v++) {
-        const Vector2d p(v->point().x(), v->point().y());
-        heights[p] = v->time();
-      }
-
-      for (auto ss_face = ss->faces_begin(); ss_face != ss->faces_end(); ss_face++) {
-        // convert ss_face to cgal polygon
-        CGAL_Polygon_2 face;
-        for (auto h = ss_face->halfedge();;) {
-          const CGAL_Point_2 pp = h->vertex()->point();
-          face.push_back(pp);
-          h = h->next();
-          if (h == ss_face->halfedge()) {
-            break;
-          }
-        }
-        if (!face.is_simple()) {
-          RAISE_ROOF_EXCEPTION(
-            "A non-simple face in straight skeleton, likely cause is cgal issue #5177");
-        }
-
-        // do convex partition if necessary
-        std::vector<CGAL_PT::Polygon_2> facets;
-        CGAL::approx_convex_partition_2(face.vertices_begin(), face.vertices_end(),
-                                        std::back_inserter(facets));
-
-        for (const auto& facet : facets) {
-          std::vector<int> roof;
-          for (auto v = facet.vertices_begin(); v != facet.vertices_end(); v++) {
-            const Vector2d vv(v->x(), v->y());
-            roof.push_back(hatbuilder.vertexIndex(Vector3d(v->x(), v->y(), heights[vv])));
-          }
-          hatbuilder.appendPolygon(roof);
-        }
+    // roof, computed for the outlines with their holes independently
+    std::vector<Clipper2Lib::Paths64> components = ClipperUtils::components(*polytree);
+    std::vector<Clipper2Lib::Point64> origins;
+    origins.reserve(components.size());
+    for (auto& component : components) origins.push_back(ClipperUtils::moveToOrigin(component));
+
+    const std::string parameters = "straight skeleton " + std::to_string(scale_bits);
+    std::vector<std::shared_ptr<const RoofFaces>> roofs(components.size());
+    parallelizable_transform(components.begin(), components.end(), roofs.begin(),
+                             [&](const Clipper2Lib::Paths64& component) {
+                               return roof_cache::get(component, parameters, [&] {
+                                 return component_roof(component, scale_bits);
+                               });
+                             });
+
+    for (size_t i = 0; i < roofs.size(); ++i) {
+      const Vector3d origin(origins[i].x * scale, origins[i].y * scale, 0.0);
+      for (const auto& face : *roofs[i]) {
+        std::vector<int> roof;
+        for (const auto& v : face) roof.push_back(hatbuilder.vertexIndex(v + origin));
+        hatbuilder.appendPolygon(roof);
       }
     }
 
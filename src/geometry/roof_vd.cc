@@ -9,7 +9,10 @@
 #include <cmath>
 #include <cstddef>
 #include <algorithm>
+#include <iterator>
 #include <map>
+#include <sstream>
+#include <string>
 #include <boost/polygon/voronoi.hpp>
 #include <vector>
 #include "geometry/linalg.h"
@@ -18,7 +21,9 @@
 
 #include "geometry/GeometryUtils.h"
 #include "geometry/ClipperUtils.h"
+#include "geometry/roof_cache.h"
 #include "core/RoofNode.h"
+#include "utils/parallel.h"
 
 #define RAISE_ROOF_EXCEPTION(message) \
   throw RoofNode::roof_exception(     \
@@ -340,6 +345,73 @@ Faces_2_plus_1 vd_inner_faces(const voronoi_diagram& vd, const std::vector<Segme
   return ret;
 }
 
+namespace {
+
+using roof_cache::RoofFaces;
+
+using Heights = decltype(Faces_2_plus_1::heights);
+
+RoofFaces face_triangles(const std::vector<Vector2d>& face, const Heights& heights, double scale)
+{
+  if (!(face.size() >= 3)) {
+    RAISE_ROOF_EXCEPTION("Voronoi error");
+  }
+  // convex partition (actually a triangulation - maybe do a proper convex partition later)
+  Polygon2d face_poly;
+  Outline2d outline;
+  outline.vertices = face;
+  face_poly.addOutline(outline);
+  auto tess = face_poly.tessellate();
+  RoofFaces roof;
+  for (const IndexedFace& triangle : tess->indices) {
+    auto& polygon = roof.emplace_back();
+    for (int tvind : triangle) {
+      Vector3d tv = tess->vertices[tvind];
+      Vector2d v;
+      v << tv[0], tv[1];
+      const auto height = heights.find(v);
+      if (!(height != heights.end())) {
+        RAISE_ROOF_EXCEPTION("Voronoi error");
+      }
+      polygon.emplace_back(v[0] / scale, v[1] / scale, height->second / scale);
+    }
+  }
+  return roof;
+}
+
+// The roof over an outline and its holes. Points inside them are closer to their own edges than to
+// those of other components, so the other components don't change their Voronoi diagram.
+std::shared_ptr<const RoofFaces> component_roof(const Clipper2Lib::Paths64& component, double scale,
+                                                const RoofDiscretizer& discretizer)
+{
+  std::vector<Segment> segments;
+  for (const auto& path : component) {
+    auto prev = path.back();
+    for (auto p : path) {
+      segments.emplace_back(prev.x, prev.y, p.x, p.y);
+      prev = p;
+    }
+  }
+
+  voronoi_diagram vd;
+  ::boost::polygon::construct_voronoi(segments.begin(), segments.end(), &vd);
+  const Faces_2_plus_1 inner_faces = vd_inner_faces(vd, segments, discretizer);
+
+  std::vector<RoofFaces> triangles(inner_faces.faces.size());
+  parallelizable_transform(inner_faces.faces.begin(), inner_faces.faces.end(), triangles.begin(),
+                           [&inner_faces, scale](const std::vector<Vector2d>& face) {
+                             return face_triangles(face, inner_faces.heights, scale);
+                           });
+
+  auto roof = std::make_shared<RoofFaces>();
+  for (auto& face : triangles) {
+    std::move(face.begin(), face.end(), std::back_inserter(*roof));
+  }
+  return roof;
+}
+
+}  // namespace
+
 std::unique_ptr<PolySet> voronoi_diagram_roof(const Polygon2d& poly, const CurveDiscretizer& discretizer)
 {
   PolySetBuilder hatbuilder = PolySetBuilder();
@@ -353,44 +425,32 @@ std::unique_ptr<PolySet> voronoi_diagram_roof(const Polygon2d& poly, const Curve
 
     Clipper2Lib::Paths64 paths = ClipperUtils::fromPolygon2d(poly, scale_bits);
     // sanitize is important e.g. when after converting to 32 bit integers we have double points
-    paths = Clipper2Lib::PolyTreeToPaths64(*ClipperUtils::sanitize(paths));
-    std::vector<Segment> segments;
-
-    for (auto path : paths) {
-      auto prev = path.back();
-      for (auto p : path) {
-        segments.emplace_back(prev.x, prev.y, p.x, p.y);
-        prev = p;
-      }
-    }
-
-    voronoi_diagram vd;
-    ::boost::polygon::construct_voronoi(segments.begin(), segments.end(), &vd);
-    Faces_2_plus_1 inner_faces = vd_inner_faces(vd, segments, RoofDiscretizer(discretizer, scale));
-
-    // roof
-    for (const std::vector<Vector2d>& face : inner_faces.faces) {
-      if (!(face.size() >= 3)) {
-        RAISE_ROOF_EXCEPTION("Voronoi error");
-      }
-      // convex partition (actually a triangulation - maybe do a proper convex partition later)
-      Polygon2d face_poly;
-      Outline2d outline;
-      outline.vertices = face;
-      face_poly.addOutline(outline);
-      auto tess = face_poly.tessellate();
-      for (const IndexedFace& triangle : tess->indices) {
+    const std::unique_ptr<Clipper2Lib::PolyTree64> polytree = ClipperUtils::sanitize(paths);
+    paths = Clipper2Lib::PolyTreeToPaths64(*polytree);
+
+    // roof, computed for the outlines with their holes independently
+    std::vector<Clipper2Lib::Paths64> components = ClipperUtils::components(*polytree);
+    std::vector<Clipper2Lib::Point64> origins;
+    origins.reserve(components.size());
+    for (auto& component : components) origins.push_back(ClipperUtils::moveToOrigin(component));
+
+    std::ostringstream stream;
+    stream << "voronoi " << scale_bits << ' ' << discretizer << '\n';
+    const std::string parameters = stream.str();
+    const RoofDiscretizer roof_discretizer(discretizer, scale);
+    std::vector<std::shared_ptr<const RoofFaces>> roofs(components.size());
+    parallelizable_transform(components.begin(), components.end(), roofs.begin(),
+                             [&](const Clipper2Lib::Paths64& component) {
+                               return roof_cache::get(component, parameters, [&] {
+                                 return component_roof(component, scale, roof_discretizer);
+                               });
+                             });
+
+    for (size_t i = 0; i < roofs.size(); ++i) {
+      const Vector3d origin(origins[i].x / scale, origins[i].y / scale, 0.0);
+      for (const auto& triangle : *roofs[i]) {
         std::vector<int> roof;
-        for (int tvind : triangle) {
-          Vector3d tv = tess->vertices[tvind];
-          Vector2d v;
-          v << tv[0], tv[1];
-          if (!(inner_faces.heights.find(v) != inner_faces.heights.end())) {
-            RAISE_ROOF_EXCEPTION("Voronoi error");
-          }
-          roof.push_back(hatbuilder.vertexIndex(
-            Vector3d(v[0] / scale, v[1] / scale, inner_faces.heights[v] / scale)));
-        }
+        for (const auto& v : triangle) roof.push_back(hatbuilder.vertexIndex(v + origin));
         hatbuilder.appendPolygon(roof);
       }
     }
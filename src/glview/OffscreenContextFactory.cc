@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 
+#include "glview/RenderSettings.h"
 #include "utils/printutils.h"
 
 #ifdef __APPLE__
@@ -46,6 +47,12 @@ const char *defaultProvider()
 #endif  // NULLGL
 }
 
+std::string provider()
+{
+  const auto& provider = RenderSettings::inst()->offscreenProvider;
+  return provider.empty() ? defaultProvider() : provider;
+}
+
 std::shared_ptr<OpenGLContext> create(const std::string& provider,
                                       const OffscreenContextFactory::ContextAttributes& attrib)
 {
@@ -55,6 +62,10 @@ std::shared_ptr<OpenGLContext> create(const std::string& provider,
           (attrib.gles ? "OpenGL ES" : "OpenGL") % attrib.majorGLVersion % attrib.minorGLVersion %
             (attrib.compatibilityProfile ? "(compatibility profile requested)" : ""));
   // FIXME: We should log an error if the chosen provider doesn't support all our attribs.
+  if (provider == SOFTWARE_PROVIDER) {
+    LOG("The %1$s provider doesn't create OpenGL contexts", provider);
+    return nullptr;
+  }
 #ifdef NULLGL
   if (provider == "nullgl") {
     return CreateOffscreenContextNULL();
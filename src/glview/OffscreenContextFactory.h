@@ -17,7 +17,12 @@ struct ContextAttributes {
   bool compatibilityProfile;  // Request a compatibility context (to support legacy OpenGL calls)
 };
 
+// Not a provider of OpenGL contexts: PNG export renders with SoftwareRenderer instead.
+inline constexpr const char *SOFTWARE_PROVIDER = "software";
+
 const char *defaultProvider();
+// The provider selected with RenderSettings::offscreenProvider, or the default one.
+std::string provider();
 std::shared_ptr<OpenGLContext> create(const std::string& provider, const ContextAttributes& attrib);
 
 }  // namespace OffscreenContextFactory
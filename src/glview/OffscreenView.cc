@@ -48,19 +48,19 @@ OffscreenView::OffscreenView(uint32_t width, uint32_t height)
     .majorGLVersion = 2,
     .minorGLVersion = 0,
   };
-  auto provider = OffscreenContextFactory::defaultProvider();
+  auto provider = OffscreenContextFactory::provider();
   // We cannot initialize GLX GLEW with an EGL context:
   // https://github.com/nigels-com/glew/issues/273
   // ..so if we're using GLEW, default to creating a GLX context.
   // FIXME: It's possible that GLEW was built using EGL, in which case this
   // logic isn't correct, but we don't have a good way of determining how GLEW was built.
 #if defined(USE_GLEW) || defined(OPENCSG_GLEW)
-  provider = !strcmp(provider, "egl") ? "glx" : provider;
+  if (provider == "egl") provider = "glx";
 #endif
   this->ctx = OffscreenContextFactory::create(provider, attrib);
   if (!this->ctx) {
     // If the provider defaulted to EGL, fall back to GLX if EGL failed
-    if (!strcmp(provider, "egl")) {
+    if (provider == "egl") {
       this->ctx = OffscreenContextFactory::create("glx", attrib);
     }
     if (!this->ctx) {
@@ -23,6 +23,8 @@ public:
   unsigned int openCSGTermLimit;
   double far_gl_clip_limit;
   std::string colorscheme;
+  // for OffscreenContextFactory, empty for its default provider
+  std::string offscreenProvider;
 
 private:
   RenderSettings();
@@ -0,0 +1,483 @@
+#include "glview/SoftwareRenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "glview/Camera.h"
+#include "glview/ColorMap.h"
+#include "io/imageutils.h"
+#include "utils/degree_trig.h"
+#include "utils/parallel.h"
+#include "utils/printutils.h"
+
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/cgalutils.h"
+#include "geometry/cgal/CGALNefGeometry.h"
+#endif
+#ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/ManifoldGeometry.h"
+#endif
+
+namespace {
+
+// As ViewEdges.frag: the total thickness of the half edge drawn per triangle, in pixels.
+constexpr float EDGE_THICKNESS = 1.414f;
+
+struct ScreenTriangle {
+  // x and y in pixels from the top left corner, z in normalized device coordinates
+  std::array<Vector3d, 3> vertices;
+  Vector4f color;
+  Vector4f edge_color;
+};
+
+// The triangles a face is clipped into by the near plane
+struct ProjectedFace {
+  std::array<ScreenTriangle, 2> triangles;
+  int count = 0;
+};
+
+struct ScreenLine {
+  Vector3d from;
+  Vector3d to;
+  Vector4f color;
+  int width;
+  bool depth_test;
+  bool dashed;
+};
+
+struct Viewport {
+  Matrix4d modelview;
+  Matrix4d projection;
+  int width;
+  int height;
+
+  [[nodiscard]] Vector3d toScreen(const Vector4d& clip) const
+  {
+    const Vector3d ndc = clip.head<3>() / clip.w();
+    return {(ndc.x() + 1) / 2 * width, (1 - ndc.y()) / 2 * height, ndc.z()};
+  }
+};
+
+// As set up by GLView::setupCamera()
+Viewport make_viewport(const Camera& cam)
+{
+  Viewport viewport;
+  viewport.width = static_cast<int>(cam.pixel_width);
+  viewport.height = static_cast<int>(cam.pixel_height);
+  const double aspectratio = 1.0 * viewport.width / viewport.height;
+  const double dist = cam.zoomValue();
+
+  Matrix4d& p = viewport.projection;
+  p.setZero();
+  if (cam.projection == Camera::ProjectionType::PERSPECTIVE) {
+    // gluPerspective()
+    const double near = 0.1 * dist, far = 100 * dist;
+    const double f = 1 / tan_degrees(cam.fov / 2);
+    p(0, 0) = f / aspectratio;
+    p(1, 1) = f;
+    p(2, 2) = (far + near) / (near - far);
+    p(2, 3) = 2 * far * near / (near - far);
+    p(3, 2) = -1;
+  } else {
+    // glOrtho()
+    const double height = dist * tan_degrees(cam.fov / 2);
+    const double near = -100 * dist, far = 100 * dist;
+    p(0, 0) = 1 / (height * aspectratio);
+    p(1, 1) = 1 / height;
+    p(2, 2) = -2 / (far - near);
+    p(2, 3) = -(far + near) / (far - near);
+    p(3, 3) = 1;
+  }
+
+  // gluLookAt() from (0, -dist, 0) at the origin with z up, then the object rotation and translation
+  const Transform3d modelview = Eigen::Translation3d(0, 0, -dist) *
+                                Eigen::AngleAxisd(-90 * M_DEG2RAD, Vector3d::UnitX()) *
+                                Eigen::AngleAxisd(cam.object_rot.x() * M_DEG2RAD, Vector3d::UnitX()) *
+                                Eigen::AngleAxisd(cam.object_rot.y() * M_DEG2RAD, Vector3d::UnitY()) *
+                                Eigen::AngleAxisd(cam.object_rot.z() * M_DEG2RAD, Vector3d::UnitZ()) *
+                                Eigen::Translation3d(cam.object_trans);
+  viewport.modelview = modelview.matrix();
+  return viewport;
+}
+
+// Distance of a clip space vertex inside the near (z >= -w) and far (z <= w) planes
+double near_distance(const Vector4d& v) { return v.z() + v.w(); }
+double far_distance(const Vector4d& v) { return v.w() - v.z(); }
+
+Vector4f to_vector(const Color4f& color) { return {color.r(), color.g(), color.b(), color.a()}; }
+
+ProjectedFace project_face(const Viewport& viewport, const std::array<Vector3d, 3>& vertices,
+                           const Vector4f& color, bool lit)
+{
+  ProjectedFace result;
+  std::array<Vector4d, 3> eye;
+  for (size_t i = 0; i < 3; ++i) {
+    eye[i] = viewport.modelview * vertices[i].homogeneous();
+  }
+
+  Vector4f shaded = color;
+  if (lit) {
+    // As ViewEdges.vert, with light 0 of GLView::initializeGL()
+    const Vector3d normal = (eye[1].head<3>() - eye[0].head<3>())
+                              .cross(eye[2].head<3>() - eye[0].head<3>())
+                              .normalized();
+    const double shading = 0.2 + std::abs(normal.dot(Vector3d(-1, 1, 1).normalized()));
+    shaded.head<3>() = (color.head<3>() * static_cast<float>(shading)).cwiseMin(1.0f);
+  }
+  Vector4f edge_color;
+  edge_color << (color.head<3>().array() + 1.0f) / 2, 1.0f;
+
+  // Clip against the near plane, which leaves a triangle or a quad
+  std::array<Vector4d, 4> polygon;
+  int size = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    const Vector4d a = viewport.projection * eye[i];
+    const Vector4d b = viewport.projection * eye[(i + 1) % 3];
+    const double da = near_distance(a), db = near_distance(b);
+    if (da >= 0) polygon[size++] = a;
+    if ((da >= 0) != (db >= 0)) polygon[size++] = a + (b - a) * (da / (da - db));
+  }
+  for (int i = 1; i + 1 < size; ++i) {
+    auto& triangle = result.triangles[result.count++];
+    triangle.vertices = {viewport.toScreen(polygon[0]), viewport.toScreen(polygon[i]),
+                         viewport.toScreen(polygon[i + 1])};
+    triangle.color = shaded;
+    triangle.edge_color = edge_color;
+  }
+  return result;
+}
+
+// Returns false if the line is outside of the near and far planes.
+bool project_line(const Viewport& viewport, const Vector3d& from, const Vector3d& to, ScreenLine& line)
+{
+  const Matrix4d mvp = viewport.projection * viewport.modelview;
+  Vector4d a = mvp * from.homogeneous();
+  Vector4d b = mvp * to.homogeneous();
+  for (const auto distance : {near_distance, far_distance}) {
+    const double da = distance(a), db = distance(b);
+    if (da < 0 && db < 0) return false;
+    if (da < 0) a = a + (b - a) * (da / (da - db));
+    else if (db < 0) b = b + (a - b) * (db / (db - da));
+  }
+  line.from = viewport.toScreen(a);
+  line.to = viewport.toScreen(b);
+  return true;
+}
+
+class Tile
+{
+public:
+  Tile(int x0, int y0, int x1, int y1, int width, std::vector<Vector4f>& colors,
+       std::vector<float>& depths)
+    : x0(x0), y0(y0), x1(x1), y1(y1), width(width), colors(colors), depths(depths)
+  {
+  }
+
+  void drawBackground(const Vector4f& top, const Vector4f& bottom, int height)
+  {
+    for (int y = y0; y < y1; ++y) {
+      const float t = (y + 0.5f) / height;
+      const Vector4f color = top * (1 - t) + bottom * t;
+      for (int x = x0; x < x1; ++x) {
+        colors[index(x, y)] = color;
+        depths[index(x, y)] = 1.0f;
+      }
+    }
+  }
+
+  void drawTriangle(const ScreenTriangle& triangle, bool edges)
+  {
+    const auto& v = triangle.vertices;
+    const double area = edgeFunction(v[0], v[1], v[2]);
+    if (area == 0 || !std::isfinite(area)) return;
+    const double sign = area < 0 ? -1 : 1;
+
+    // Vertices may be far outside of the view, so clamp in floating point before converting
+    const auto clamp_x = [this](double x) {
+      return static_cast<int>(std::clamp<double>(x, x0, x1 - 1));
+    };
+    const auto clamp_y = [this](double y) {
+      return static_cast<int>(std::clamp<double>(y, y0, y1 - 1));
+    };
+    const int xmin = clamp_x(std::floor(std::min({v[0].x(), v[1].x(), v[2].x()})));
+    const int xmax = clamp_x(std::ceil(std::max({v[0].x(), v[1].x(), v[2].x()})));
+    const int ymin = clamp_y(std::floor(std::min({v[0].y(), v[1].y(), v[2].y()})));
+    const int ymax = clamp_y(std::ceil(std::max({v[0].y(), v[1].y(), v[2].y()})));
+    // Length of the edge opposite of each vertex
+    const std::array<double, 3> lengths = {(v[2] - v[1]).head<2>().norm(),
+                                           (v[0] - v[2]).head<2>().norm(),
+                                           (v[1] - v[0]).head<2>().norm()};
+
+    for (int y = ymin; y <= ymax; ++y) {
+      for (int x = xmin; x <= xmax; ++x) {
+        const Vector3d p(x + 0.5, y + 0.5, 0);
+        const std::array<double, 3> w = {sign * edgeFunction(v[1], v[2], p),
+                                         sign * edgeFunction(v[2], v[0], p),
+                                         sign * edgeFunction(v[0], v[1], p)};
+        if (w[0] < 0 || w[1] < 0 || w[2] < 0) continue;
+        const auto z =
+          static_cast<float>((w[0] * v[0].z() + w[1] * v[1].z() + w[2] * v[2].z()) / (sign * area));
+        const size_t i = index(x, y);
+        if (z < -1.0f || z >= depths[i]) continue;
+        depths[i] = z;
+
+        Vector4f color = triangle.color;
+        if (edges) {
+          // As ViewEdges.frag: fade to the edge color towards the edges
+          const auto distance =
+            static_cast<float>(std::min({w[0] / lengths[0], w[1] / lengths[1], w[2] / lengths[2]}));
+          const float t = std::clamp(distance / EDGE_THICKNESS, 0.0f, 1.0f);
+          const float factor = t * t * (3 - 2 * t);
+          color = triangle.edge_color * (1 - factor) + color * factor;
+        }
+        blend(i, color);
+      }
+    }
+  }
+
+  void drawLine(const ScreenLine& line)
+  {
+    // Clip the line to the tile, grown by its width
+    const Vector3d delta = line.to - line.from;
+    double t0 = 0, t1 = 1;
+    const auto clip = [&](double p, double q) {
+      if (p == 0) return q >= 0;
+      const double t = q / p;
+      if (p < 0) t0 = std::max(t0, t);
+      else t1 = std::min(t1, t);
+      return t0 <= t1;
+    };
+    if (!clip(-delta.x(), line.from.x() - (x0 - line.width)) ||
+        !clip(delta.x(), (x1 + line.width) - line.from.x()) ||
+        !clip(-delta.y(), line.from.y() - (y0 - line.width)) ||
+        !clip(delta.y(), (y1 + line.width) - line.from.y())) {
+      return;
+    }
+
+    // One pixel per step along the major axis, widened along the minor axis
+    const bool steep = std::abs(delta.y()) > std::abs(delta.x());
+    const double steps = std::max(1.0, std::ceil(std::max(std::abs(delta.x()), std::abs(delta.y()))));
+    const auto last = static_cast<long>(std::ceil(t1 * steps));
+    for (auto step = static_cast<long>(std::floor(t0 * steps)); step <= last; ++step) {
+      // As glLineStipple(3, 0xAAAA)
+      if (line.dashed && (step / 3) % 2 == 1) continue;
+      const Vector3d p = line.from + delta * (step / steps);
+      for (int k = 0; k < line.width; ++k) {
+        const int x = static_cast<int>(std::floor(p.x())) + (steep ? k : 0);
+        const int y = static_cast<int>(std::floor(p.y())) + (steep ? 0 : k);
+        if (x < x0 || x >= x1 || y < y0 || y >= y1) continue;
+        const size_t i = index(x, y);
+        const auto z = static_cast<float>(p.z());
+        if (line.depth_test) {
+          if (z >= depths[i]) continue;
+          depths[i] = z;
+        }
+        blend(i, line.color);
+      }
+    }
+  }
+
+private:
+  [[nodiscard]] size_t index(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+
+  static double edgeFunction(const Vector3d& a, const Vector3d& b, const Vector3d& p)
+  {
+    return (b.x() - a.x()) * (p.y() - a.y()) - (b.y() - a.y()) * (p.x() - a.x());
+  }
+
+  // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+  void blend(size_t i, const Vector4f& color)
+  {
+    const float alpha = std::clamp(color.w(), 0.0f, 1.0f);
+    colors[i].head<3>() = color.head<3>() * alpha + colors[i].head<3>() * (1 - alpha);
+  }
+
+  int x0, y0, x1, y1;
+  int width;
+  std::vector<Vector4f>& colors;
+  std::vector<float>& depths;
+};
+
+}  // namespace
+
+SoftwareRenderer::SoftwareRenderer(const std::shared_ptr<const Geometry>& geom)
+  : colorscheme(&ColorMap::inst()->defaultColorScheme())
+{
+  addGeometry(geom);
+}
+
+// Accepts the same geometries as PolySetRenderer::addGeometry()
+void SoftwareRenderer::addGeometry(const std::shared_ptr<const Geometry>& geom)
+{
+  assert(geom != nullptr);
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    for (const auto& item : geomlist->getChildren()) {
+      this->addGeometry(item.second);
+    }
+  } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
+    assert(ps->getDimension() == 3);
+    addPolySet(*PolySetUtils::tessellate_faces(*ps), false);
+  } else if (const auto poly = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+    addPolySet(*poly->tessellate(), true);
+    bbox.extend(poly->getBoundingBox());
+    for (const auto& outline : poly->outlines()) {
+      const auto& vertices = outline.vertices;
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        const auto& next = vertices[(i + 1) % vertices.size()];
+        outlines.emplace_back(Vector3d(vertices[i].x(), vertices[i].y(), 0),
+                              Vector3d(next.x(), next.y(), 0));
+      }
+    }
+#ifdef ENABLE_MANIFOLD
+  } else if (const auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
+    addPolySet(*mani->toPolySet(), false);
+#endif
+#ifdef ENABLE_CGAL
+  } else if (const auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
+    assert(N->getDimension() == 3);
+    if (!N->isEmpty()) {
+      if (auto ps = CGALUtils::createPolySetFromNefPolyhedron3(*N->p3)) {
+        addPolySet(*PolySetUtils::tessellate_faces(*ps), false);
+      }
+    }
+#endif
+  } else {
+    const auto& geom_ref = *geom.get();
+    LOG("Unsupported geom '%1$s' in SoftwareRenderer", typeid(geom_ref).name());
+    assert(false && "Unsupported geom in SoftwareRenderer");
+  }
+}
+
+void SoftwareRenderer::addPolySet(const PolySet& ps, bool flat)
+{
+  if (!flat) bbox.extend(ps.getBoundingBox());
+  faces.reserve(faces.size() + ps.indices.size());
+  for (size_t i = 0; i < ps.indices.size(); ++i) {
+    const auto& polygon = ps.indices[i];
+    Color4f color;
+    if (!ps.color_indices.empty() && ps.color_indices[i] >= 0) color = ps.colors[ps.color_indices[i]];
+    // Tessellated polygons are triangles, but fan out anything else rather than skipping it
+    for (size_t j = 1; j + 1 < polygon.size(); ++j) {
+      const auto& v = ps.vertices;
+      faces.push_back(Face{{v[polygon[0]], v[polygon[j]], v[polygon[j + 1]]}, color, flat});
+    }
+  }
+}
+
+std::vector<uint8_t> SoftwareRenderer::render(const Camera& cam) const
+{
+  const Viewport viewport = make_viewport(cam);
+  const int width = viewport.width, height = viewport.height;
+  if (width <= 0 || height <= 0) return {};
+
+  // As resolved by Renderer::getShaderColor() for ColorMode::MATERIAL
+  const Color4f material = ColorMap::getColor(*colorscheme, RenderColor::OPENCSG_FACE_FRONT_COLOR);
+  const Color4f face_2d = ColorMap::getColor(*colorscheme, RenderColor::CGAL_FACE_2D_COLOR);
+  std::vector<ProjectedFace> projected(faces.size());
+  parallelizable_transform(faces.begin(), faces.end(), projected.begin(), [&](const Face& face) {
+    Color4f color = face.flat ? face_2d : material;
+    if (!face.flat) {
+      if (face.color.hasRgb()) color.setRgb(face.color.r(), face.color.g(), face.color.b());
+      if (face.color.hasAlpha()) color.setAlpha(face.color.a());
+    }
+    return project_face(viewport, face.vertices, to_vector(color), !face.flat);
+  });
+
+  // Bin the triangles by the tiles they may cover, keeping their order
+  const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+  const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+  std::vector<std::vector<const ScreenTriangle *>> bins(static_cast<size_t>(tiles_x) * tiles_y);
+  for (const auto& face : projected) {
+    for (int k = 0; k < face.count; ++k) {
+      const auto& v = face.triangles[k].vertices;
+      const double xmin = std::min({v[0].x(), v[1].x(), v[2].x()});
+      const double xmax = std::max({v[0].x(), v[1].x(), v[2].x()});
+      const double ymin = std::min({v[0].y(), v[1].y(), v[2].y()});
+      const double ymax = std::max({v[0].y(), v[1].y(), v[2].y()});
+      if (!(xmax >= 0 && ymax >= 0 && xmin < width && ymin < height)) continue;
+      const int tx0 = static_cast<int>(std::max(0.0, xmin)) / TILE_SIZE;
+      const int tx1 = static_cast<int>(std::min<double>(width - 1, xmax)) / TILE_SIZE;
+      const int ty0 = static_cast<int>(std::max(0.0, ymin)) / TILE_SIZE;
+      const int ty1 = static_cast<int>(std::min<double>(height - 1, ymax)) / TILE_SIZE;
+      for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) bins[ty * tiles_x + tx].push_back(&face.triangles[k]);
+      }
+    }
+  }
+
+  // Axes as GLView::showAxes() and the outlines of 2D geometry. There are few, so every tile clips them.
+  std::vector<ScreenLine> axes;
+  if (showaxes) {
+    const Vector4f color = to_vector(ColorMap::getColor(*colorscheme, RenderColor::AXES_COLOR));
+    // The axes go to infinity, which is beyond the far plane from anywhere in the view
+    const double length = 1000 * (cam.zoomValue() + cam.object_trans.norm());
+    for (int axis = 0; axis < 3; ++axis) {
+      for (const double direction : {1.0, -1.0}) {
+        ScreenLine line{{}, {}, color, 1, true, direction < 0};
+        if (project_line(viewport, Vector3d::Zero(), Vector3d::Unit(axis) * direction * length, line)) {
+          axes.push_back(line);
+        }
+      }
+    }
+  }
+  std::vector<ScreenLine> edges;
+  const Vector4f edge_2d = to_vector(ColorMap::getColor(*colorscheme, RenderColor::CGAL_EDGE_2D_COLOR));
+  for (const auto& [from, to] : outlines) {
+    ScreenLine line{{}, {}, edge_2d, 2, false, false};
+    if (project_line(viewport, from, to, line)) edges.push_back(line);
+  }
+
+  const auto& cs = *colorscheme;
+  const Vector4f top = to_vector(ColorMap::getColor(cs, RenderColor::BACKGROUND_COLOR));
+  const Vector4f bottom = to_vector(ColorMap::getColor(cs, RenderColor::BACKGROUND_STOP_COLOR));
+  std::vector<Vector4f> colors(static_cast<size_t>(width) * height);
+  std::vector<float> depths(colors.size());
+  std::vector<int> tiles(bins.size());
+  std::iota(tiles.begin(), tiles.end(), 0);
+  std::vector<int> drawn(tiles.size());
+  parallelizable_transform(tiles.begin(), tiles.end(), drawn.begin(), [&](int t) {
+    const int x0 = (t % tiles_x) * TILE_SIZE, y0 = (t / tiles_x) * TILE_SIZE;
+    Tile tile(x0, y0, std::min(x0 + TILE_SIZE, width), std::min(y0 + TILE_SIZE, height), width, colors,
+              depths);
+    tile.drawBackground(top, bottom, height);
+    for (const auto& line : axes) tile.drawLine(line);
+    for (const auto *triangle : bins[t]) tile.drawTriangle(*triangle, showedges);
+    for (const auto& line : edges) tile.drawLine(line);
+    return static_cast<int>(bins[t].size());
+  });
+
+  std::vector<uint8_t> pixels(colors.size() * 4);
+  for (size_t i = 0; i < colors.size(); ++i) {
+    for (int c = 0; c < 3; ++c) {
+      pixels[4 * i + c] = static_cast<uint8_t>(std::clamp(colors[i][c], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    // As GLView::paintGL(), which clears the alpha channel at the end
+    pixels[4 * i + 3] = 255;
+  }
+  PRINTDB("SoftwareRenderer: %d triangles in %d tiles",
+          std::accumulate(drawn.begin(), drawn.end(), 0) % drawn.size());
+  return pixels;
+}
+
+bool SoftwareRenderer::save(const Camera& cam, std::ostream& output) const
+{
+  auto pixels = render(cam);
+  if (pixels.empty()) return false;
+  return write_png(output, pixels.data(), static_cast<int>(cam.pixel_width),
+                   static_cast<int>(cam.pixel_height));
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "glview/ColorMap.h"
+
+class Camera;
+class Geometry;
+class PolySet;
+
+/**
+ * Renders geometry into an image on the CPU, for PNG export without an OpenGL context.
+ *
+ * Selected with the "software" offscreen provider (see OffscreenContextFactory), and used when no
+ * OpenGL context can be created. It draws what GLView and PolySetRenderer draw for a rendered
+ * geometry: the background of the color scheme, the axes, faces with a depth buffer and shaded as by
+ * the ViewEdges shader, optionally with their edges, and 2D geometry with its outlines.
+ *
+ * The image is split into tiles of TILE_SIZE pixels. Triangles are projected and binned by the tiles
+ * they cover, then the tiles are rasterized independently and in parallel, each drawing its triangles
+ * in the order they were added.
+ */
+class SoftwareRenderer
+{
+public:
+  SoftwareRenderer(const std::shared_ptr<const Geometry>& geom);
+
+  [[nodiscard]] BoundingBox getBoundingBox() const { return bbox; }
+  void setColorScheme(const ColorScheme& cs) { colorscheme = &cs; }
+  void setShowAxes(bool enabled) { showaxes = enabled; }
+  void setShowEdges(bool enabled) { showedges = enabled; }
+
+  // RGBA pixels of the view of cam, in rows from top to bottom.
+  [[nodiscard]] std::vector<uint8_t> render(const Camera& cam) const;
+  bool save(const Camera& cam, std::ostream& output) const;
+
+  static constexpr int TILE_SIZE = 64;
+
+private:
+  struct Face {
+    std::array<Vector3d, 3> vertices;
+    // as set on the object, may be invalid
+    Color4f color;
+    // Faces of 2D geometry are drawn unlit in the 2D face color of the color scheme.
+    bool flat;
+  };
+
+  void addGeometry(const std::shared_ptr<const Geometry>& geom);
+  void addPolySet(const PolySet& ps, bool flat);
+
+  std::vector<Face> faces;
+  // of 2D geometry
+  std::vector<std::pair<Vector3d, Vector3d>> outlines;
+  BoundingBox bbox;
+  const ColorScheme *colorscheme;
+  bool showaxes{false};
+  bool showedges{false};
+};
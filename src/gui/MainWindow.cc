@@ -87,6 +87,7 @@
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include "Feature.h"
 #include "core/AST.h"
 #include "core/BuiltinContext.h"
 #include "core/Builtins.h"
@@ -105,6 +106,7 @@
 #include "geometry/Geometry.h"
 #include "geometry/GeometryCache.h"
 #include "geometry/GeometryEvaluator.h"
+#include "geometry/roof_cache.h"
 #include "glview/PolySetRenderer.h"
 #include "glview/cgal/CGALRenderer.h"
 #include "glview/preview/CSGTreeNormalizer.h"
@@ -135,9 +137,11 @@
 #include "gui/TabManager.h"
 #include "gui/UIUtils.h"
 #include "gui/claude/ClaudeWidget.h"
+#include "io/DxfData.h"
 #include "io/dxfdim.h"
 #include "io/export.h"
 #include "io/fileutils.h"
+#include "io/import.h"
 #include "openscad.h"
 #include "platform/PlatformUtils.h"
 #include "utils/exceptions.h"
@@ -202,6 +206,8 @@ QElapsedTimer *MainWindow::progressThrottle = new QElapsedTimer();
 namespace {
 
 const int autoReloadPollingPeriodMS = 200;
+// Fragments of curved shapes in previews of customizer values which are still being dragged.
+const int scrubFragmentLimit = 16;
 const char copyrighttext[] =
   "<p>Copyright (C) 2009-2025 The OpenSCAD Developers</p>"
   "<p>This program is free software; you can redistribute it and/or modify "
@@ -1125,12 +1131,17 @@ void MainWindow::showProgress() { updateStatusBar(qobject_cast<ProgressWidget *>
 
 void MainWindow::report_func(const std::shared_ptr<const AbstractNode>&, void *vp, int mark)
 {
+  auto thisp = static_cast<MainWindow *>(vp);
+  // A scrub preview is stale as soon as a newer value, or the final one, arrives.
+  if (thisp->isScrubbing && (thisp->scrubRequested || thisp->previewRequested)) {
+    throw ProgressCancelException();
+  }
+
   // limit to progress bar update calls to 5 per second
   static const qint64 MIN_TIMEOUT = 200;
   if (progressThrottle->hasExpired(MIN_TIMEOUT)) {
     progressThrottle->start();
 
-    auto thisp = static_cast<MainWindow *>(vp);
     auto v = static_cast<int>((mark * 1000.0) / progress_report_count);
     auto permille = v < 1000 ? v : 999;
     if (permille > thisp->progresswidget->value()) {
@@ -1406,9 +1417,15 @@ void MainWindow::instantiateRoot()
     LOG("Compiling design (CSG Tree generation)...");
     this->processEvents();
 
-    AbstractNode::resetIndexCounter();
+    // Nodes reused from previous evaluations keep their index, which must not be handed out again.
+    if (!Feature::ExperimentalIncrementalInstantiation.is_enabled()) {
+      AbstractNode::resetIndexCounter();
+    }
 
     EvaluationSession session{doc.parent_path().string()};
+    // Scrub previews are instantiated at reduced detail. With incremental-instantiation, only the
+    // modules depending on the dragged parameter are instantiated again.
+    if (this->isScrubbing) session.setFragmentLimit(scrubFragmentLimit);
     ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
     setRenderVariables(builtin_context);
 
@@ -1482,7 +1499,8 @@ void MainWindow::compileCSG()
       renderStatistic.printCacheStatistic();
       this->processEvents();
     } catch (const ProgressCancelException&) {
-      LOG("CSG generation cancelled.");
+      // Scrub previews are cancelled whenever a newer value arrives, which isn't worth reporting.
+      if (!this->isScrubbing) LOG("CSG generation cancelled.");
     } catch (const HardWarningException&) {
       LOG("CSG generation cancelled due to hardwarning being enabled.");
     }
@@ -2234,25 +2252,55 @@ void MainWindow::prepareCompile(const char *afterCompileSlot, bool procevents, b
 
 void MainWindow::actionRenderPreview()
 {
-  static bool preview_requested;
-  preview_requested = true;
+  this->previewRequested = true;
 
   if (GuiLocker::isLocked()) return;
 
   GuiLocker::lock();
-  preview_requested = false;
+  this->previewRequested = false;
+  // Supersedes the previews of values dragged before
+  this->scrubRequested = false;
 
   resetMeasurementsState(false, "Render (not preview) to enable measurements");
 
   prepareCompile("csgRender", !animateDock->isVisible(), true);
   compile(false, false);
 
-  if (preview_requested) {
+  if (this->previewRequested) {
     // if the action was called when the gui was locked, we must request it one more time
     // however, it's not possible to call it directly NOR make the loop
     // it must be called from the mainloop
     QTimer::singleShot(0, this, &MainWindow::actionRenderPreview);
-    return;
+  } else if (this->scrubRequested) {
+    QTimer::singleShot(0, this, &MainWindow::actionScrubPreview);
+  }
+}
+
+/*!
+   Previews a customizer value which is still being dragged, at reduced detail. Events are processed
+   while it runs, and the CSG generation is cancelled once a newer value arrives, which is then
+   previewed instead.
+ */
+void MainWindow::actionScrubPreview()
+{
+  this->scrubRequested = true;
+
+  if (GuiLocker::isLocked()) return;
+
+  GuiLocker::lock();
+  this->scrubRequested = false;
+  this->isScrubbing = true;
+
+  resetMeasurementsState(false, "Render (not preview) to enable measurements");
+
+  prepareCompile("csgRender", true, true);
+  compile(false, false);
+  this->isScrubbing = false;
+
+  if (this->previewRequested) {
+    QTimer::singleShot(0, this, &MainWindow::actionRenderPreview);
+  } else if (this->scrubRequested) {
+    QTimer::singleShot(0, this, &MainWindow::actionScrubPreview);
   }
 }
 
@@ -2981,7 +3029,12 @@ void MainWindow::actionExportFileFormat(int fmt)
     exportInfo.optionsSvg = std::make_shared<ExportSvgOptions>(exportSvgDialog.getOptions());
     actionExport(2, exportInfo);
   } break;
-  default: actionExport(fileformat::is3D(format) ? 3 : fileformat::is2D(format) ? 2 : 0, exportInfo);
+  default:
+    if (fileformat::isAnyDimension(format)) {
+      actionExport(rootGeom && rootGeom->getDimension() == 2 ? 2 : 3, exportInfo);
+    } else {
+      actionExport(fileformat::is3D(format) ? 3 : fileformat::is2D(format) ? 2 : 0, exportInfo);
+    }
   }
 }
 
@@ -3008,6 +3061,9 @@ void MainWindow::actionFlushCaches()
   CGALCache::instance()->clear();
   dxf_dim_cache.clear();
   dxf_cross_cache.clear();
+  clear_dxf_file_cache();
+  clear_svg_cache();
+  roof_cache::clear();
   SourceFileCache::instance()->clear();
 
   setCurrentOutput();
@@ -317,6 +317,7 @@ protected:
 
 public slots:
   void actionRenderPreview();
+  void actionScrubPreview();
 private slots:
   void csgRender();
   void csgReloadRender();
@@ -420,6 +421,11 @@ private:
 
   char const *afterCompileSlot;
   bool procevents{false};
+  // Set while a preview is requested when the GUI is locked, and is then started after it unlocks.
+  bool previewRequested{false};
+  bool scrubRequested{false};
+  // Whether the current preview is of a customizer value which is still being dragged.
+  bool isScrubbing{false};
   QTemporaryFile *tempFile{nullptr};
   ProgressWidget *progresswidget{nullptr};
   CGALWorker *cgalworker;
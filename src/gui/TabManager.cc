@@ -172,6 +172,8 @@ void TabManager::createTab(const QString& filename)
   editor->parameterWidget = new ParameterWidget(par->parameterDock);
   connect(editor->parameterWidget, &ParameterWidget::parametersChanged, par,
           &MainWindow::actionRenderPreview);
+  connect(editor->parameterWidget, &ParameterWidget::parametersScrubbed, par,
+          &MainWindow::actionScrubPreview);
   par->parameterDock->setWidget(editor->parameterWidget);
 
   // clearing default mapping of keyboard shortcut for font size
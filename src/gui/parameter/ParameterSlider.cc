@@ -59,7 +59,11 @@ ParameterSlider::ParameterSlider(QWidget *parent, NumberParameter *parameter,
   ParameterSlider::setValue();
 }
 
-void ParameterSlider::valueApplied() { lastApplied = lastSent; }
+void ParameterSlider::valueApplied()
+{
+  lastApplied = lastSent;
+  scrubbedSinceApplied = false;
+}
 
 // slider handle grabbed
 void ParameterSlider::onSliderPressed() {}
@@ -84,7 +88,9 @@ void ParameterSlider::onSliderChanged(int position)
   doubleSpinBox->blockSignals(true);
   doubleSpinBox->setValue(value);
   doubleSpinBox->blockSignals(false);
-  commitChange(false);
+  // Also emitted while the handle is dragged, which is committed when it is released.
+  if (slider->isSliderDown()) scrubChange();
+  else commitChange(false);
 }
 
 // spin button click or arrow keypress
@@ -107,12 +113,25 @@ void ParameterSlider::commitChange(bool immediate)
   PRINTD(STR("[commit] value=", value, ", parameter->value=", parameter->value, ", lastSent=", lastSent,
              ", lastApplied=", lastApplied));
 #endif
-  if ((immediate && lastApplied != value) || (!immediate && lastSent != value)) {
+  // A value previewed while scrubbing was previewed at reduced detail, so it is applied again even if
+  // the handle is released where it was grabbed.
+  if ((immediate && (lastApplied != value || scrubbedSinceApplied)) ||
+      (!immediate && lastSent != value)) {
     lastSent = parameter->value = value;
     emit changed(immediate);
   }
 }
 
+void ParameterSlider::scrubChange()
+{
+  double value = parameterValue(slider->sliderPosition());
+  if (lastSent != value) {
+    lastSent = parameter->value = value;
+    scrubbedSinceApplied = true;
+    emit scrubbed();
+  }
+}
+
 // Called when populating parameter presets
 void ParameterSlider::setValue()
 {
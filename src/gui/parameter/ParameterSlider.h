@@ -26,10 +26,12 @@ private:
   NumberParameter *parameter;
   boost::optional<double> lastSent;
   boost::optional<double> lastApplied;
+  bool scrubbedSinceApplied{false};
   double minimum;
   double step;
 
   int sliderPosition(double value);
   double parameterValue(int sliderPosition);
   void commitChange(bool immediate);
+  void scrubChange();
 };
@@ -36,6 +36,8 @@ public:
 signals:
   // immediate tells customizer auto preview to skip timeout
   void changed(bool immediate);
+  // the value is still being dragged, and will be committed by changed(true)
+  void scrubbed();
 
 private:
   ParameterObject *parameter;
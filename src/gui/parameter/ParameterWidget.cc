@@ -61,6 +61,11 @@ ParameterWidget::ParameterWidget(QWidget *parent) : QWidget(parent)
   autoPreviewTimer.setSingleShot(true);
 
   connect(&autoPreviewTimer, &QTimer::timeout, this, &ParameterWidget::emitParametersChanged);
+
+  // Throttles rather than debounces, so the preview follows a slider while it is dragged.
+  scrubPreviewTimer.setInterval(150);
+  scrubPreviewTimer.setSingleShot(true);
+  connect(&scrubPreviewTimer, &QTimer::timeout, this, &ParameterWidget::parametersScrubbed);
   connect(checkBoxAutoPreview, &QCheckBox::toggled, [this]() { this->autoPreview(true); });
   connect(comboBoxDetails, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &ParameterWidget::rebuildWidgets);
@@ -180,6 +185,8 @@ void ParameterWidget::emitParametersChanged()
 void ParameterWidget::autoPreview(bool immediate)
 {
   autoPreviewTimer.stop();
+  // Releasing a scrubbed slider commits its value, which supersedes any pending scrub preview.
+  scrubPreviewTimer.stop();
   if (checkBoxAutoPreview->isChecked()) {
     if (immediate) {
       emitParametersChanged();
@@ -237,7 +244,20 @@ void ParameterWidget::onSetDelete()
 
 void ParameterWidget::parameterModified(bool immediate)
 {
-  auto *widget = (ParameterVirtualWidget *)sender();
+  storeModifiedParameter((ParameterVirtualWidget *)sender());
+  autoPreview(immediate);
+}
+
+void ParameterWidget::parameterScrubbed()
+{
+  storeModifiedParameter((ParameterVirtualWidget *)sender());
+  if (checkBoxAutoPreview->isChecked() && !scrubPreviewTimer.isActive()) {
+    scrubPreviewTimer.start();
+  }
+}
+
+void ParameterWidget::storeModifiedParameter(ParameterVirtualWidget *widget)
+{
   ParameterObject *parameter = widget->getParameter();
 
   // When attempting to modify the design default, create a new set to edit.
@@ -269,7 +289,6 @@ void ParameterWidget::parameterModified(bool immediate)
   }
 
   setModified();
-  autoPreview(immediate);
 }
 
 void ParameterWidget::loadSet(size_t index)
@@ -336,6 +355,8 @@ void ParameterWidget::rebuildWidgets()
       ParameterVirtualWidget *parameterWidget = createParameterWidget(parameter, descriptionStyle);
       connect(parameterWidget, &ParameterVirtualWidget::changed, this,
               &ParameterWidget::parameterModified);
+      connect(parameterWidget, &ParameterVirtualWidget::scrubbed, this,
+              &ParameterWidget::parameterScrubbed);
       if (!widgets.count(parameter)) {
         widgets[parameter] = {};
       }
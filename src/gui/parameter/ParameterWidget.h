@@ -50,6 +50,7 @@ private:
 
   QString invalidJsonFile;  // set if a json file was read that could not be parsed
   QTimer autoPreviewTimer;
+  QTimer scrubPreviewTimer;
   bool modified = false;
 
 public:
@@ -74,6 +75,7 @@ protected slots:
   void onSetAdd();
   void onSetDelete();
   void parameterModified(bool immediate);
+  void parameterScrubbed();
   void loadSet(size_t index);
   void createSet(const QString& name);
   void updateSetEditability();
@@ -83,6 +85,9 @@ signals:
   // emitted when the effective values of the parameters have changed,
   // and the model view can be updated
   void parametersChanged();
+  // emitted while a parameter is being dragged, for a quick preview of the values so far;
+  // parametersChanged() follows once it is released
+  void parametersScrubbed();
   // emitted when the sets that would be saved to the json file have changed,
   // and the parameter sets should be saved before closing
   void modificationChanged();
@@ -96,5 +101,6 @@ protected:
   ParameterVirtualWidget *createParameterWidget(ParameterObject *parameter,
                                                 DescriptionStyle descriptionStyle);
   QString getJsonFile(const QString& scadFile);
+  void storeModifiedParameter(ParameterVirtualWidget *widget);
   void cleanSets();
 };
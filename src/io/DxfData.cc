@@ -27,20 +27,25 @@
 #include "io/DxfData.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <filesystem>
 #include <fstream>
-#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <system_error>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/optional.hpp>
 
 #include "core/Value.h"
 #include "geometry/Grid.h"
@@ -75,19 +80,167 @@ struct Line {
   Line(int i1, int i2) : idx{i1, i2} {}
 };
 
+namespace {
+
+// The lines with an end in a cell of the grid, by index into the lines of the entities section
+struct LineEnds {
+  std::vector<int> lines;
+  // lines before this one are disabled
+  size_t first_enabled = 0;
+  // number of ends of enabled lines
+  int enabled = 0;
+};
+
+struct Group {
+  int code;
+  std::string data;
+  // data, if its code is that of a number and it can be converted to one
+  boost::optional<double> number;
+};
+
+// The groups of a DXF file, as read. Imports, dxf_dim() and dxf_cross() share the groups read from a
+// file until it changes, and interpret them according to their own layer, origin and scale.
+struct DxfFile {
+  struct Entity {
+    // range of groups, starting with the one of code 0 naming the entity
+    size_t begin;
+    size_t end;
+    std::string layer;
+  };
+  std::vector<Group> groups;
+  // with the groups before the first entity, if any, as the first one
+  std::vector<Entity> entities;
+  // which ended reading the file, if it isn't a number
+  boost::optional<std::string> illegal_id;
+};
+
+bool is_number_code(int code)
+{
+  return (code >= 10 && code <= 16) || (code >= 20 && code <= 26) || (code >= 40 && code <= 42) ||
+         code == 50 || code == 51;
+}
+
+size_t dxf_file_bytes(const DxfFile& file)
+{
+  size_t bytes = sizeof(DxfFile) + file.groups.capacity() * sizeof(Group) +
+                 file.entities.capacity() * sizeof(DxfFile::Entity);
+  for (const auto& group : file.groups) bytes += group.data.capacity();
+  for (const auto& entity : file.entities) bytes += entity.layer.capacity();
+  return bytes;
+}
+
+// Files are read again once their mtime or size changes.
+struct DxfCacheEntry {
+  std::string file_id;
+  std::shared_ptr<const DxfFile> file;
+  size_t bytes = 0;
+  size_t last_used = 0;
+};
+
+// The files least recently read are dropped once the groups held exceed DXF_CACHE_MAX_BYTES.
+constexpr size_t DXF_CACHE_MAX_BYTES = 64 * 1024 * 1024;
+
+std::mutex dxf_cache_mutex;
+// by filename
+std::unordered_map<std::string, DxfCacheEntry> dxf_cache;
+size_t dxf_cache_bytes = 0;
+size_t dxf_cache_uses = 0;
+
+// Must be called with dxf_cache_mutex held.
+void dxf_cache_insert(const std::string& filename, const std::string& file_id,
+                      std::shared_ptr<const DxfFile> file)
+{
+  const size_t bytes = dxf_file_bytes(*file);
+  if (bytes > DXF_CACHE_MAX_BYTES) return;
+
+  auto& entry = dxf_cache[filename];
+  dxf_cache_bytes -= entry.bytes;
+  entry = DxfCacheEntry{file_id, std::move(file), bytes, ++dxf_cache_uses};
+  dxf_cache_bytes += bytes;
+
+  while (dxf_cache_bytes > DXF_CACHE_MAX_BYTES) {
+    const auto lru =
+      std::min_element(dxf_cache.begin(), dxf_cache.end(), [](const auto& a, const auto& b) {
+        return a.second.last_used < b.second.last_used;
+      });
+    dxf_cache_bytes -= lru->second.bytes;
+    dxf_cache.erase(lru);
+  }
+}
+
+std::shared_ptr<const DxfFile> read_dxf_file(const std::string& filename)
+{
+
+  const auto path = std::filesystem::u8path(filename);
+  std::error_code ec;
+  const auto size = fs::file_size(path, ec);
+  const std::string file_id = ec ? "" : STR(fs_timestamp(path), "|", size);
+  if (!file_id.empty()) {
+    std::lock_guard<std::mutex> lock(dxf_cache_mutex);
+    const auto it = dxf_cache.find(filename);
+    if (it != dxf_cache.end() && it->second.file_id == file_id) {
+      it->second.last_used = ++dxf_cache_uses;
+      return it->second.file;
+    }
+  }
+
+  std::ifstream stream(path);
+  if (!stream.good()) return nullptr;
+
+  auto file = std::make_shared<DxfFile>();
+  file->entities.push_back({0, 0, ""});
+  while (!stream.eof()) {
+    std::string id_str, data;
+    std::getline(stream, id_str);
+    boost::trim(id_str);
+    std::getline(stream, data);
+    boost::trim(data);
+
+    int code;
+    if (!boost::conversion::try_lexical_convert(id_str, code)) {
+      if (!stream.eof()) file->illegal_id = id_str;
+      break;
+    }
+    if (code == 0) file->entities.push_back({file->groups.size(), 0, ""});
+    else if (code == 8) file->entities.back().layer = data;
+    Group group{code, std::move(data), boost::none};
+    double number;
+    if (is_number_code(code) && boost::conversion::try_lexical_convert(group.data, number)) {
+      group.number = number;
+    }
+    file->groups.push_back(std::move(group));
+    file->entities.back().end = file->groups.size();
+  }
+
+  if (!file_id.empty()) {
+    std::lock_guard<std::mutex> lock(dxf_cache_mutex);
+    dxf_cache_insert(filename, file_id, file);
+  }
+  return file;
+}
+
+}  // namespace
+
+void clear_dxf_file_cache()
+{
+  std::lock_guard<std::mutex> lock(dxf_cache_mutex);
+  dxf_cache.clear();
+  dxf_cache_bytes = 0;
+}
+
 /*!
    Reads a layer from the given file, or all layers if layername.empty()
  */
 DxfData::DxfData(CurveDiscretizer discretizer, const std::string& filename, const std::string& layername,
                  double xorigin, double yorigin, double scale)
 {
-  std::ifstream stream(std::filesystem::u8path(filename));
-  if (!stream.good()) {
+  const auto file = read_dxf_file(filename);
+  if (!file) {
     LOG(message_group::Warning, "Can't open DXF file '%1$s'.", filename);
     return;
   }
 
-  Grid2d<std::vector<int>> grid(GRID_COARSE);
+  Grid2d<LineEnds> grid(GRID_COARSE);
   std::vector<Line> lines;                                       // Global lines
   std::unordered_map<std::string, std::vector<Line>> blockdata;  // Lines in blocks
 
@@ -102,8 +255,6 @@ DxfData::DxfData(CurveDiscretizer discretizer, const std::string& filename, cons
     if (in_entities_section && !(layername.empty() || layername == layer)) break;            \
     grid.align(_p1x, _p1y);                                                                  \
     grid.align(_p2x, _p2y);                                                                  \
-    grid.data(_p1x, _p1y).push_back(lines.size());                                           \
-    grid.data(_p2x, _p2y).push_back(lines.size());                                           \
     if (in_entities_section) lines.emplace_back(addPoint(_p1x, _p1y), addPoint(_p2x, _p2y)); \
     if (in_blocks_section && !current_block.empty())                                         \
       blockdata[current_block].emplace_back(addPoint(_p1x, _p1y), addPoint(_p2x, _p2y));     \
@@ -128,243 +279,247 @@ DxfData::DxfData(CurveDiscretizer discretizer, const std::string& filename, cons
   EntityList unsupported_entities_list;
 
   //
-  // Parse DXF file. Will populate this->points, this->dims, lines and blockdata
+  // Interpret the groups of the DXF file. Will populate this->points, this->dims, lines and blockdata
   //
-  while (!stream.eof()) {
-    std::string id_str, data;
-    std::getline(stream, id_str);
-    boost::trim(id_str);
-    std::getline(stream, data);
-    boost::trim(data);
-
-    int id;
-    try {
-      id = boost::lexical_cast<int>(id_str);
-    } catch (const boost::bad_lexical_cast& blc) {
-      if (!stream.eof()) {
-        LOG(message_group::Warning, "Illegal ID '%1$s' in `%2$s'", id_str, filename);
-      }
-      break;
-    }
-    try {
-      if (id >= 10 && id <= 16) {
-        if (in_blocks_section) {
-          coords[id - 10][0] = boost::lexical_cast<double>(data);
-        } else if (id == 11 || id == 12 || id == 16) {
-          coords[id - 10][0] = boost::lexical_cast<double>(data) * scale;
-        } else {
-          coords[id - 10][0] = (boost::lexical_cast<double>(data) - xorigin) * scale;
+  for (const auto& entity : file->entities) {
+    bool skip_entity = false;
+    for (size_t i = entity.begin; i < entity.end && !skip_entity; ++i) {
+      const int id = file->groups[i].code;
+      const std::string& data = file->groups[i].data;
+      const auto number = [&group = file->groups[i]]() {
+        if (!group.number) throw boost::bad_lexical_cast();
+        return *group.number;
+      };
+      try {
+        if (id >= 10 && id <= 16) {
+          if (in_blocks_section) {
+            coords[id - 10][0] = number();
+          } else if (id == 11 || id == 12 || id == 16) {
+            coords[id - 10][0] = number() * scale;
+          } else {
+            coords[id - 10][0] = (number() - xorigin) * scale;
+          }
         }
-      }
 
-      if (id >= 20 && id <= 26) {
-        if (in_blocks_section) {
-          coords[id - 20][1] = boost::lexical_cast<double>(data);
-        } else if (id == 21 || id == 22 || id == 26) {
-          coords[id - 20][1] = boost::lexical_cast<double>(data) * scale;
-        } else {
-          coords[id - 20][1] = (boost::lexical_cast<double>(data) - yorigin) * scale;
+        if (id >= 20 && id <= 26) {
+          if (in_blocks_section) {
+            coords[id - 20][1] = number();
+          } else if (id == 21 || id == 22 || id == 26) {
+            coords[id - 20][1] = number() * scale;
+          } else {
+            coords[id - 20][1] = (number() - yorigin) * scale;
+          }
         }
-      }
 
-      switch (id) {
-      case 0:
-        if (mode == "SECTION") {
-          in_entities_section = iddata == "ENTITIES";
-          in_blocks_section = iddata == "BLOCKS";
-        } else if (mode == "LINE") {
-          ADD_LINE(xverts.at(0), yverts.at(0), xverts.at(1), yverts.at(1));
-        } else if (mode == "LWPOLYLINE") {
-          // assert(xverts.size() == yverts.size());
-          // Get maximum to enforce managed exception if xverts.size() != yverts.size()
-          const int numverts = std::max(xverts.size(), yverts.size());
-          for (int i = 1; i < numverts; ++i) {
-            ADD_LINE(xverts.at(i - 1), yverts.at(i - 1), xverts.at(i % numverts),
-                     yverts.at(i % numverts));
-          }
-          // polyline flag is stored in 'dimtype'
-          if (dimtype & 0x01) {  // closed polyline
-            ADD_LINE(xverts.at(numverts - 1), yverts.at(numverts - 1), xverts.at(0), yverts.at(0));
-          }
-        } else if (mode == "CIRCLE") {
-          const int n = discretizer.getCircularSegmentCount(radius).value_or(3);
-          Vector2d center(xverts.at(0), yverts.at(0));
-          for (int i = 0; i < n; ++i) {
-            const double a1 = (360.0 * i) / n;
-            const double a2 = (360.0 * (i + 1)) / n;
-            ADD_LINE(cos_degrees(a1) * radius + center[0], sin_degrees(a1) * radius + center[1],
-                     cos_degrees(a2) * radius + center[0], sin_degrees(a2) * radius + center[1]);
-          }
-        } else if (mode == "ARC") {
-          Vector2d center(xverts.at(0), yverts.at(0));
-          while (arc_start_angle > arc_stop_angle) {
-            arc_stop_angle += 360.0;
-          }
-          const double arc_angle = arc_stop_angle - arc_start_angle;
-          const int n = discretizer.getCircularSegmentCount(radius, arc_angle).value_or(1);
-          for (int i = 0; i < n; ++i) {
-            const double a1 = arc_start_angle + arc_angle * i / n;
-            const double a2 = arc_start_angle + arc_angle * (i + 1) / n;
-            ADD_LINE(cos_degrees(a1) * radius + center[0], sin_degrees(a1) * radius + center[1],
-                     cos_degrees(a2) * radius + center[0], sin_degrees(a2) * radius + center[1]);
-          }
-        } else if (mode == "ELLIPSE") {
-          // Commented code is meant as documentation of vector math
-          while (ellipse_start_angle > ellipse_stop_angle) ellipse_stop_angle += 2 * M_PI;
-          //				Vector2d center(xverts[0], yverts[0]);
-          Vector2d center(xverts.at(0), yverts.at(0));
-          //				Vector2d ce(xverts[1], yverts[1]);
-          Vector2d ce(xverts.at(1), yverts.at(1));
-          //				double r_major = ce.length();
-          const double r_major = sqrt(ce[0] * ce[0] + ce[1] * ce[1]);
-          //				double rot_angle = ce.angle();
-          double rot_angle;
-          {
-            //					double dot = ce.dot(Vector2d(1.0, 0.0));
-            const double dot = ce[0];
-            double cosval = dot / r_major;
-            if (cosval > 1.0) cosval = 1.0;
-            if (cosval < -1.0) cosval = -1.0;
-            rot_angle = acos(cosval);
-            if (ce[1] < 0.0) rot_angle = 2 * M_PI - rot_angle;
-          }
+        switch (id) {
+        case 0:
+          if (mode == "SECTION") {
+            in_entities_section = iddata == "ENTITIES";
+            in_blocks_section = iddata == "BLOCKS";
+          } else if (mode == "LINE") {
+            ADD_LINE(xverts.at(0), yverts.at(0), xverts.at(1), yverts.at(1));
+          } else if (mode == "LWPOLYLINE") {
+            // assert(xverts.size() == yverts.size());
+            // Get maximum to enforce managed exception if xverts.size() != yverts.size()
+            const int numverts = std::max(xverts.size(), yverts.size());
+            for (int i = 1; i < numverts; ++i) {
+              ADD_LINE(xverts.at(i - 1), yverts.at(i - 1), xverts.at(i % numverts),
+                       yverts.at(i % numverts));
+            }
+            // polyline flag is stored in 'dimtype'
+            if (dimtype & 0x01) {  // closed polyline
+              ADD_LINE(xverts.at(numverts - 1), yverts.at(numverts - 1), xverts.at(0), yverts.at(0));
+            }
+          } else if (mode == "CIRCLE") {
+            const int n = discretizer.getCircularSegmentCount(radius).value_or(3);
+            Vector2d center(xverts.at(0), yverts.at(0));
+            for (int i = 0; i < n; ++i) {
+              const double a1 = (360.0 * i) / n;
+              const double a2 = (360.0 * (i + 1)) / n;
+              ADD_LINE(cos_degrees(a1) * radius + center[0], sin_degrees(a1) * radius + center[1],
+                       cos_degrees(a2) * radius + center[0], sin_degrees(a2) * radius + center[1]);
+            }
+          } else if (mode == "ARC") {
+            Vector2d center(xverts.at(0), yverts.at(0));
+            while (arc_start_angle > arc_stop_angle) {
+              arc_stop_angle += 360.0;
+            }
+            const double arc_angle = arc_stop_angle - arc_start_angle;
+            const int n = discretizer.getCircularSegmentCount(radius, arc_angle).value_or(1);
+            for (int i = 0; i < n; ++i) {
+              const double a1 = arc_start_angle + arc_angle * i / n;
+              const double a2 = arc_start_angle + arc_angle * (i + 1) / n;
+              ADD_LINE(cos_degrees(a1) * radius + center[0], sin_degrees(a1) * radius + center[1],
+                       cos_degrees(a2) * radius + center[0], sin_degrees(a2) * radius + center[1]);
+            }
+          } else if (mode == "ELLIPSE") {
+            // Commented code is meant as documentation of vector math
+            while (ellipse_start_angle > ellipse_stop_angle) ellipse_stop_angle += 2 * M_PI;
+            //				Vector2d center(xverts[0], yverts[0]);
+            Vector2d center(xverts.at(0), yverts.at(0));
+            //				Vector2d ce(xverts[1], yverts[1]);
+            Vector2d ce(xverts.at(1), yverts.at(1));
+            //				double r_major = ce.length();
+            const double r_major = sqrt(ce[0] * ce[0] + ce[1] * ce[1]);
+            //				double rot_angle = ce.angle();
+            double rot_angle;
+            {
+              //					double dot = ce.dot(Vector2d(1.0, 0.0));
+              const double dot = ce[0];
+              double cosval = dot / r_major;
+              if (cosval > 1.0) cosval = 1.0;
+              if (cosval < -1.0) cosval = -1.0;
+              rot_angle = acos(cosval);
+              if (ce[1] < 0.0) rot_angle = 2 * M_PI - rot_angle;
+            }
 
-          // the ratio stored in 'radius; due to the parser code not checking entity type
-          const double r_minor = r_major * radius;
-          const double sweep_angle = ellipse_stop_angle - ellipse_start_angle;
-          const int n =
-            discretizer.getCircularSegmentCount(r_major, sweep_angle / (2 * M_PI) * 360.0).value_or(1);
-          //				Vector2d p1;
-          Vector2d p1{0.0, 0.0};
-          for (int i = 0; i <= n; ++i) {
-            const double a = (ellipse_start_angle + sweep_angle * i / n);
-            //					Vector2d p2(cos(a)*r_major, sin(a)*r_minor);
-            Vector2d p2(cos(a) * r_major, sin(a) * r_minor);
-            //					p2.rotate(rot_angle);
-            Vector2d p2_rot(cos(rot_angle) * p2[0] - sin(rot_angle) * p2[1],
-                            sin(rot_angle) * p2[0] + cos(rot_angle) * p2[1]);
-            //					p2 += center;
-            p2_rot[0] += center[0];
-            p2_rot[1] += center[1];
-            if (i > 0) {
-              //            ADD_LINE(p1[0], p1[1], p2[0], p2[1]);
-              ADD_LINE(p1[0], p1[1], p2_rot[0], p2_rot[1]);
+            // the ratio stored in 'radius; due to the parser code not checking entity type
+            const double r_minor = r_major * radius;
+            const double sweep_angle = ellipse_stop_angle - ellipse_start_angle;
+            const int n =
+              discretizer.getCircularSegmentCount(r_major, sweep_angle / (2 * M_PI) * 360.0).value_or(1);
+            //				Vector2d p1;
+            Vector2d p1{0.0, 0.0};
+            for (int i = 0; i <= n; ++i) {
+              const double a = (ellipse_start_angle + sweep_angle * i / n);
+              //					Vector2d p2(cos(a)*r_major, sin(a)*r_minor);
+              Vector2d p2(cos(a) * r_major, sin(a) * r_minor);
+              //					p2.rotate(rot_angle);
+              Vector2d p2_rot(cos(rot_angle) * p2[0] - sin(rot_angle) * p2[1],
+                              sin(rot_angle) * p2[0] + cos(rot_angle) * p2[1]);
+              //					p2 += center;
+              p2_rot[0] += center[0];
+              p2_rot[1] += center[1];
+              if (i > 0) {
+                //            ADD_LINE(p1[0], p1[1], p2[0], p2[1]);
+                ADD_LINE(p1[0], p1[1], p2_rot[0], p2_rot[1]);
+              }
+              //					p1 = p2;
+              p1[0] = p2_rot[0];
+              p1[1] = p2_rot[1];
             }
-            //					p1 = p2;
-            p1[0] = p2_rot[0];
-            p1[1] = p2_rot[1];
-          }
-        } else if (mode == "INSERT") {
-          // scale is stored in ellipse_start|stop_angle, rotation in arc_start_angle;
-          // due to the parser code not checking entity type
-          const int n = blockdata[iddata].size();
-          for (int i = 0; i < n; ++i) {
-            const double a = arc_start_angle;
-            const double lx1 = this->points[blockdata[iddata][i].idx[0]][0] * ellipse_start_angle;
-            const double ly1 = this->points[blockdata[iddata][i].idx[0]][1] * ellipse_stop_angle;
-            const double lx2 = this->points[blockdata[iddata][i].idx[1]][0] * ellipse_start_angle;
-            const double ly2 = this->points[blockdata[iddata][i].idx[1]][1] * ellipse_stop_angle;
-            const double px1 = (cos_degrees(a) * lx1 - sin_degrees(a) * ly1) * scale + xverts.at(0);
-            const double py1 = (sin_degrees(a) * lx1 + cos_degrees(a) * ly1) * scale + yverts.at(0);
-            const double px2 = (cos_degrees(a) * lx2 - sin_degrees(a) * ly2) * scale + xverts.at(0);
-            const double py2 = (sin_degrees(a) * lx2 + cos_degrees(a) * ly2) * scale + yverts.at(0);
-            ADD_LINE(px1, py1, px2, py2);
+          } else if (mode == "INSERT") {
+            // scale is stored in ellipse_start|stop_angle, rotation in arc_start_angle;
+            // due to the parser code not checking entity type
+            const int n = blockdata[iddata].size();
+            for (int i = 0; i < n; ++i) {
+              const double a = arc_start_angle;
+              const double lx1 = this->points[blockdata[iddata][i].idx[0]][0] * ellipse_start_angle;
+              const double ly1 = this->points[blockdata[iddata][i].idx[0]][1] * ellipse_stop_angle;
+              const double lx2 = this->points[blockdata[iddata][i].idx[1]][0] * ellipse_start_angle;
+              const double ly2 = this->points[blockdata[iddata][i].idx[1]][1] * ellipse_stop_angle;
+              const double px1 = (cos_degrees(a) * lx1 - sin_degrees(a) * ly1) * scale + xverts.at(0);
+              const double py1 = (sin_degrees(a) * lx1 + cos_degrees(a) * ly1) * scale + yverts.at(0);
+              const double px2 = (cos_degrees(a) * lx2 - sin_degrees(a) * ly2) * scale + xverts.at(0);
+              const double py2 = (sin_degrees(a) * lx2 + cos_degrees(a) * ly2) * scale + yverts.at(0);
+              ADD_LINE(px1, py1, px2, py2);
+            }
+          } else if (mode == "DIMENSION" && (layername.empty() || layername == layer)) {
+            this->dims.emplace_back();
+            this->dims.back().type = dimtype;
+            for (int i = 0; i < 7; ++i) {
+              for (int j = 0; j < 2; ++j) {
+                this->dims.back().coords[i][j] = coords[i][j];
+              }
+            }
+            this->dims.back().angle = arc_start_angle;
+            this->dims.back().length = radius;
+            this->dims.back().name = name;
+          } else if (mode == "BLOCK") {
+            current_block = iddata;
+          } else if (mode == "ENDBLK") {
+            current_block.erase();
+          } else if (mode == "ENDSEC") {
+          } else if (in_blocks_section ||
+                     (in_entities_section && (layername.empty() || layername == layer))) {
+            unsupported_entities_list[mode]++;
           }
-        } else if (mode == "DIMENSION" && (layername.empty() || layername == layer)) {
-          this->dims.emplace_back();
-          this->dims.back().type = dimtype;
-          for (int i = 0; i < 7; ++i) {
-            for (int j = 0; j < 2; ++j) {
-              this->dims.back().coords[i][j] = coords[i][j];
+          mode = data;
+          layer.erase();
+          name.erase();
+          iddata.erase();
+          dimtype = 0;
+          for (auto& coord : coords) {
+            for (double& j : coord) {
+              j = 0;
             }
           }
-          this->dims.back().angle = arc_start_angle;
-          this->dims.back().length = radius;
-          this->dims.back().name = name;
-        } else if (mode == "BLOCK") {
-          current_block = iddata;
-        } else if (mode == "ENDBLK") {
-          current_block.erase();
-        } else if (mode == "ENDSEC") {
-        } else if (in_blocks_section ||
-                   (in_entities_section && (layername.empty() || layername == layer))) {
-          unsupported_entities_list[mode]++;
-        }
-        mode = data;
-        layer.erase();
-        name.erase();
-        iddata.erase();
-        dimtype = 0;
-        for (auto& coord : coords) {
-          for (double& j : coord) {
-            j = 0;
+          xverts.clear();
+          yverts.clear();
+          radius = arc_start_angle = arc_stop_angle = 0;
+          ellipse_start_angle = ellipse_stop_angle = 0;
+          if (mode == "INSERT") {
+            ellipse_start_angle = ellipse_stop_angle = 1.0;  // scale
           }
+          // Entities of other layers don't add anything, only those changing the section or block
+          // need to be interpreted.
+          if (in_entities_section && !layername.empty() && entity.layer != layername &&
+              mode != "SECTION" && mode != "BLOCK" && mode != "ENDBLK") {
+            mode.clear();
+            skip_entity = true;
+          }
+          break;
+        case 1:  name = data; break;
+        case 2:  iddata = data; break;
+        case 8:  layer = data; break;
+        case 10: [[fallthrough]];
+        case 11:
+          if (in_blocks_section) {
+            xverts.push_back((number()));
+          } else {
+            xverts.push_back((number() - xorigin) * scale);
+          }
+          break;
+        case 20: [[fallthrough]];
+        case 21:
+          if (in_blocks_section) {
+            yverts.push_back((number()));
+          } else {
+            yverts.push_back((number() - yorigin) * scale);
+          }
+          break;
+        case 40:
+          // CIRCLE, ARC: radius
+          // ELLIPSE: minor to major ratio
+          // DIMENSION (radial, diameter): Leader length
+          radius = number();
+          if (!in_blocks_section) radius *= scale;
+          break;
+        case 41:
+          // ELLIPSE: start_angle
+          // INSERT: X scale
+          ellipse_start_angle = number();
+          break;
+        case 50:
+          // ARC: start_angle
+          // INSERT: rot angle
+          // DIMENSION: linear and rotated: angle
+          arc_start_angle = number();
+          break;
+        case 42:
+          // ELLIPSE: stop_angle
+          // INSERT: Y scale
+          ellipse_stop_angle = number();
+          break;
+        case 51:  // ARC
+          arc_stop_angle = number();
+          break;
+        case 70:
+          // LWPOLYLINE: polyline flag
+          // DIMENSION: dimension type
+          dimtype = boost::lexical_cast<int>(data);
+          break;
         }
-        xverts.clear();
-        yverts.clear();
-        radius = arc_start_angle = arc_stop_angle = 0;
-        ellipse_start_angle = ellipse_stop_angle = 0;
-        if (mode == "INSERT") {
-          ellipse_start_angle = ellipse_stop_angle = 1.0;  // scale
-        }
-        break;
-      case 1:  name = data; break;
-      case 2:  iddata = data; break;
-      case 8:  layer = data; break;
-      case 10: [[fallthrough]];
-      case 11:
-        if (in_blocks_section) {
-          xverts.push_back((boost::lexical_cast<double>(data)));
-        } else {
-          xverts.push_back((boost::lexical_cast<double>(data) - xorigin) * scale);
-        }
-        break;
-      case 20: [[fallthrough]];
-      case 21:
-        if (in_blocks_section) {
-          yverts.push_back((boost::lexical_cast<double>(data)));
-        } else {
-          yverts.push_back((boost::lexical_cast<double>(data) - yorigin) * scale);
-        }
-        break;
-      case 40:
-        // CIRCLE, ARC: radius
-        // ELLIPSE: minor to major ratio
-        // DIMENSION (radial, diameter): Leader length
-        radius = boost::lexical_cast<double>(data);
-        if (!in_blocks_section) radius *= scale;
-        break;
-      case 41:
-        // ELLIPSE: start_angle
-        // INSERT: X scale
-        ellipse_start_angle = boost::lexical_cast<double>(data);
-        break;
-      case 50:
-        // ARC: start_angle
-        // INSERT: rot angle
-        // DIMENSION: linear and rotated: angle
-        arc_start_angle = boost::lexical_cast<double>(data);
-        break;
-      case 42:
-        // ELLIPSE: stop_angle
-        // INSERT: Y scale
-        ellipse_stop_angle = boost::lexical_cast<double>(data);
-        break;
-      case 51:  // ARC
-        arc_stop_angle = boost::lexical_cast<double>(data);
-        break;
-      case 70:
-        // LWPOLYLINE: polyline flag
-        // DIMENSION: dimension type
-        dimtype = boost::lexical_cast<int>(data);
-        break;
+      } catch (boost::bad_lexical_cast& blc) {
+        LOG(message_group::Warning, "Illegal value '%1$s'in `%2$s'", data, filename);
+      } catch (const std::out_of_range& oor) {
+        LOG(message_group::Warning, "Not enough input values for %1$s. in '%2$s'", data, filename);
       }
-    } catch (boost::bad_lexical_cast& blc) {
-      LOG(message_group::Warning, "Illegal value '%1$s'in `%2$s'", data, filename);
-    } catch (const std::out_of_range& oor) {
-      LOG(message_group::Warning, "Not enough input values for %1$s. in '%2$s'", data, filename);
     }
   }
+  if (file->illegal_id) {
+    LOG(message_group::Warning, "Illegal ID '%1$s' in `%2$s'", *file->illegal_id, filename);
+  }
 
   for (const auto& i : unsupported_entities_list) {
     if (layername.empty()) {
@@ -378,113 +533,83 @@ DxfData::DxfData(CurveDiscretizer discretizer, const std::string& filename, cons
 
   // Extract paths from parsed data
 
-  using LineMap = std::map<int, int>;
-  LineMap enabled_lines;
-  for (size_t i = 0; i < lines.size(); ++i) {
-    enabled_lines[i] = i;
+  // The cells of the grid list the lines ending in them. Lines are disabled once they are part of a
+  // path.
+  std::vector<std::array<LineEnds *, 2>> line_ends(lines.size());
+  for (size_t k = 0; k < lines.size(); ++k) {
+    for (int j = 0; j < 2; ++j) {
+      const auto& point = this->points[lines[k].idx[j]];
+      auto& cell = grid.data(point[0], point[1]);
+      cell.lines.push_back(k);
+      ++cell.enabled;
+      line_ends[k][j] = &cell;
+    }
   }
 
-  // extract all open paths
-  while (enabled_lines.size() > 0) {
-    int current_line, current_point;
-
-    for (const auto& l : enabled_lines) {
-      const int idx = l.second;
-      for (int j = 0; j < 2; ++j) {
-        auto lv = grid.data(this->points[lines[idx].idx[j]][0], this->points[lines[idx].idx[j]][1]);
-        for (const int k : lv) {
-          if (k < 0 || static_cast<unsigned int>(k) >= lines.size()) {
-            LOG(message_group::Warning, "Bad DXF line index in %1$s.",
-                QuotedString(fs_uncomplete(filename, fs::current_path()).generic_string()));
-            continue;
-          }
-          if (k == idx || lines[k].disabled) continue;
-          goto next_open_path_j;
-        }
-        current_line = idx;
-        current_point = j;
-        goto create_open_path;
-      next_open_path_j:;
+  // An end of a line is open if no other enabled line ends in its cell. Open paths start at the first
+  // open end of the first line having one. open_lines holds the lines with open ends, and possibly
+  // lines which have been disabled since.
+  std::set<int> open_lines;
+  const auto is_open = [&](int k, int j) {
+    const auto& cell = *line_ends[k][j];
+    if (cell.enabled > 2) return false;
+    return std::all_of(cell.lines.begin(), cell.lines.end(),
+                       [&](int l) { return l == k || lines[l].disabled; });
+  };
+  // Cells drop their disabled lines once no more than two enabled ones are left, so checking for
+  // open ends doesn't scan all the lines which ended in a cell.
+  const auto disable = [&](int k) {
+    lines[k].disabled = true;
+    for (auto *cell : line_ends[k]) {
+      if (--cell->enabled > 2) continue;
+      cell->lines.erase(std::remove_if(cell->lines.begin(), cell->lines.end(),
+                                       [&](int l) { return lines[l].disabled; }),
+                        cell->lines.end());
+      cell->first_enabled = 0;
+      for (const int l : cell->lines) {
+        if (is_open(l, 0) || is_open(l, 1)) open_lines.insert(l);
       }
     }
-
-    break;
-
-  create_open_path:
-    this->paths.emplace_back();
-    Path *this_path = &this->paths.back();
-
-    this_path->indices.push_back(lines[current_line].idx[current_point]);
-    while (true) {
-      this_path->indices.push_back(lines[current_line].idx[!current_point]);
-      const auto& ref_point = this->points[lines[current_line].idx[!current_point]];
-      lines[current_line].disabled = true;
-      enabled_lines.erase(current_line);
-      auto lv = grid.data(ref_point[0], ref_point[1]);
-      for (const int k : lv) {
-        if (k < 0 || static_cast<unsigned int>(k) >= lines.size()) {
-          LOG(message_group::Warning, "Bad DXF line index in %1$s.",
-              QuotedString(fs_uncomplete(filename, fs::current_path()).generic_string()));
-          continue;
-        }
-        if (lines[k].disabled) continue;
-        auto idk0 = lines[k].idx[0];  // make it easier to read and debug
-        auto idk1 = lines[k].idx[1];
-        if (grid.eq(ref_point[0], ref_point[1], this->points[idk0][0], this->points[idk0][1])) {
-          current_line = k;
-          current_point = 0;
-          goto found_next_line_in_open_path;
-        }
-        if (grid.eq(ref_point[0], ref_point[1], this->points[idk1][0], this->points[idk1][1])) {
-          current_line = k;
-          current_point = 1;
-          goto found_next_line_in_open_path;
-        }
-      }
-      break;
-    found_next_line_in_open_path:;
+  };
+  // Continues a path at point with the first enabled line ending there, as listed by its cell.
+  const auto next_line = [&](const Vector2d& point, int& current_line, int& current_point) {
+    auto& cell = grid.data(point[0], point[1]);
+    while (cell.first_enabled < cell.lines.size() && lines[cell.lines[cell.first_enabled]].disabled) {
+      ++cell.first_enabled;
     }
-  }
-
-  // extract all closed paths
-  while (enabled_lines.size() > 0) {
-    int current_line = enabled_lines.begin()->second;
-    int current_point = 0;
-
+    if (cell.first_enabled == cell.lines.size()) return false;
+    current_line = cell.lines[cell.first_enabled];
+    current_point = line_ends[current_line][0] == &cell ? 0 : 1;
+    return true;
+  };
+  const auto extract_path = [&](int current_line, int current_point, bool is_closed) {
     this->paths.emplace_back();
     auto& this_path = this->paths.back();
-    this_path.is_closed = true;
+    this_path.is_closed = is_closed;
 
     this_path.indices.push_back(lines[current_line].idx[current_point]);
-    while (true) {
+    do {
       this_path.indices.push_back(lines[current_line].idx[!current_point]);
       const auto& ref_point = this->points[lines[current_line].idx[!current_point]];
-      lines[current_line].disabled = true;
-      enabled_lines.erase(current_line);
-      auto lv = grid.data(ref_point[0], ref_point[1]);
-      for (const int k : lv) {
-        if (k < 0 || static_cast<unsigned int>(k) >= lines.size()) {
-          LOG(message_group::Warning, "Bad DXF line index in %1$s.",
-              QuotedString(fs_uncomplete(filename, fs::current_path()).generic_string()));
-          continue;
-        }
-        if (lines[k].disabled) continue;
-        auto idk0 = lines[k].idx[0];  // make it easier to read and debug
-        auto idk1 = lines[k].idx[1];
-        if (grid.eq(ref_point[0], ref_point[1], this->points[idk0][0], this->points[idk0][1])) {
-          current_line = k;
-          current_point = 0;
-          goto found_next_line_in_closed_path;
-        }
-        if (grid.eq(ref_point[0], ref_point[1], this->points[idk1][0], this->points[idk1][1])) {
-          current_line = k;
-          current_point = 1;
-          goto found_next_line_in_closed_path;
-        }
-      }
-      break;
-    found_next_line_in_closed_path:;
-    }
+      disable(current_line);
+      if (!next_line(ref_point, current_line, current_point)) break;
+    } while (true);
+  };
+
+  // extract all open paths
+  for (size_t k = 0; k < lines.size(); ++k) {
+    if (is_open(k, 0) || is_open(k, 1)) open_lines.insert(k);
+  }
+  while (!open_lines.empty()) {
+    const int current_line = *open_lines.begin();
+    open_lines.erase(open_lines.begin());
+    if (lines[current_line].disabled) continue;
+    extract_path(current_line, is_open(current_line, 0) ? 0 : 1, false);
+  }
+
+  // extract all closed paths
+  for (size_t k = 0; k < lines.size(); ++k) {
+    if (!lines[k].disabled) extract_path(k, 0, true);
   }
 
   fixup_path_direction();
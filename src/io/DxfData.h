@@ -49,3 +49,6 @@ public:
   [[nodiscard]] std::string dump() const;
   [[nodiscard]] std::unique_ptr<class Polygon2d> toPolygon2d() const;
 };
+
+// Drops the files read by DxfData, dxf_dim() and dxf_cross(), which are kept until they change.
+void clear_dxf_file_cache();
@@ -0,0 +1,50 @@
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "core/CurveDiscretizer.h"
+#include "io/DxfData.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void write_line_dxf(const fs::path& path, int length)
+{
+  std::ofstream dxf(path);
+  dxf << "  0\nSECTION\n  2\nENTITIES\n"
+      << "  0\nLINE\n  8\n0\n 10\n0\n 20\n0\n 11\n" << length << "\n 21\n0\n"
+      << "  0\nENDSEC\n  0\nEOF\n";
+}
+
+double read_length(const fs::path& path)
+{
+  const DxfData data(CurveDiscretizer(30), path.string());
+  REQUIRE(data.paths.size() == 1);
+  const auto& indices = data.paths[0].indices;
+  return (data.points[indices.back()] - data.points[indices.front()]).norm();
+}
+
+}  // namespace
+
+TEST_CASE("DxfData reads files again once they change", "[Import][DXF]")
+{
+  const fs::path path = fs::temp_directory_path() / "openscad-dxf-cache-test.dxf";
+  clear_dxf_file_cache();
+
+  write_line_dxf(path, 10);
+  CHECK(read_length(path) == Catch::Approx(10));
+  // Read from the cache
+  CHECK(read_length(path) == Catch::Approx(10));
+
+  // The file's size changes as well, so its timestamp's resolution doesn't matter
+  write_line_dxf(path, 200);
+  CHECK(read_length(path) == Catch::Approx(200));
+
+  clear_dxf_file_cache();
+  CHECK(read_length(path) == Catch::Approx(200));
+
+  fs::remove(path);
+}
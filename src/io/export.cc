@@ -97,6 +97,7 @@ Containers& containers()
     add_item(*containers, {FileFormat::PNG, "png", "png", "PNG"});
     add_item(*containers, {FileFormat::PDF, "pdf", "pdf", "PDF"});
     add_item(*containers, {FileFormat::POV, "pov", "pov", "POV"});
+    add_item(*containers, {FileFormat::OGEOM, "ogeom", "ogeom", "OpenSCAD geometry (binary)"});
 
     // Alias
     containers->identifierToInfo["stl"] = containers->identifierToInfo["asciistl"];
@@ -171,6 +172,8 @@ bool is2D(FileFormat format)
   return format == FileFormat::DXF || format == FileFormat::SVG || format == FileFormat::PDF;
 }
 
+bool isAnyDimension(FileFormat format) { return format == FileFormat::OGEOM; }
+
 }  // namespace fileformat
 
 ExportInfo createExportInfo(const FileFormat& format, const FileFormatInfo& info,
@@ -214,6 +217,7 @@ static void exportFile(const std::shared_ptr<const Geometry>& root_geom, std::os
   case FileFormat::SVG:        export_svg(root_geom, output, exportInfo); break;
   case FileFormat::PDF:        export_pdf(root_geom, output, exportInfo); break;
   case FileFormat::POV:        export_pov(root_geom, output, exportInfo); break;
+  case FileFormat::OGEOM:      export_ogeom(root_geom, output); break;
 #ifdef ENABLE_CGAL
   case FileFormat::NEFDBG: export_nefdbg(root_geom, output); break;
   case FileFormat::NEF3:   export_nef3(root_geom, output); break;
@@ -236,7 +240,7 @@ bool exportFileByName(const std::shared_ptr<const Geometry>& root_geom, const st
 {
   std::ios::openmode mode = std::ios::out | std::ios::trunc;
   if (exportInfo.format == FileFormat::_3MF || exportInfo.format == FileFormat::BINARY_STL ||
-      exportInfo.format == FileFormat::PDF) {
+      exportInfo.format == FileFormat::PDF || exportInfo.format == FileFormat::OGEOM) {
     mode |= std::ios::binary;
   }
   const std::filesystem::path path(filename);
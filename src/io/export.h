@@ -45,7 +45,8 @@ enum class FileFormat {
   PNG,
   PDF,
   POV,
-  PARAM
+  PARAM,
+  OGEOM
 };
 
 struct FileFormatInfo {
@@ -69,6 +70,8 @@ const std::string& toSuffix(FileFormat format);
 bool canPreview(FileFormat format);
 bool is3D(FileFormat format);
 bool is2D(FileFormat format);
+// Formats which hold either 2D or 3D geometry, exported with the dimension of the geometry.
+bool isAnyDimension(FileFormat format);
 
 }  // namespace fileformat
 
@@ -315,6 +318,7 @@ void export_3mf(const std::shared_ptr<const Geometry>& geom, std::ostream& outpu
 void export_obj(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_off(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_wrl(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
+void export_ogeom(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_amf(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_dxf(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_svg(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
@@ -364,7 +368,13 @@ std::string get_current_iso8601_date_time_utc();
 std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& options, Camera& camera);
 bool export_png(const std::shared_ptr<const class Geometry>& root_geom, const ViewOptions& options,
                 Camera& camera, std::ostream& output);
+// One image per camera, all of the same size, written to the output of the same index. The geometry is
+// prepared for rendering once.
+bool export_png(const std::shared_ptr<const class Geometry>& root_geom, const ViewOptions& options,
+                std::vector<Camera>& cameras, const std::vector<std::ostream *>& outputs);
 bool export_png(const OffscreenView& glview, std::ostream& output);
+// Draw a prepared view again from another camera
+bool export_png(OffscreenView& glview, Camera& camera, std::ostream& output);
 bool export_param(SourceFile *root, const fs::path& path, std::ostream& output);
 
 std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps);
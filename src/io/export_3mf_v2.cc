@@ -29,13 +29,18 @@
 #include <algorithm>
 #include <cstddef>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include <boost/functional/hash.hpp>
 #include <lib3mf_implicit.hpp>
 
 #include "export_enums.h"
@@ -60,6 +65,23 @@ using ExportColorMap = std::unordered_map<Color4f, Lib3MF_uint32>;
 
 namespace {
 
+// A mesh object already in the model. Meshes equal up to a translation are written once, see
+// append_polyset(). Only the object is kept, its geometry is read back from it for comparisons.
+struct ExportedMesh {
+  Lib3MF::PMeshObject mesh;
+  // The minimum of the bounding box of the mesh object's vertices.
+  Vector3d offset;
+  bool colored;
+};
+
+// A mesh as compared to those already in the model, with positions relative to offset.
+struct MeshData {
+  Vector3d offset;
+  std::vector<Lib3MF::sPosition> positions;
+  std::vector<Lib3MF::sTriangle> triangles;
+  std::vector<Lib3MF::sTriangleProperties> properties;
+};
+
 struct ExportContext {
   Lib3MF::PWrapper wrapper;
   Lib3MF::PModel model;
@@ -70,6 +92,10 @@ struct ExportContext {
   Color4f selectedColor;
   const ExportInfo& info;
   const std::shared_ptr<const Export3mfOptions> options;
+  int meshcount = 0;
+  int partcount = 0;
+  // by hash_mesh()
+  std::unordered_multimap<size_t, ExportedMesh> meshes;
 };
 
 uint32_t lib3mf_write_callback(const char *data, uint32_t bytes, std::ostream *stream)
@@ -86,131 +112,178 @@ uint32_t lib3mf_seek_callback(uint64_t pos, std::ostream *stream)
 
 void export_3mf_error(std::string msg) { LOG(message_group::Export_Error, std::move(msg)); }
 
-int count_mesh_objects(const Lib3MF::PModel& model)
+template <typename T>
+std::string_view as_bytes(const std::vector<T>& elements)
 {
-  const auto mesh_object_it = model->GetMeshObjects();
-  int count = 0;
-  while (mesh_object_it->MoveNext()) ++count;
-  return count;
+  return {reinterpret_cast<const char *>(elements.data()), elements.size() * sizeof(T)};
 }
 
-void handle_triangle_color(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx,
-                           Lib3MF::PMeshObject& mesh, Lib3MF_uint32 triangle, int color_index)
+size_t hash_mesh(const MeshData& mesh)
 {
-  if (color_index < 0) {
-    return;
-  }
-  if (ps->colors.empty()) {
-    return;
+  size_t seed = 0;
+  boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(mesh.positions)));
+  boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(mesh.triangles)));
+  boost::hash_combine(seed, std::hash<std::string_view>()(as_bytes(mesh.properties)));
+  return seed;
+}
+
+// Triangles and properties must match exactly. The model holds absolute positions rounded to floats,
+// so relative positions are compared up to that rounding.
+bool equal_meshes(const ExportedMesh& a, const MeshData& b)
+{
+  if (a.colored != !b.properties.empty()) return false;
+  std::vector<Lib3MF::sTriangle> triangles;
+  a.mesh->GetTriangleIndices(triangles);
+  if (as_bytes(triangles) != as_bytes(b.triangles)) return false;
+  if (a.colored) {
+    std::vector<Lib3MF::sTriangleProperties> properties;
+    a.mesh->GetAllTriangleProperties(properties);
+    if (as_bytes(properties) != as_bytes(b.properties)) return false;
   }
-  if (!ctx.basematerialgroup && !ctx.colorgroup) {
-    return;
+
+  std::vector<Lib3MF::sPosition> positions;
+  a.mesh->GetVertices(positions);
+  if (positions.size() != b.positions.size()) return false;
+  constexpr double eps = std::numeric_limits<float>::epsilon();
+  for (size_t i = 0; i < positions.size(); ++i) {
+    for (int k = 0; k < 3; ++k) {
+      const double absolute = positions[i].m_Coordinates[k];
+      const double relative = b.positions[i].m_Coordinates[k];
+      const double tolerance = eps * std::max({1.0, std::abs(absolute), std::abs(relative)});
+      if (std::abs(absolute - a.offset[k] - relative) > tolerance) return false;
+    }
   }
+  return true;
+}
+
+// The resource id of the colors of the model, or 0 if triangles aren't colored.
+Lib3MF_uint32 color_resource_id(const ExportContext& ctx)
+{
   if (ctx.options->colorMode == Export3mfColorMode::selected_only) {
-    return;
+    return 0;
+  }
+  if (ctx.basematerialgroup) {
+    return ctx.basematerialgroup->GetUniqueResourceID();
+  } else if (ctx.colorgroup) {
+    return ctx.colorgroup->GetUniqueResourceID();
   }
+  return 0;
+}
 
-  const Color4f col = ps->colors[color_index];
+Lib3MF_uint32 color_property(const Color4f& col, ExportContext& ctx)
+{
   const auto col_it = ctx.colors.find(col);
+  if (col_it != ctx.colors.end()) {
+    return (*col_it).second;
+  }
 
   Lib3MF_uint32 col_idx = 0;
-  if (col_it == ctx.colors.end()) {
-    Lib3MF::sColor materialcolor;
-    if (!col.getRgba(materialcolor.m_Red, materialcolor.m_Green, materialcolor.m_Blue,
-                     materialcolor.m_Alpha)) {
-      LOG(message_group::Warning, "Invalid color in 3MF export");
-    }
-    if (ctx.basematerialgroup) {
-      col_idx = ctx.basematerialgroup->AddMaterial(
-        "Color " + std::to_string(ctx.basematerialgroup->GetCount()), materialcolor);
-    } else if (ctx.colorgroup) {
-      col_idx = ctx.colorgroup->AddColor(materialcolor);
-    }
-    ctx.colors[col] = col_idx;
-  } else {
-    col_idx = (*col_it).second;
+  Lib3MF::sColor materialcolor;
+  if (!col.getRgba(materialcolor.m_Red, materialcolor.m_Green, materialcolor.m_Blue,
+                   materialcolor.m_Alpha)) {
+    LOG(message_group::Warning, "Invalid color in 3MF export");
   }
-
-  Lib3MF_uint32 res_id = 0;
   if (ctx.basematerialgroup) {
-    res_id = ctx.basematerialgroup->GetUniqueResourceID();
+    col_idx = ctx.basematerialgroup->AddMaterial(
+      "Color " + std::to_string(ctx.basematerialgroup->GetCount()), materialcolor);
   } else if (ctx.colorgroup) {
-    res_id = ctx.colorgroup->GetUniqueResourceID();
-  }
-
-  if (res_id > 0) {
-    mesh->SetTriangleProperties(triangle, {res_id, {col_idx, col_idx, col_idx}});
+    col_idx = ctx.colorgroup->AddColor(materialcolor);
   }
+  ctx.colors[col] = col_idx;
+  return col_idx;
 }
 
 /*
  * PolySet must be triangulated.
+ *
+ * The mesh is passed to lib3mf as a whole. A mesh equal to one already in the model up to a translation
+ * only adds a build item, referencing the existing mesh object with that translation.
  */
 bool append_polyset(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx)
 {
   try {
-    auto mesh = ctx.model->AddMeshObject();
-    if (!mesh) return false;
-
-    const int mesh_count = count_mesh_objects(ctx.model);
-    const auto modelname =
-      ctx.modelcount == 1 ? "OpenSCAD Model" : "OpenSCAD Model " + std::to_string(mesh_count);
-    const auto partname = ctx.modelcount == 1 ? "" : "Part " + std::to_string(mesh_count);
-    mesh->SetName(modelname);
-    if (ctx.basematerialgroup) {
-      mesh->SetObjectLevelProperty(ctx.basematerialgroup->GetUniqueResourceID(), 1);
-    } else if (ctx.colorgroup) {
-      mesh->SetObjectLevelProperty(ctx.colorgroup->GetUniqueResourceID(), 1);
-    }
-
-    auto vertexFunc = [&](const Vector3d& coords) -> bool {
-      const auto f = coords.cast<float>();
-      try {
-        const Lib3MF::sPosition v{f[0], f[1], f[2]};
-        mesh->AddVertex(v);
-      } catch (Lib3MF::ELib3MFException& e) {
-        export_3mf_error(e.what());
-        return false;
-      }
-      return true;
-    };
-
-    auto triangleFunc = [&](const IndexedFace& indices, int color_index) -> bool {
-      try {
-        const auto triangle = mesh->AddTriangle({static_cast<Lib3MF_uint32>(indices[0]),
-                                                 static_cast<Lib3MF_uint32>(indices[1]),
-                                                 static_cast<Lib3MF_uint32>(indices[2])});
-
-        handle_triangle_color(ps, ctx, mesh, triangle, color_index);
-      } catch (Lib3MF::ELib3MFException& e) {
-        export_3mf_error(e.what());
-        return false;
-      }
-      return true;
-    };
-
     std::shared_ptr<const PolySet> out_ps = ps;
     if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
       out_ps = createSortedPolySet(*ps);
     }
 
+    // Positions are compared relative to the minimum of the bounding box, as written to the file.
+    MeshData exported;
+    exported.offset = Vector3d::Zero();
+    if (!out_ps->vertices.empty()) exported.offset = out_ps->getBoundingBox().min();
+    exported.positions.reserve(out_ps->vertices.size());
     for (const auto& v : out_ps->vertices) {
-      if (!vertexFunc(v)) {
-        export_3mf_error("Can't add vertex to 3MF model.");
-        return false;
+      const auto f = (v - exported.offset).cast<float>();
+      exported.positions.push_back({f[0], f[1], f[2]});
+    }
+    exported.triangles.reserve(out_ps->indices.size());
+    for (const auto& indices : out_ps->indices) {
+      exported.triangles.push_back({static_cast<Lib3MF_uint32>(indices[0]),
+                                    static_cast<Lib3MF_uint32>(indices[1]),
+                                    static_cast<Lib3MF_uint32>(indices[2])});
+    }
+
+    // Triangles without a color of their own get the object level property.
+    const Lib3MF_uint32 res_id = out_ps->colors.empty() ? 0 : color_resource_id(ctx);
+    for (size_t i = 0; res_id > 0 && i < out_ps->color_indices.size(); i++) {
+      const auto color_index = out_ps->color_indices[i];
+      if (color_index < 0) continue;
+      if (exported.properties.empty()) {
+        exported.properties.assign(out_ps->indices.size(), {res_id, {1, 1, 1}});
       }
+      const auto col_idx = color_property(out_ps->colors[color_index], ctx);
+      exported.properties[i] = {res_id, {col_idx, col_idx, col_idx}};
     }
 
-    for (size_t i = 0; i < out_ps->indices.size(); i++) {
-      auto color_index = i < out_ps->color_indices.size() ? out_ps->color_indices[i] : -1;
-      if (!triangleFunc(out_ps->indices[i], color_index)) {
-        export_3mf_error("Can't add triangle to 3MF model.");
+    ++ctx.partcount;
+    const auto partname = ctx.modelcount == 1 ? "" : "Part " + std::to_string(ctx.partcount);
+    const size_t hash = hash_mesh(exported);
+    const auto [first, last] = ctx.meshes.equal_range(hash);
+    const auto existing =
+      std::find_if(first, last, [&](const auto& entry) { return equal_meshes(entry.second, exported); });
+
+    Lib3MF::PMeshObject mesh;
+    Lib3MF::sTransform transform = ctx.wrapper->GetIdentityTransform();
+    if (existing != last) {
+      mesh = existing->second.mesh;
+      const auto translation = (exported.offset - existing->second.offset).cast<float>();
+      for (int i = 0; i < 3; ++i) transform.m_Fields[3][i] = translation[i];
+    } else {
+      mesh = ctx.model->AddMeshObject();
+      if (!mesh) return false;
+
+      ++ctx.meshcount;
+      const auto modelname =
+        ctx.modelcount == 1 ? "OpenSCAD Model" : "OpenSCAD Model " + std::to_string(ctx.meshcount);
+      mesh->SetName(modelname);
+      if (ctx.basematerialgroup) {
+        mesh->SetObjectLevelProperty(ctx.basematerialgroup->GetUniqueResourceID(), 1);
+      } else if (ctx.colorgroup) {
+        mesh->SetObjectLevelProperty(ctx.colorgroup->GetUniqueResourceID(), 1);
+      }
+
+      std::vector<Lib3MF::sPosition> positions;
+      positions.reserve(out_ps->vertices.size());
+      for (const auto& v : out_ps->vertices) {
+        const auto f = v.cast<float>();
+        positions.push_back({f[0], f[1], f[2]});
+      }
+      try {
+        mesh->SetGeometry(positions, exported.triangles);
+        if (!exported.properties.empty()) {
+          mesh->SetAllTriangleProperties(exported.properties);
+        }
+      } catch (Lib3MF::ELib3MFException& e) {
+        export_3mf_error(e.what());
+        export_3mf_error("Can't add mesh to 3MF model.");
         return false;
       }
+      // The model now holds the geometry, don't keep another copy of it.
+      ctx.meshes.emplace(hash, ExportedMesh{mesh, exported.offset, !exported.properties.empty()});
     }
 
     try {
-      auto builditem = ctx.model->AddBuildItem(mesh.get(), ctx.wrapper->GetIdentityTransform());
+      auto builditem = ctx.model->AddBuildItem(mesh.get(), transform);
       if (!partname.empty()) {
         builditem->SetPartNumber(partname);
       }
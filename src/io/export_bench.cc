@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "core/AST.h"
+#include "geometry/bench_meshes.h"
+#include "geometry/PolySet.h"
+#include "io/export.h"
+#include "io/import.h"
+
+namespace fs = std::filesystem;
+
+static std::string bench_file(const std::string& suffix)
+{
+  return (fs::temp_directory_path() / ("openscad-bench." + suffix)).string();
+}
+
+static bool export_bench_file(const std::shared_ptr<const Geometry>& geom, FileFormat format,
+                              const std::string& filename)
+{
+  const auto info = createExportInfo(format, fileformat::info(format), filename, nullptr, {});
+  return exportFileByName(geom, filename, info);
+}
+
+static void BM_Export_STL(benchmark::State& state)
+{
+  const std::shared_ptr<const Geometry> torus = bench_torus(state.range(0));
+  const bool binary = state.range(1);
+  for (auto _ : state) {
+    std::ostringstream output;
+    export_stl(torus, output, binary);
+    benchmark::DoNotOptimize(output.tellp());
+  }
+}
+BENCHMARK(BM_Export_STL)->Args({256, 0})->Args({256, 1});
+
+static void BM_Import_STL(benchmark::State& state)
+{
+  const auto filename = bench_file("stl");
+  if (!export_bench_file(bench_torus(state.range(0)), FileFormat::BINARY_STL, filename)) {
+    state.SkipWithError("cannot write benchmark file");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(import_stl(filename, Location::NONE));
+  }
+  fs::remove(filename);
+}
+BENCHMARK(BM_Import_STL)->Arg(256);
+
+#ifdef ENABLE_LIB3MF
+static void BM_Export_3MF(benchmark::State& state)
+{
+  const std::shared_ptr<const Geometry> torus = bench_torus(state.range(0));
+  const auto filename = bench_file("3mf");
+  for (auto _ : state) {
+    if (!export_bench_file(torus, FileFormat::_3MF, filename)) {
+      state.SkipWithError("cannot write benchmark file");
+      break;
+    }
+  }
+  fs::remove(filename);
+}
+BENCHMARK(BM_Export_3MF)->Arg(256);
+
+static void BM_Import_3MF(benchmark::State& state)
+{
+  const auto filename = bench_file("3mf");
+  if (!export_bench_file(bench_torus(state.range(0)), FileFormat::_3MF, filename)) {
+    state.SkipWithError("cannot write benchmark file");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(import_3mf(filename, Location::NONE));
+  }
+  fs::remove(filename);
+}
+BENCHMARK(BM_Import_3MF)->Arg(256);
+#endif  // ENABLE_LIB3MF
@@ -0,0 +1,150 @@
+#include "io/export.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <boost/logic/tribool.hpp>
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "io/ogeom_format.h"
+
+namespace {
+
+template <typename T>
+void write_array(std::ostream& output, const T *values, size_t count)
+{
+#if BOOST_ENDIAN_BIG_BYTE
+  std::vector<T> copy(values, values + count);
+  ogeom_byte_order(copy.data(), count);
+  values = copy.data();
+#endif
+  output.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+  static constexpr char zeros[8] = {};
+  output.write(zeros, ogeom_padding(count * sizeof(T)));
+}
+
+void write_header(std::ostream& output, OGeomHeader header)
+{
+  std::memcpy(header.magic, OGEOM_MAGIC, sizeof(header.magic));
+  header.version = OGEOM_VERSION;
+  ogeom_byte_order(&header.version, 4);
+  ogeom_byte_order(&header.num_vertices, 4);
+  output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void export_ogeom(const PolySet& ps, std::ostream& output)
+{
+  static_assert(sizeof(Vector3d) == 3 * sizeof(double), "Vector3d must be packed");
+
+  OGeomHeader header{};
+  header.dimension = 3;
+  if (ps.isManifold()) header.flags |= OGEOM_MANIFOLD;
+  if (ps.isTriangular()) header.flags |= OGEOM_TRIANGULAR;
+  if (ps.isWelded()) header.flags |= OGEOM_WELDED;
+  if (!boost::indeterminate(ps.convexValue())) {
+    header.flags |= OGEOM_CONVEXITY_KNOWN;
+    if (ps.convexValue()) header.flags |= OGEOM_CONVEX;
+  }
+  if (!ps.color_indices.empty()) header.flags |= OGEOM_COLOR_INDICES;
+  header.num_vertices = ps.vertices.size();
+  header.num_faces = ps.indices.size();
+  header.num_colors = ps.colors.size();
+
+  std::vector<uint64_t> face_offsets;
+  face_offsets.reserve(ps.indices.size() + 1);
+  face_offsets.push_back(0);
+  for (const auto& face : ps.indices) face_offsets.push_back(face_offsets.back() + face.size());
+  header.num_indices = face_offsets.back();
+
+  std::vector<uint32_t> indices;
+  indices.reserve(header.num_indices);
+  for (const auto& face : ps.indices) indices.insert(indices.end(), face.begin(), face.end());
+
+  std::vector<float> colors;
+  colors.reserve(4 * ps.colors.size());
+  for (const auto& color : ps.colors) {
+    const auto rgba = color.toVector4f();
+    colors.insert(colors.end(), rgba.data(), rgba.data() + 4);
+  }
+
+  write_header(output, header);
+  write_array(output, ps.vertices.empty() ? nullptr : ps.vertices[0].data(), 3 * ps.vertices.size());
+  write_array(output, face_offsets.data(), face_offsets.size());
+  write_array(output, indices.data(), indices.size());
+  write_array(output, colors.data(), colors.size());
+  if (!ps.color_indices.empty()) {
+    write_array(output, ps.color_indices.data(), ps.color_indices.size());
+  }
+}
+
+void collect_outlines(const std::shared_ptr<const Geometry>& geom,
+                      std::vector<const Outline2d *>& outlines, bool& sanitized)
+{
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    for (const auto& item : geomlist->getChildren()) collect_outlines(item.second, outlines, sanitized);
+    // Outlines of several polygons may overlap.
+    sanitized = false;
+  } else if (const auto poly = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+    for (const auto& outline : poly->outlines()) outlines.push_back(&outline);
+    sanitized = poly->isSanitized();
+  } else {
+    assert(false && "Export as OGEOM for this geometry type is not supported");
+  }
+}
+
+void export_ogeom_2d(const std::shared_ptr<const Geometry>& geom, std::ostream& output)
+{
+  std::vector<const Outline2d *> outlines;
+  bool sanitized = false;
+  collect_outlines(geom, outlines, sanitized);
+
+  OGeomHeader header{};
+  header.dimension = 2;
+  if (sanitized) header.flags |= OGEOM_SANITIZED;
+  header.num_faces = outlines.size();
+
+  std::vector<uint64_t> outline_offsets;
+  outline_offsets.reserve(outlines.size() + 1);
+  outline_offsets.push_back(0);
+  std::vector<uint8_t> positive;
+  positive.reserve(outlines.size());
+  for (const auto *outline : outlines) {
+    outline_offsets.push_back(outline_offsets.back() + outline->vertices.size());
+    positive.push_back(outline->positive ? 1 : 0);
+  }
+  header.num_vertices = outline_offsets.back();
+
+  std::vector<double> vertices;
+  vertices.reserve(2 * header.num_vertices);
+  for (const auto *outline : outlines) {
+    for (const auto& v : outline->vertices) {
+      vertices.push_back(v[0]);
+      vertices.push_back(v[1]);
+    }
+  }
+
+  write_header(output, header);
+  write_array(output, vertices.data(), vertices.size());
+  write_array(output, outline_offsets.data(), outline_offsets.size());
+  write_array(output, positive.data(), positive.size());
+}
+
+}  // namespace
+
+void export_ogeom(const std::shared_ptr<const Geometry>& geom, std::ostream& output)
+{
+  if (geom->getDimension() == 2) {
+    export_ogeom_2d(geom, output);
+  } else {
+    export_ogeom(*PolySetUtils::getGeometryAsPolySet(geom), output);
+  }
+}
@@ -3,17 +3,46 @@
 #include <ostream>
 #include <cstdio>
 #include <memory>
+#include <vector>
 
 #include "core/Tree.h"
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
 #include "glview/Camera.h"
+#include "glview/ColorMap.h"
 #include "glview/CsgInfo.h"
+#include "glview/OffscreenContextFactory.h"
 #include "glview/OffscreenView.h"
 #include "glview/Renderer.h"
 #include "glview/RenderSettings.h"
+#include "glview/SoftwareRenderer.h"
 #include "utils/printutils.h"
 
+namespace {
+
+void setupCamera(Camera& cam, const BoundingBox& bbox)
+{
+  if (cam.viewall) cam.viewAll(bbox);
+}
+
+bool export_png_software(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
+                         std::vector<Camera>& cameras, const std::vector<std::ostream *>& outputs)
+{
+  PRINTD("export_png_software");
+  SoftwareRenderer renderer(root_geom);
+  const auto colorscheme = ColorMap::inst()->findColorScheme(RenderSettings::inst()->colorscheme);
+  if (colorscheme) renderer.setColorScheme(*colorscheme);
+  renderer.setShowAxes(options["axes"]);
+  renderer.setShowEdges(options["edges"]);
+  for (size_t i = 0; i < cameras.size(); ++i) {
+    setupCamera(cameras[i], renderer.getBoundingBox());
+    if (!renderer.save(cameras[i], *outputs[i])) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 #ifndef NULLGL
 #include "glview/cgal/CGALRenderer.h"
 #include "glview/PolySetRenderer.h"
@@ -25,26 +54,30 @@
 
 #include "glview/preview/ThrownTogetherRenderer.h"
 
-namespace {
-
-void setupCamera(Camera& cam, const BoundingBox& bbox)
-{
-  if (cam.viewall) cam.viewAll(bbox);
-}
-
-}  // namespace
-
 bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
-                Camera& camera, std::ostream& output)
+                std::vector<Camera>& cameras, const std::vector<std::ostream *>& outputs)
 {
   assert(root_geom != nullptr);
+  assert(!cameras.empty() && cameras.size() == outputs.size());
   PRINTD("export_png geom");
+  if (OffscreenContextFactory::provider() == OffscreenContextFactory::SOFTWARE_PROVIDER) {
+    return export_png_software(root_geom, options, cameras, outputs);
+  }
   std::unique_ptr<OffscreenView> glview;
   try {
-    glview = std::make_unique<OffscreenView>(camera.pixel_width, camera.pixel_height);
+    glview = std::make_unique<OffscreenView>(cameras[0].pixel_width, cameras[0].pixel_height);
   } catch (const OffscreenViewException& ex) {
-    fprintf(stderr, "Can't create OffscreenView: %s.\n", ex.what());
-    return false;
+    // Only fall back to software rendering if no provider was asked for explicitly
+    if (!RenderSettings::inst()->offscreenProvider.empty()) {
+      LOG(message_group::Error, "Can't create OffscreenView with the %1$s provider: %2$s",
+          OffscreenContextFactory::provider(), ex.what());
+      return false;
+    }
+    LOG(message_group::Warning,
+        "Can't create OffscreenView: %1$s, rendering in software. Use --offscreen-provider=%2$s to "
+        "do so without trying OpenGL first.",
+        ex.what(), OffscreenContextFactory::SOFTWARE_PROVIDER);
+    return export_png_software(root_geom, options, cameras, outputs);
   }
   std::shared_ptr<Renderer> geomRenderer;
   // Choose PolySetRenderer for PolySet and Polygon2d, and for Manifold since we
@@ -57,20 +90,32 @@ bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOpti
     geomRenderer = std::make_shared<CGALRenderer>(root_geom);
   }
   const BoundingBox bbox = geomRenderer->getBoundingBox();
-  setupCamera(camera, bbox);
 
-  glview->setCamera(camera);
   glview->setRenderer(geomRenderer);
   glview->setColorScheme(RenderSettings::inst()->colorscheme);
   glview->setShowCrosshairs(options["crosshairs"]);
   glview->setShowAxes(options["axes"]);
   glview->setShowScaleProportional(options["scales"]);
   glview->setShowEdges(options["edges"]);
-  glview->paintGL();
-  glview->save(output);
+  // The renderer keeps its vertex buffers, so further views only draw them again
+  for (size_t i = 0; i < cameras.size(); ++i) {
+    setupCamera(cameras[i], bbox);
+    glview->setCamera(cameras[i]);
+    glview->paintGL();
+    glview->save(*outputs[i]);
+  }
   return true;
 }
 
+bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
+                Camera& camera, std::ostream& output)
+{
+  std::vector<Camera> cameras{camera};
+  const bool success = export_png(root_geom, options, cameras, {&output});
+  camera = cameras[0];
+  return success;
+}
+
 std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& options, Camera& camera)
 {
   PRINTD("prepare_preview_common");
@@ -126,17 +171,36 @@ bool export_png(const OffscreenView& glview, std::ostream& output)
   return true;
 }
 
+bool export_png(OffscreenView& glview, Camera& camera, std::ostream& output)
+{
+  PRINTD("export_png_preview_view");
+  setupCamera(camera, glview.getRenderer()->getBoundingBox());
+  glview.setCamera(camera);
+  glview.paintGL();
+  glview.save(output);
+  return true;
+}
+
 #else  // NULLGL
 
+bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
+                std::vector<Camera>& cameras, const std::vector<std::ostream *>& outputs)
+{
+  return export_png_software(root_geom, options, cameras, outputs);
+}
 bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
                 Camera& camera, std::ostream& output)
 {
-  return false;
+  std::vector<Camera> cameras{camera};
+  const bool success = export_png_software(root_geom, options, cameras, {&output});
+  camera = cameras[0];
+  return success;
 }
 std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& options, Camera& camera)
 {
   return nullptr;
 }
 bool export_png(const OffscreenView& glview, std::ostream& output) { return false; }
+bool export_png(OffscreenView& glview, Camera& camera, std::ostream& output) { return false; }
 
 #endif  // NULLGL
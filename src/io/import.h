@@ -13,11 +13,15 @@ std::unique_ptr<class PolySet> import_obj(const std::string& filename, const Loc
 std::unique_ptr<class PolySet> import_off(const std::string& filename, const Location& loc);
 std::unique_ptr<class PolySet> import_amf(const std::string&, const Location& loc);
 std::unique_ptr<class PolySet> import_3mf(const std::string&, const Location& loc);
+// Returns a PolySet or a Polygon2d, as stored in the file.
+std::unique_ptr<class Geometry> import_ogeom(const std::string& filename, const Location& loc);
 
 std::unique_ptr<class Polygon2d> import_svg(CurveDiscretizer discretizer, const std::string& filename,
                                             const boost::optional<std::string>& id,
                                             const boost::optional<std::string>& layer, const double dpi,
                                             const bool center, const Location& loc);
+// Drops the shapes import_svg() keeps for importing the same files again.
+void clear_svg_cache();
 
 #ifdef ENABLE_CGAL
 std::unique_ptr<class CGALNefGeometry> import_nef3(const std::string& filename, const Location& loc);
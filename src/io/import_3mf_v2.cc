@@ -26,7 +26,9 @@
 #include "io/import.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -42,6 +44,7 @@
 #include "geometry/PolySetBuilder.h"
 #include "geometry/PolySetUtils.h"
 #include "glview/RenderSettings.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 #include "utils/version_helper.h"
 #include "io/lib3mf_utils.h"
@@ -186,10 +189,9 @@ Color4f get_triangle_color_from_basematerial(const Lib3MF::PModel& model,
   return col;
 }
 
-Color4f get_triangle_color(const Lib3MF::PModel& model, const Lib3MF::PMeshObject& object, int idx)
+Color4f resolve_triangle_color(const Lib3MF::PModel& model,
+                               const Lib3MF::sTriangleProperties& triangle_properties)
 {
-  Lib3MF::sTriangleProperties triangle_properties;
-  object->GetTriangleProperties(idx, triangle_properties);
   if (triangle_properties.m_ResourceID == 0) {
     return {};
   }
@@ -203,9 +205,20 @@ Color4f get_triangle_color(const Lib3MF::PModel& model, const Lib3MF::PMeshObjec
   }
 }
 
-std::string import_3mf_mesh(const std::string& filename, unsigned int mesh_idx,
-                            const Lib3MF::PModel& model, const std::unique_ptr<MeshObject>& mo,
-                            std::unique_ptr<PolySet>& ps)
+// A mesh object copied out of lib3mf in bulk, with its colors resolved, so it can be converted to a
+// PolySet without calling into lib3mf.
+struct MeshData {
+  Matrix4d transform;
+  std::vector<Lib3MF::sPosition> vertices;
+  std::vector<Lib3MF::sTriangle> triangles;
+  // Per triangle, indices into colors or -1. Empty if no triangle has a color.
+  std::vector<int32_t> color_indices;
+  std::vector<Color4f> colors;
+};
+
+std::string read_3mf_mesh(const std::string& filename, unsigned int mesh_idx,
+                          const Lib3MF::PModel& model, const std::unique_ptr<MeshObject>& mo,
+                          MeshData& data)
 {
   const auto object = mo->obj;
   const auto vertex_count = object->GetVertexCount();
@@ -219,50 +232,65 @@ std::string import_3mf_mesh(const std::string& filename, unsigned int mesh_idx,
   PRINTDB("%s: mesh %d, type: %s, vertex count: %lu, triangle count: %lu",
           filename.c_str() % mesh_idx % object_type % vertex_count % triangle_count);
 
-  ps->vertices.reserve(vertex_count);
-  ps->indices.reserve(triangle_count);
-  ps->color_indices.reserve(triangle_count);
-
-  std::vector<Lib3MF::sPosition> all_vertices;
-  object->GetVertices(all_vertices);
-  for (const auto& vertex : all_vertices) {
-    const Vector4d v = mo->transform * Vector4d(vertex.m_Coordinates[0], vertex.m_Coordinates[1],
-                                                vertex.m_Coordinates[2], 1);
-    ps->vertices.push_back(v.head(3));
-  }
+  data.transform = mo->transform;
+  object->GetVertices(data.vertices);
+  object->GetTriangleIndices(data.triangles);
 
+  std::vector<Lib3MF::sTriangleProperties> properties;
+  object->GetAllTriangleProperties(properties);
+  // Most triangles share a handful of properties, resolve each of them once.
+  std::map<std::array<Lib3MF_uint32, 4>, int32_t> property_colors;
   std::unordered_map<Color4f, int32_t> color_indices;
-  for (Lib3MF_uint32 idx = 0; idx < triangle_count; ++idx) {
-    const auto triangle = object->GetTriangle(idx);
-    ps->indices.emplace_back();
-    for (const auto& idx : triangle.m_Indices) {
-      ps->indices.back().push_back(idx);
-    }
-
-    const Color4f col = get_triangle_color(model, object, idx);
-    if (col.isValid()) {
-      const auto it = color_indices.find(col);
-      int32_t cidx;
-      if (it == color_indices.end()) {
-        cidx = ps->colors.size();
-        ps->colors.push_back(col);
-        color_indices[col] = cidx;
-      } else {
-        cidx = it->second;
+  data.color_indices.reserve(properties.size());
+  for (const auto& triangle_properties : properties) {
+    const std::array<Lib3MF_uint32, 4> key{
+      triangle_properties.m_ResourceID, triangle_properties.m_PropertyIDs[0],
+      triangle_properties.m_PropertyIDs[1], triangle_properties.m_PropertyIDs[2]};
+    auto it = property_colors.find(key);
+    if (it == property_colors.end()) {
+      int32_t cidx = -1;
+      const Color4f col = resolve_triangle_color(model, triangle_properties);
+      if (col.isValid()) {
+        const auto color_it = color_indices.find(col);
+        if (color_it == color_indices.end()) {
+          cidx = data.colors.size();
+          data.colors.push_back(col);
+          color_indices[col] = cidx;
+        } else {
+          cidx = color_it->second;
+        }
       }
-      ps->color_indices.push_back(cidx);
-    } else {
-      ps->color_indices.push_back(-1);
+      it = property_colors.emplace(key, cidx).first;
     }
+    data.color_indices.push_back(it->second);
   }
-  if (ps->colors.empty()) {
-    ps->color_indices.clear();
+  if (data.colors.empty()) {
+    data.color_indices.clear();
   }
-  ps->setTriangular(true);
 
   return "";
 }
 
+std::unique_ptr<PolySet> create_polyset(const MeshData& data)
+{
+  auto ps = PolySet::createEmpty();
+  ps->vertices.reserve(data.vertices.size());
+  for (const auto& vertex : data.vertices) {
+    const Vector4d v = data.transform * Vector4d(vertex.m_Coordinates[0], vertex.m_Coordinates[1],
+                                                 vertex.m_Coordinates[2], 1);
+    ps->vertices.push_back(v.head(3));
+  }
+  ps->indices.reserve(data.triangles.size());
+  for (const auto& triangle : data.triangles) {
+    ps->indices.push_back({static_cast<int>(triangle.m_Indices[0]), static_cast<int>(triangle.m_Indices[1]),
+                           static_cast<int>(triangle.m_Indices[2])});
+  }
+  ps->color_indices = data.color_indices;
+  ps->colors = data.colors;
+  ps->setTriangular(true);
+  return ps;
+}
+
 std::string read_metadata(const Lib3MF::PModel& model)
 {
   const auto metadatagroup = model->GetMetaDataGroup();
@@ -395,7 +423,8 @@ std::unique_ptr<PolySet> import_3mf(const std::string& filename, const Location&
       return PolySet::createEmpty();
     }
 
-    std::list<std::unique_ptr<PolySet>> meshes;
+    // lib3mf is only called from this thread; the meshes are converted in parallel afterwards.
+    std::vector<MeshData> mesh_data;
     while (builditem_it->MoveNext()) {
       const auto builditem = builditem_it->GetCurrent();
       const auto builditemhandle = builditem->GetObjectResourceID();
@@ -424,21 +453,24 @@ std::unique_ptr<PolySet> import_3mf(const std::string& filename, const Location&
       }
 
       for (const auto& mo : object_list) {
-        auto ps = PolySet::createEmpty();
-        std::string errmsg = import_3mf_mesh(filename, meshes.size(), model, mo, ps);
-        if (errmsg.empty()) {
-          if (ps->isEmpty()) {
-            continue;
-          }
-        } else {
+        MeshData data;
+        std::string errmsg = read_3mf_mesh(filename, mesh_data.size(), model, mo, data);
+        if (!errmsg.empty()) {
           LOG(message_group::Warning, "%1$s, import() at line %2$d", errmsg, loc.firstLine());
           return PolySet::createEmpty();
         }
-
-        meshes.push_back(std::move(ps));
+        mesh_data.push_back(std::move(data));
       }
     }
 
+    std::vector<std::unique_ptr<PolySet>> polysets(mesh_data.size());
+    parallelizable_transform(mesh_data.begin(), mesh_data.end(), polysets.begin(),
+                             [](const MeshData& data) { return create_polyset(data); });
+    std::list<std::unique_ptr<PolySet>> meshes;
+    for (auto& ps : polysets) {
+      if (!ps->isEmpty()) meshes.push_back(std::move(ps));
+    }
+
     if (meshes.empty()) {
       return PolySet::createEmpty();
     } else if (meshes.size() == 1) {
@@ -25,8 +25,8 @@
  */
 
 #include "geometry/PolySet.h"
-#include "geometry/Geometry.h"
 #include "geometry/PolySetBuilder.h"
+#include "geometry/Geometry.h"
 #include "geometry/PolySetUtils.h"
 #include "utils/printutils.h"
 #include "core/AST.h"
@@ -38,57 +38,111 @@
 #include "geometry/cgal/cgalutils.h"
 #endif
 
+#include <algorithm>
+#include <iterator>
 #include <utility>
 #include <memory>
 #include <sys/types.h>
+#include <cctype>
+#include <charconv>
 #include <cstddef>
-#include <map>
+#include <cstring>
 #include <cassert>
 #include <string>
+#include <system_error>
+#include <type_traits>
 #include <vector>
+#include <boost/lexical_cast.hpp>
 #include <libxml/xmlreader.h>
 #include <filesystem>
-#include <boost/lexical_cast.hpp>
 
-static const std::string text_node("#text");
-static const std::string object("/amf/object");
-static const std::string coordinates("/amf/object/mesh/vertices/vertex/coordinates");
-static const std::string coordinates_x = coordinates + "/x";
-static const std::string coordinates_y = coordinates + "/y";
-static const std::string coordinates_z = coordinates + "/z";
-static const std::string triangle("/amf/object/mesh/volume/triangle");
-static const std::string triangle_v1 = triangle + "/v1";
-static const std::string triangle_v2 = triangle + "/v2";
-static const std::string triangle_v3 = triangle + "/v3";
+namespace {
+
+// The elements of interest, identified by their name and that of their parent.
+enum class Element {
+  OTHER,
+  AMF,
+  OBJECT,
+  MESH,
+  VERTICES,
+  VERTEX,
+  COORDINATES,
+  X,
+  Y,
+  Z,
+  VOLUME,
+  TRIANGLE,
+  V1,
+  V2,
+  V3,
+};
+
+struct ChildElement {
+  Element parent;
+  const char *name;
+  Element element;
+};
+
+const ChildElement child_elements[] = {
+  {Element::OTHER, "amf", Element::AMF},
+  {Element::AMF, "object", Element::OBJECT},
+  {Element::OBJECT, "mesh", Element::MESH},
+  {Element::MESH, "vertices", Element::VERTICES},
+  {Element::VERTICES, "vertex", Element::VERTEX},
+  {Element::VERTEX, "coordinates", Element::COORDINATES},
+  {Element::COORDINATES, "x", Element::X},
+  {Element::COORDINATES, "y", Element::Y},
+  {Element::COORDINATES, "z", Element::Z},
+  {Element::MESH, "volume", Element::VOLUME},
+  {Element::VOLUME, "triangle", Element::TRIANGLE},
+  {Element::TRIANGLE, "v1", Element::V1},
+  {Element::TRIANGLE, "v2", Element::V2},
+  {Element::TRIANGLE, "v3", Element::V3},
+};
+
+// Parse the whole of text, ignoring surrounding white space, without allocating.
+template <typename T>
+bool parse_number(const xmlChar *value, T& result)
+{
+  const char *begin = reinterpret_cast<const char *>(value);
+  const char *end = begin + std::strlen(begin);
+  while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) ++begin;
+  while (end > begin && std::isspace(static_cast<unsigned char>(end[-1]))) --end;
+  if (begin < end && *begin == '+') ++begin;
+  if (begin == end) return false;
+#ifndef __cpp_lib_to_chars
+  // fall back for standard libraries without floating point from_chars
+  if constexpr (std::is_floating_point_v<T>) {
+    return boost::conversion::try_lexical_convert(begin, static_cast<size_t>(end - begin), result);
+  } else
+#endif
+  {
+    const auto [ptr, ec] = std::from_chars(begin, end, result);
+    return ec == std::errc{} && ptr == end;
+  }
+}
+
+}  // namespace
 
 class AmfImporter
 {
 private:
-  std::string xpath;  // element nesting stack
+  // element nesting stack; the root has no parent, reported as Element::OTHER
+  std::vector<Element> elements;
 
-  using cb_func = void (*)(AmfImporter *, const xmlChar *);
-
-  std::unique_ptr<PolySetBuilder> builder;
   std::vector<std::unique_ptr<PolySet>> polySets;
+  // The object being read. Vertices shared by its triangles are welded, unused ones are dropped.
+  std::unique_ptr<PolySetBuilder> builder;
+  std::vector<Vector3d> vertex_list;
 
   double x{0}, y{0}, z{0};
   int idx_v1{0}, idx_v2{0}, idx_v3{0};
-  std::vector<Eigen::Vector3d> vertex_list;
-
-  std::map<const std::string, cb_func> funcs;
-  std::map<const std::string, cb_func> start_funcs;
-  std::map<const std::string, cb_func> end_funcs;
-
-  static void set_x(AmfImporter *importer, const xmlChar *value);
-  static void set_y(AmfImporter *importer, const xmlChar *value);
-  static void set_z(AmfImporter *importer, const xmlChar *value);
-  static void set_v1(AmfImporter *importer, const xmlChar *value);
-  static void set_v2(AmfImporter *importer, const xmlChar *value);
-  static void set_v3(AmfImporter *importer, const xmlChar *value);
-  static void start_object(AmfImporter *importer, const xmlChar *value);
-  static void end_object(AmfImporter *importer, const xmlChar *value);
-  static void end_triangle(AmfImporter *importer, const xmlChar *vlue);
-  static void end_vertex(AmfImporter *importer, const xmlChar *value);
+  size_t invalid_triangles{0};
+  bool failed{false};
+
+  void startElement(const xmlChar *name);
+  void endElement();
+  void text(const xmlChar *value);
 
   int streamFile(const char *filename);
   void processNode(xmlTextReaderPtr reader);
@@ -106,105 +160,88 @@ public:
 
 AmfImporter::AmfImporter(const Location& loc) : loc(loc) {}
 
-void AmfImporter::set_x(AmfImporter *importer, const xmlChar *value)
-{
-  importer->x = boost::lexical_cast<double>(std::string((const char *)value));
-}
-
-void AmfImporter::set_y(AmfImporter *importer, const xmlChar *value)
-{
-  importer->y = boost::lexical_cast<double>(std::string((const char *)value));
-}
-
-void AmfImporter::set_z(AmfImporter *importer, const xmlChar *value)
-{
-  importer->z = boost::lexical_cast<double>(std::string((const char *)value));
-}
-
-void AmfImporter::set_v1(AmfImporter *importer, const xmlChar *value)
-{
-  importer->idx_v1 = boost::lexical_cast<int>(std::string((const char *)value));
-}
-
-void AmfImporter::set_v2(AmfImporter *importer, const xmlChar *value)
-{
-  importer->idx_v2 = boost::lexical_cast<int>(std::string((const char *)value));
-}
-
-void AmfImporter::set_v3(AmfImporter *importer, const xmlChar *value)
-{
-  importer->idx_v3 = boost::lexical_cast<int>(std::string((const char *)value));
-}
-
-void AmfImporter::start_object(AmfImporter *importer, const xmlChar *)
+void AmfImporter::startElement(const xmlChar *name)
 {
-  importer->builder = std::make_unique<PolySetBuilder>(0, 0);
-}
-
-void AmfImporter::end_object(AmfImporter *importer, const xmlChar *)
-{
-  PRINTDB("AMF: add object %d", importer->polySets.size());
-  importer->polySets.push_back(importer->builder->build());
-  importer->vertex_list.clear();
-  importer->builder.reset(nullptr);
+  const Element parent = elements.empty() ? Element::OTHER : elements.back();
+  Element element = Element::OTHER;
+  // Children of elements which aren't of interest aren't either, except for the root
+  if (parent != Element::OTHER || elements.empty()) {
+    for (const auto& child : child_elements) {
+      if (child.parent == parent && xmlStrEqual(name, BAD_CAST child.name)) {
+        element = child.element;
+        break;
+      }
+    }
+  }
+  elements.push_back(element);
+  if (element == Element::OBJECT) {
+    PRINTDB("AMF: start object %d", polySets.size());
+    builder = std::make_unique<PolySetBuilder>();
+    vertex_list.clear();
+  }
 }
 
-void AmfImporter::end_vertex(AmfImporter *importer, const xmlChar *)
+void AmfImporter::endElement()
 {
-  PRINTDB("AMF: add vertex %d - (%.2f, %.2f, %.2f)",
-          importer->vertex_list.size() % importer->x % importer->y % importer->z);
-  importer->vertex_list.emplace_back(importer->x, importer->y, importer->z);
+  if (elements.empty()) return;
+  const Element element = elements.back();
+  elements.pop_back();
+  switch (element) {
+  case Element::OBJECT:
+    PRINTDB("AMF: add object %d", polySets.size());
+    polySets.push_back(builder->build());
+    builder.reset();
+    vertex_list.clear();
+    break;
+  case Element::COORDINATES:
+    PRINTDB("AMF: add vertex %d - (%.2f, %.2f, %.2f)", vertex_list.size() % x % y % z);
+    vertex_list.emplace_back(x, y, z);
+    break;
+  case Element::TRIANGLE: {
+    PRINTDB("AMF: add triangle %d - (%d, %d, %d)", builder->numPolygons() % idx_v1 % idx_v2 % idx_v3);
+    const int num_vertices = static_cast<int>(vertex_list.size());
+    const int idx[3] = {idx_v1, idx_v2, idx_v3};
+    const auto invalid = [num_vertices](int i) { return i < 0 || i >= num_vertices; };
+    if (std::any_of(std::begin(idx), std::end(idx), invalid)) {
+      // Skip the triangle rather than the whole file, it's reported once the file is read
+      ++invalid_triangles;
+      break;
+    }
+    builder->beginPolygon(3);
+    for (int i : idx) builder->addVertex(vertex_list[i]);
+    builder->endPolygon();
+  } break;
+  default: break;
+  }
 }
 
-void AmfImporter::end_triangle(AmfImporter *importer, const xmlChar *)
+void AmfImporter::text(const xmlChar *value)
 {
-  int idx[3] = {importer->idx_v1, importer->idx_v2, importer->idx_v3};
-  PRINTDB("AMF: add triangle %d - (%.2f, %.2f, %.2f)",
-          importer->vertex_list.size() % idx[0] % idx[1] % idx[2]);
-
-  std::vector<Eigen::Vector3d>& v = importer->vertex_list;
-
-  importer->builder->beginPolygon(3);
-  for (auto i : idx)  // TODO set vertex array first
-    importer->builder->addVertex(Vector3d(v[i].x(), v[i].y(), v[i].z()));
+  if (elements.empty()) return;
+  bool ok = true;
+  switch (elements.back()) {
+  case Element::X:  ok = parse_number(value, x); break;
+  case Element::Y:  ok = parse_number(value, y); break;
+  case Element::Z:  ok = parse_number(value, z); break;
+  case Element::V1: ok = parse_number(value, idx_v1); break;
+  case Element::V2: ok = parse_number(value, idx_v2); break;
+  case Element::V3: ok = parse_number(value, idx_v3); break;
+  default:          break;
+  }
+  if (!ok) failed = true;
 }
 
 void AmfImporter::processNode(xmlTextReaderPtr reader)
 {
-  const char *name = reinterpret_cast<const char *>(xmlTextReaderName(reader));
-  if (name == nullptr) name = reinterpret_cast<const char *>(xmlStrdup(BAD_CAST "--"));
-  xmlChar *value = xmlTextReaderValue(reader);
-  int node_type = xmlTextReaderNodeType(reader);
-  switch (node_type) {
-  case XML_READER_TYPE_ELEMENT: {
-    xpath += '/';
-    xpath += name;
-    cb_func startFunc = start_funcs[xpath];
-    if (startFunc) {
-      PRINTDB("AMF: start %s", xpath);
-      startFunc(this, nullptr);
-    }
-  } break;
-  case XML_READER_TYPE_END_ELEMENT: {
-    cb_func endFunc = end_funcs[xpath];
-    if (endFunc) {
-      PRINTDB("AMF: end   %s", xpath);
-      endFunc(this, value);
-    }
-    size_t pos = xpath.find_last_of('/');
-    if (pos != std::string::npos) xpath.erase(pos);
-  } break;
-  case XML_READER_TYPE_TEXT: {
-    cb_func textFunc = funcs[xpath];
-    if (textFunc) {
-      PRINTDB("AMF: text  %s - '%s'", xpath % value);
-      textFunc(this, value);
-    }
-  } break;
+  switch (xmlTextReaderNodeType(reader)) {
+  case XML_READER_TYPE_ELEMENT:
+    startElement(xmlTextReaderConstLocalName(reader));
+    // <x/> has no end element
+    if (xmlTextReaderIsEmptyElement(reader)) endElement();
+    break;
+  case XML_READER_TYPE_END_ELEMENT: endElement(); break;
+  case XML_READER_TYPE_TEXT:        text(xmlTextReaderConstValue(reader)); break;
   }
-
-  xmlFree(value);
-  xmlFree((void *)(name));
 }
 
 xmlTextReaderPtr AmfImporter::createXmlReader(const char *filename)
@@ -224,17 +261,14 @@ int AmfImporter::streamFile(const char *filename)
     return 1;
   }
 
-  try {
-    xmlTextReaderSetParserProp(reader, XML_PARSER_SUBST_ENTITIES, 1);
+  xmlTextReaderSetParserProp(reader, XML_PARSER_SUBST_ENTITIES, 1);
+  ret = xmlTextReaderRead(reader);
+  while (ret == 1 && !failed) {
+    processNode(reader);
     ret = xmlTextReaderRead(reader);
-    while (ret == 1) {
-      processNode(reader);
-      ret = xmlTextReaderRead(reader);
-    }
-    xmlFreeTextReader(reader);
-  } catch (boost::bad_lexical_cast&) {
-    ret = -1;
   }
+  xmlFreeTextReader(reader);
+  if (failed) ret = -1;
   if (ret != 0) {
     LOG(message_group::Warning, "Failed to parse file '%1$s', import() at line %2$d", filename,
         this->loc.firstLine());
@@ -244,18 +278,13 @@ int AmfImporter::streamFile(const char *filename)
 
 std::unique_ptr<PolySet> AmfImporter::read(const std::string& filename)
 {
-  funcs[coordinates_x] = set_x;
-  funcs[coordinates_y] = set_y;
-  funcs[coordinates_z] = set_z;
-  funcs[triangle_v1] = set_v1;
-  funcs[triangle_v2] = set_v2;
-  funcs[triangle_v3] = set_v3;
-  start_funcs[object] = start_object;
-  end_funcs[coordinates] = end_vertex;
-  end_funcs[triangle] = end_triangle;
-  end_funcs[object] = end_object;
   streamFile(filename.c_str());
   vertex_list.clear();
+  if (invalid_triangles > 0) {
+    LOG(message_group::Warning,
+        "Skipped %1$d triangles with invalid vertex indices in '%2$s', import() at line %3$d",
+        invalid_triangles, filename, this->loc.firstLine());
+  }
 
   if (polySets.empty()) {
     return PolySet::createEmpty();
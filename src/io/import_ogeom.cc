@@ -0,0 +1,196 @@
+#include "io/import.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/logic/tribool.hpp>
+
+#include "core/AST.h"
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "io/ogeom_format.h"
+#include "utils/printutils.h"
+
+namespace {
+
+class OGeomReader
+{
+public:
+  OGeomReader(const std::string& filename)
+    : f(std::filesystem::u8path(filename), std::ios::in | std::ios::binary)
+  {
+    if (f.good()) {
+      f.seekg(0, std::ios::end);
+      remaining = f.tellg();
+      f.seekg(0, std::ios::beg);
+    }
+  }
+
+  [[nodiscard]] bool good() const { return f.good(); }
+
+  bool readHeader(OGeomHeader& header)
+  {
+    if (!read(reinterpret_cast<char *>(&header), sizeof(header))) return false;
+    ogeom_byte_order(&header.version, 4);
+    ogeom_byte_order(&header.num_vertices, 4);
+    return true;
+  }
+
+  // Reads count values of T into values, which must have room for them.
+  template <typename T>
+  bool readArray(T *values, uint64_t count)
+  {
+    // Checked before reading so a corrupt count doesn't make us allocate or read past the end.
+    if (count > remaining / sizeof(T)) return false;
+    const size_t bytes = count * sizeof(T);
+    if (!read(reinterpret_cast<char *>(values), bytes)) return false;
+    ogeom_byte_order(values, count);
+    char padding[8];
+    return read(padding, ogeom_padding(bytes));
+  }
+
+  // Whether count groups of the given number of values of T are left in the file.
+  template <typename T>
+  [[nodiscard]] bool has(uint64_t count, size_t components = 1) const
+  {
+    return count <= remaining / sizeof(T) / components;
+  }
+
+private:
+  bool read(char *data, size_t bytes)
+  {
+    if (bytes > remaining) return false;
+    f.read(data, bytes);
+    remaining -= bytes;
+    return f.good();
+  }
+
+  std::ifstream f;
+  uint64_t remaining = 0;
+};
+
+std::unique_ptr<PolySet> read_polyset(OGeomReader& reader, const OGeomHeader& header)
+{
+  static_assert(sizeof(Vector3d) == 3 * sizeof(double), "Vector3d must be packed");
+
+  if (!reader.has<double>(header.num_vertices, 3) || !reader.has<uint64_t>(header.num_faces) ||
+      !reader.has<uint32_t>(header.num_indices) || !reader.has<float>(header.num_colors, 4)) {
+    return nullptr;
+  }
+
+  boost::tribool convex = boost::indeterminate;
+  if (header.flags & OGEOM_CONVEXITY_KNOWN) convex = (header.flags & OGEOM_CONVEX) != 0;
+  auto ps = std::make_unique<PolySet>(3, convex);
+  ps->setManifold(header.flags & OGEOM_MANIFOLD);
+  ps->setTriangular(header.flags & OGEOM_TRIANGULAR);
+  ps->setWelded(header.flags & OGEOM_WELDED);
+
+  ps->vertices.resize(header.num_vertices);
+  auto *vertices = ps->vertices.empty() ? nullptr : ps->vertices[0].data();
+  if (!reader.readArray(vertices, 3 * header.num_vertices)) return nullptr;
+
+  std::vector<uint64_t> face_offsets(header.num_faces + 1);
+  if (!reader.readArray(face_offsets.data(), face_offsets.size())) return nullptr;
+  if (face_offsets.front() != 0 || face_offsets.back() != header.num_indices) return nullptr;
+
+  std::vector<uint32_t> indices(header.num_indices);
+  if (!reader.readArray(indices.data(), indices.size())) return nullptr;
+
+  ps->indices.resize(header.num_faces);
+  for (size_t i = 0; i < header.num_faces; ++i) {
+    const auto begin = face_offsets[i], end = face_offsets[i + 1];
+    if (begin > end || end > indices.size()) return nullptr;
+    for (auto j = begin; j < end; ++j) {
+      if (indices[j] >= header.num_vertices) return nullptr;
+    }
+    ps->indices[i].assign(indices.begin() + begin, indices.begin() + end);
+  }
+
+  std::vector<float> colors(4 * header.num_colors);
+  if (!reader.readArray(colors.data(), colors.size())) return nullptr;
+  ps->colors.reserve(header.num_colors);
+  for (size_t i = 0; i < header.num_colors; ++i) {
+    ps->colors.emplace_back(colors[4 * i], colors[4 * i + 1], colors[4 * i + 2], colors[4 * i + 3]);
+  }
+
+  if (header.flags & OGEOM_COLOR_INDICES) {
+    ps->color_indices.resize(header.num_faces);
+    if (!reader.readArray(ps->color_indices.data(), ps->color_indices.size())) return nullptr;
+    for (const auto index : ps->color_indices) {
+      if (index < -1 || index >= static_cast<int64_t>(header.num_colors)) return nullptr;
+    }
+  }
+
+  return ps;
+}
+
+std::unique_ptr<Polygon2d> read_polygon(OGeomReader& reader, const OGeomHeader& header)
+{
+  if (!reader.has<double>(header.num_vertices, 2) || !reader.has<uint64_t>(header.num_faces)) {
+    return nullptr;
+  }
+
+  std::vector<double> vertices(2 * header.num_vertices);
+  if (!reader.readArray(vertices.data(), vertices.size())) return nullptr;
+  std::vector<uint64_t> outline_offsets(header.num_faces + 1);
+  if (!reader.readArray(outline_offsets.data(), outline_offsets.size())) return nullptr;
+  std::vector<uint8_t> positive(header.num_faces);
+  if (!reader.readArray(positive.data(), positive.size())) return nullptr;
+  if (outline_offsets.front() != 0 || outline_offsets.back() != header.num_vertices) return nullptr;
+
+  auto poly = std::make_unique<Polygon2d>();
+  for (size_t i = 0; i < header.num_faces; ++i) {
+    const auto begin = outline_offsets[i], end = outline_offsets[i + 1];
+    if (begin > end || end > header.num_vertices) return nullptr;
+    Outline2d outline;
+    outline.positive = positive[i] != 0;
+    outline.vertices.reserve(end - begin);
+    for (auto j = begin; j < end; ++j) {
+      outline.vertices.emplace_back(vertices[2 * j], vertices[2 * j + 1]);
+    }
+    poly->addOutline(std::move(outline));
+  }
+  poly->setSanitized(header.flags & OGEOM_SANITIZED);
+  return poly;
+}
+
+}  // namespace
+
+std::unique_ptr<Geometry> import_ogeom(const std::string& filename, const Location& loc)
+{
+  OGeomReader reader(filename);
+  if (!reader.good()) {
+    LOG(message_group::Warning, "Can't open import file '%1$s', import() at line %2$d", filename,
+        loc.firstLine());
+    return PolySet::createEmpty();
+  }
+
+  OGeomHeader header;
+  if (!reader.readHeader(header) || std::memcmp(header.magic, OGEOM_MAGIC, sizeof(OGEOM_MAGIC)) != 0) {
+    LOG(message_group::Error, loc, "", "Not an OGEOM file: '%1$s'", filename);
+    return PolySet::createEmpty();
+  }
+  if (header.version != OGEOM_VERSION) {
+    LOG(message_group::Error, loc, "", "Unsupported OGEOM version %1$d in file '%2$s'", header.version,
+        filename);
+    return PolySet::createEmpty();
+  }
+
+  std::unique_ptr<Geometry> geom;
+  if (header.dimension == 3) geom = read_polyset(reader, header);
+  else if (header.dimension == 2) geom = read_polygon(reader, header);
+  if (!geom) {
+    LOG(message_group::Error, loc, "", "Corrupt OGEOM file: '%1$s'", filename);
+    return PolySet::createEmpty();
+  }
+  return geom;
+}
@@ -26,22 +26,33 @@
 
 #include "io/import.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <exception>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
+#include <sys/stat.h>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <boost/format.hpp>
 #include <clipper2/clipper.h>
 
 #include "core/AST.h"
+#include "core/StatCache.h"
 #include "geometry/ClipperUtils.h"
 #include "geometry/Polygon2d.h"
 #include "libsvg/libsvg.h"
 #include "libsvg/svgpage.h"
 #include "libsvg/shape.h"
 #include "libsvg/util.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 namespace {
@@ -79,6 +90,228 @@ double calc_alignment(const libsvg::align_t alignment, double page_mm, double sc
   }
 }
 
+// The shapes of a file, placed as imported, and sanitized for unioning them with ClipperUtils.
+struct ImportedSvg {
+  // one set of paths per shape, without the empty ones
+  std::vector<Clipper2Lib::Paths64> shapes;
+  bool has_matches;
+};
+
+size_t imported_bytes(const ImportedSvg& imported)
+{
+  size_t bytes = sizeof(ImportedSvg);
+  for (const auto& paths : imported.shapes) {
+    for (const auto& path : paths) bytes += sizeof(path) + path.size() * sizeof(Clipper2Lib::Point64);
+  }
+  return bytes;
+}
+
+// Files are read again once their mtime or size changes.
+struct SvgCacheEntry {
+  std::string file_id;
+  // by the import parameters, see import_svg()
+  std::unordered_map<std::string, std::shared_ptr<const ImportedSvg>> imports;
+  size_t bytes = 0;
+  size_t last_used = 0;
+};
+
+// The files least recently imported are dropped once the shapes held exceed SVG_CACHE_MAX_BYTES.
+constexpr size_t SVG_CACHE_MAX_BYTES = 64 * 1024 * 1024;
+
+std::mutex svg_cache_mutex;
+std::unordered_map<std::string, SvgCacheEntry> svg_cache;
+size_t svg_cache_bytes = 0;
+size_t svg_cache_uses = 0;
+
+// Must be called with svg_cache_mutex held.
+void svg_cache_insert(const std::string& filename, const std::string& file_id,
+                      const std::string& parameters, std::shared_ptr<const ImportedSvg> imported)
+{
+  const size_t bytes = imported_bytes(*imported);
+  if (bytes > SVG_CACHE_MAX_BYTES) return;
+
+  auto& entry = svg_cache[filename];
+  if (entry.file_id != file_id) {
+    svg_cache_bytes -= entry.bytes;
+    entry = SvgCacheEntry{file_id};
+  }
+  auto& cached = entry.imports[parameters];
+  if (cached) {
+    entry.bytes -= imported_bytes(*cached);
+    svg_cache_bytes -= imported_bytes(*cached);
+  }
+  cached = std::move(imported);
+  entry.bytes += bytes;
+  entry.last_used = ++svg_cache_uses;
+  svg_cache_bytes += bytes;
+
+  while (svg_cache_bytes > SVG_CACHE_MAX_BYTES) {
+    const auto lru =
+      std::min_element(svg_cache.begin(), svg_cache.end(), [](const auto& a, const auto& b) {
+        return a.second.last_used < b.second.last_used;
+      });
+    svg_cache_bytes -= lru->second.bytes;
+    svg_cache.erase(lru);
+  }
+}
+
+std::shared_ptr<const ImportedSvg> read_svg(CurveDiscretizer discretizer, const std::string& filename,
+                                            const boost::optional<std::string>& id,
+                                            const boost::optional<std::string>& layer,
+                                            const double dpi, const bool center)
+{
+  fnContext scadContext(
+    [&discretizer](double r, double angle) { return discretizer.getCircularSegmentCount(r, angle); },
+    discretizer.getPathSegmentCount());
+  if (id) {
+    scadContext.selector = [&scadContext, id, layer](const libsvg::shape *s) {
+      bool layer_match = true;
+      if (layer) {
+        layer_match = false;
+        for (const libsvg::shape *shape = s; shape->get_parent() != nullptr;
+             shape = shape->get_parent()) {
+          if (shape->has_layer() && shape->get_layer() == layer.get()) {
+            layer_match = true;
+            break;
+          }
+        }
+      }
+      return scadContext.match(layer_match && s->has_id() && s->get_id() == id.get());
+    };
+  } else if (layer) {
+    scadContext.selector = [&scadContext, layer](const libsvg::shape *s) {
+      return scadContext.match(s->has_layer() && s->get_layer() == layer.get());
+    };
+  } else {
+    // no selection means selecting the root
+    scadContext.selector = [&scadContext](const libsvg::shape *s) {
+      return scadContext.match(s->get_parent() == nullptr);
+    };
+  }
+
+  const std::unique_ptr<libsvg::shapes_list_t, decltype(&libsvg::libsvg_free)> shapes{
+    libsvg::libsvg_read_file(filename.c_str(), (void *)&scadContext), &libsvg::libsvg_free};
+
+  double width_mm = 0.0;
+  double height_mm = 0.0;
+
+  Eigen::AlignedBox<double, 2> bbox{2};
+
+  Eigen::Vector2d scale{1.0, 1.0};
+  Eigen::Vector2d align{0.0, 0.0};
+  Eigen::Vector2d viewbox{0.0, 0.0};
+
+  std::vector<const libsvg::shape *> included;
+  for (const auto& shape_ptr : *shapes) {
+    const auto page = dynamic_cast<libsvg::svgpage *>(shape_ptr.get());
+    if (page) {
+      const auto w = page->get_width();
+      const auto h = page->get_height();
+      const auto alignment = page->get_alignment();
+
+      const bool viewbox_valid = page->get_viewbox().is_valid;
+      width_mm = to_mm(w, page->get_viewbox().width, viewbox_valid, dpi);
+      height_mm = to_mm(h, page->get_viewbox().height, viewbox_valid, dpi);
+
+      if (viewbox_valid) {
+        const double px = w.unit == libsvg::unit_t::PERCENT ? w.number / 100.0 : 1.0;
+        const double py = h.unit == libsvg::unit_t::PERCENT ? h.number / 100.0 : 1.0;
+        viewbox << px * page->get_viewbox().x, py * page->get_viewbox().y;
+
+        scale << width_mm / page->get_viewbox().width, height_mm / page->get_viewbox().height;
+
+        if (alignment.x != libsvg::align_t::NONE) {
+          double scaling;
+          if (alignment.meet) {
+            // preserve aspect ratio and fit into viewport, so
+            // select the smaller of the 2 scale factors
+            scaling = scale.x() < scale.y() ? scale.x() : scale.y();
+          } else {
+            // preserve aspect ratio and fill viewport, so select
+            // the bigger of the 2 scale factors
+            scaling = scale.x() > scale.y() ? scale.x() : scale.y();
+          }
+          scale = Eigen::Vector2d{scaling, scaling};
+
+          align << calc_alignment(alignment.x, width_mm, scale.x(), page->get_viewbox().width),
+            calc_alignment(alignment.y, height_mm, scale.y(), page->get_viewbox().height);
+        }
+      }
+    }
+
+    if (!shape_ptr->is_excluded()) {
+      const auto& s = *shape_ptr;
+      for (const auto& p : s.get_path_list()) {
+        for (const auto& v : p) {
+          bbox.extend(Eigen::Vector2d{scale.x() * v.x(), scale.y() * v.y()});
+        }
+      }
+      included.push_back(shape_ptr.get());
+    }
+  }
+  const double cx = center ? bbox.center().x() : -align.x();
+  const double cy = center ? bbox.center().y() : height_mm - align.y();
+
+  // Shapes are flattened and sanitized independently of each other.
+  const int scale_bits = ClipperUtils::scaleBitsFromPrecision();
+  std::vector<Clipper2Lib::Paths64> shape_paths(included.size());
+  parallelizable_transform(
+    included.begin(), included.end(), shape_paths.begin(), [&](const libsvg::shape *s) {
+      Polygon2d poly;
+      for (const auto& p : s->get_path_list()) {
+        Outline2d outline;
+        for (const auto& v : p) {
+          const double x = scale.x() * (-viewbox.x() + v.x()) - cx;
+          const double y = scale.y() * (-viewbox.y() - v.y()) + cy;
+          outline.vertices.emplace_back(x, y);
+        }
+        poly.addOutline(outline);
+      }
+      if (poly.isEmpty()) return Clipper2Lib::Paths64{};
+      return Clipper2Lib::PolyTreeToPaths64(
+        *ClipperUtils::sanitize(ClipperUtils::fromPolygon2d(poly, scale_bits)));
+    });
+
+  auto result = std::make_shared<ImportedSvg>();
+  for (auto& paths : shape_paths) {
+    if (!paths.empty()) result->shapes.push_back(std::move(paths));
+  }
+  result->has_matches = scadContext.has_matches();
+  return result;
+}
+
+Clipper2Lib::Paths64 union_paths(const Clipper2Lib::Paths64& a, const Clipper2Lib::Paths64& b)
+{
+  Clipper2Lib::Clipper64 clipper;
+  clipper.PreserveCollinear(false);
+  clipper.AddSubject(a);
+  clipper.AddClip(b);
+  Clipper2Lib::Paths64 result;
+  clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, result);
+  return result;
+}
+
+// Unions neighboring shapes in rounds of independent unions, until the last two are unioned into the
+// result. Each union only sweeps the outlines of a few shapes, rather than all of them at once.
+std::unique_ptr<Polygon2d> union_shapes(const std::vector<Clipper2Lib::Paths64>& shapes)
+{
+  const std::vector<Clipper2Lib::Paths64> *current = &shapes;
+  std::vector<Clipper2Lib::Paths64> merged;
+  while (current->size() > 2) {
+    std::vector<size_t> pairs(current->size() / 2);
+    std::iota(pairs.begin(), pairs.end(), 0);
+    std::vector<Clipper2Lib::Paths64> next(pairs.size());
+    parallelizable_transform(pairs.begin(), pairs.end(), next.begin(), [current](size_t i) {
+      return union_paths((*current)[2 * i], (*current)[2 * i + 1]);
+    });
+    if (current->size() % 2) next.push_back(current->back());
+    merged = std::move(next);
+    current = &merged;
+  }
+  return ClipperUtils::apply(*current, Clipper2Lib::ClipType::Union,
+                             ClipperUtils::scaleBitsFromPrecision());
+}
+
 }  // namespace
 
 std::unique_ptr<Polygon2d> import_svg(CurveDiscretizer discretizer, const std::string& filename,
@@ -87,33 +320,39 @@ std::unique_ptr<Polygon2d> import_svg(CurveDiscretizer discretizer, const std::s
                                       const bool center, const Location& loc)
 {
   try {
-    fnContext scadContext(
-      [&discretizer](double r, double angle) { return discretizer.getCircularSegmentCount(r, angle); },
-      discretizer.getPathSegmentCount());
-    if (id) {
-      scadContext.selector = [&scadContext, id, layer](const libsvg::shape *s) {
-        bool layer_match = true;
-        if (layer) {
-          layer_match = false;
-          for (const libsvg::shape *shape = s; shape->get_parent() != nullptr;
-               shape = shape->get_parent()) {
-            if (shape->has_layer() && shape->get_layer() == layer.get()) {
-              layer_match = true;
-              break;
-            }
-          }
+    std::ostringstream parameters;
+    parameters << std::hexfloat << discretizer << ", dpi = " << dpi << ", center = " << center;
+    if (id) parameters << ", id = " << id->size() << ':' << id.get();
+    if (layer) parameters << ", layer = " << layer->size() << ':' << layer.get();
+
+    // Files which can't be stat'ed aren't cached, reading them reports the error.
+    struct stat st;
+    std::string file_id;
+    if (StatCache::stat(filename, st) == 0) {
+      file_id = str(boost::format("%x.%x") % st.st_mtime % st.st_size);
+    }
+    const bool cacheable = !file_id.empty();
+
+    std::shared_ptr<const ImportedSvg> imported;
+    if (cacheable) {
+      std::lock_guard<std::mutex> lock(svg_cache_mutex);
+      const auto it = svg_cache.find(filename);
+      if (it != svg_cache.end() && it->second.file_id == file_id) {
+        const auto imported_it = it->second.imports.find(parameters.str());
+        if (imported_it != it->second.imports.end()) {
+          imported = imported_it->second;
+          it->second.last_used = ++svg_cache_uses;
         }
-        return scadContext.match(layer_match && s->has_id() && s->get_id() == id.get());
-      };
-    } else if (layer) {
-      scadContext.selector = [&scadContext, layer](const libsvg::shape *s) {
-        return scadContext.match(s->has_layer() && s->get_layer() == layer.get());
-      };
-    } else {
-      // no selection means selecting the root
-      scadContext.selector = [&scadContext](const libsvg::shape *s) {
-        return scadContext.match(s->get_parent() == nullptr);
-      };
+      }
+    }
+    if (!imported) {
+      // Reading a file which reports anything isn't cached, so the messages are reported every time
+      const size_t message_count = print_message_count();
+      imported = read_svg(discretizer, filename, id, layer, dpi, center);
+      if (cacheable && print_message_count() == message_count) {
+        std::lock_guard<std::mutex> lock(svg_cache_mutex);
+        svg_cache_insert(filename, file_id, parameters.str(), imported);
+      }
     }
 
     std::string match_args;
@@ -124,93 +363,21 @@ std::unique_ptr<Polygon2d> import_svg(CurveDiscretizer discretizer, const std::s
       if (id) match_args += ", ";
       match_args += "layer = \"" + layer.get() + "\"";
     }
-
-    const auto shapes = libsvg::libsvg_read_file(filename.c_str(), (void *)&scadContext);
-    if (!match_args.empty() && !scadContext.has_matches()) {
+    if (!match_args.empty() && !imported->has_matches) {
       LOG(message_group::Warning, loc, "", "import() filter %2$s did not match anything", filename,
           match_args);
     }
 
-    double width_mm = 0.0;
-    double height_mm = 0.0;
-
-    Eigen::AlignedBox<double, 2> bbox{2};
-
-    Eigen::Vector2d scale{1.0, 1.0};
-    Eigen::Vector2d align{0.0, 0.0};
-    Eigen::Vector2d viewbox{0.0, 0.0};
-
-    for (const auto& shape_ptr : *shapes) {
-      const auto page = dynamic_cast<libsvg::svgpage *>(shape_ptr.get());
-      if (page) {
-        const auto w = page->get_width();
-        const auto h = page->get_height();
-        const auto alignment = page->get_alignment();
-
-        const bool viewbox_valid = page->get_viewbox().is_valid;
-        width_mm = to_mm(w, page->get_viewbox().width, viewbox_valid, dpi);
-        height_mm = to_mm(h, page->get_viewbox().height, viewbox_valid, dpi);
-
-        if (viewbox_valid) {
-          const double px = w.unit == libsvg::unit_t::PERCENT ? w.number / 100.0 : 1.0;
-          const double py = h.unit == libsvg::unit_t::PERCENT ? h.number / 100.0 : 1.0;
-          viewbox << px * page->get_viewbox().x, py * page->get_viewbox().y;
-
-          scale << width_mm / page->get_viewbox().width, height_mm / page->get_viewbox().height;
-
-          if (alignment.x != libsvg::align_t::NONE) {
-            double scaling;
-            if (alignment.meet) {
-              // preserve aspect ratio and fit into viewport, so
-              // select the smaller of the 2 scale factors
-              scaling = scale.x() < scale.y() ? scale.x() : scale.y();
-            } else {
-              // preserve aspect ratio and fill viewport, so select
-              // the bigger of the 2 scale factors
-              scaling = scale.x() > scale.y() ? scale.x() : scale.y();
-            }
-            scale = Eigen::Vector2d{scaling, scaling};
-
-            align << calc_alignment(alignment.x, width_mm, scale.x(), page->get_viewbox().width),
-              calc_alignment(alignment.y, height_mm, scale.y(), page->get_viewbox().height);
-          }
-        }
-      }
-
-      if (!shape_ptr->is_excluded()) {
-        const auto& s = *shape_ptr;
-        for (const auto& p : s.get_path_list()) {
-          for (const auto& v : p) {
-            bbox.extend(Eigen::Vector2d{scale.x() * v.x(), scale.y() * v.y()});
-          }
-        }
-      }
-    }
-    const double cx = center ? bbox.center().x() : -align.x();
-    const double cy = center ? bbox.center().y() : height_mm - align.y();
-
-    std::vector<std::shared_ptr<const Polygon2d>> polygons;
-    for (const auto& shape_ptr : *shapes) {
-      if (!shape_ptr->is_excluded()) {
-        auto poly = std::make_shared<Polygon2d>();
-        const auto& s = *shape_ptr;
-        for (const auto& p : s.get_path_list()) {
-          Outline2d outline;
-          for (const auto& v : p) {
-            const double x = scale.x() * (-viewbox.x() + v.x()) - cx;
-            const double y = scale.y() * (-viewbox.y() - v.y()) + cy;
-            outline.vertices.emplace_back(x, y);
-            outline.positive = true;
-          }
-          poly->addOutline(outline);
-        }
-        if (!poly->isEmpty()) polygons.push_back(poly);
-      }
-    }
-    libsvg_free(shapes);
-    return ClipperUtils::apply(polygons, Clipper2Lib::ClipType::Union);
+    return union_shapes(imported->shapes);
   } catch (const std::exception& e) {
     LOG(message_group::Error, "%1$s, import() at line %2$d", e.what(), loc.firstLine());
     return std::make_unique<Polygon2d>();
   }
 }
+
+void clear_svg_cache()
+{
+  std::lock_guard<std::mutex> lock(svg_cache_mutex);
+  svg_cache.clear();
+  svg_cache_bytes = 0;
+}
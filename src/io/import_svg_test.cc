@@ -0,0 +1,58 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "core/AST.h"
+#include "core/CurveDiscretizer.h"
+#include "geometry/Polygon2d.h"
+#include "io/import.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void write_square_svg(const fs::path& path, int size)
+{
+  std::ofstream svg(path);
+  svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << size << "mm\" height=\"" << size
+      << "mm\" viewBox=\"0 0 " << size << " " << size << "\">\n"
+      << "  <rect x=\"0\" y=\"0\" width=\"" << size << "\" height=\"" << size << "\"/>\n"
+      << "</svg>\n";
+}
+
+double imported_width(const fs::path& path)
+{
+  const auto polygon = import_svg(CurveDiscretizer(30), path.string(), boost::none, boost::none, 72,
+                                  false, Location::NONE);
+  REQUIRE(polygon);
+  const auto bbox = polygon->getBoundingBox();
+  return bbox.max().x() - bbox.min().x();
+}
+
+}  // namespace
+
+TEST_CASE("import_svg reads files again once they change", "[Import][SVG]")
+{
+  const fs::path path = fs::temp_directory_path() / "openscad-import-svg-cache-test.svg";
+  clear_svg_cache();
+
+  write_square_svg(path, 10);
+  CHECK(imported_width(path) == Catch::Approx(10));
+  // Imported from the cache
+  CHECK(imported_width(path) == Catch::Approx(10));
+
+  // Wait until the cached result of stat() is stale
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  write_square_svg(path, 200);
+  CHECK(imported_width(path) == Catch::Approx(200));
+  CHECK(imported_width(path) == Catch::Approx(200));
+
+  clear_svg_cache();
+  CHECK(imported_width(path) == Catch::Approx(200));
+
+  fs::remove(path);
+}
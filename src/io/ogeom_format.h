@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/predef.h>
+
+#if !defined(BOOST_ENDIAN_BIG_BYTE_AVAILABLE) && !defined(BOOST_ENDIAN_LITTLE_BYTE_AVAILABLE)
+#error Byte order undefined or unknown. Currently only BOOST_ENDIAN_BIG_BYTE and BOOST_ENDIAN_LITTLE_BYTE are supported.
+#endif
+
+/*
+   The OpenSCAD geometry format (.ogeom) stores a PolySet or a Polygon2d as it is held in memory, so
+   exporting and importing it is copying arrays, without formatting or parsing numbers.
+
+   All values are little-endian. The file starts with an OGeomHeader, followed by arrays each padded
+   with zeros to a multiple of 8 bytes:
+
+   3D (dimension 3):
+     vertices       num_vertices x 3 x double
+     face_offsets   (num_faces + 1) x uint64, face i uses indices[face_offsets[i]..face_offsets[i + 1])
+     indices        num_indices x uint32, into vertices
+     colors         num_colors x 4 x float, RGBA
+     color_indices  num_faces x int32, into colors or -1, only if OGEOM_COLOR_INDICES is set
+
+   2D (dimension 2):
+     vertices         num_vertices x 2 x double
+     outline_offsets  (num_faces + 1) x uint64, outline i has vertices[outline_offsets[i]..[i + 1])
+     positive         num_faces x uint8, 1 for outlines which aren't holes
+
+   Version 1 is the only version. Readers reject other versions.
+ */
+
+inline constexpr char OGEOM_MAGIC[8] = {'O', 'G', 'E', 'O', 'M', '\r', '\n', '\x1a'};
+inline constexpr uint32_t OGEOM_VERSION = 1;
+
+enum OGeomFlags : uint32_t {
+  OGEOM_MANIFOLD = 1 << 0,
+  OGEOM_TRIANGULAR = 1 << 1,
+  // OGEOM_CONVEX is only meaningful if OGEOM_CONVEXITY_KNOWN is set.
+  OGEOM_CONVEXITY_KNOWN = 1 << 2,
+  OGEOM_CONVEX = 1 << 3,
+  OGEOM_COLOR_INDICES = 1 << 4,
+  OGEOM_SANITIZED = 1 << 5,
+  OGEOM_WELDED = 1 << 6,
+};
+
+struct OGeomHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t dimension;
+  uint32_t flags;
+  uint32_t reserved;
+  uint64_t num_vertices;
+  // faces for 3D, outlines for 2D
+  uint64_t num_faces;
+  uint64_t num_indices;
+  uint64_t num_colors;
+};
+
+static_assert(sizeof(OGeomHeader) == 56, "Invalid padding in OGeomHeader");
+
+// Bytes of zero padding following an array of the given size.
+inline size_t ogeom_padding(size_t bytes) { return (8 - bytes % 8) % 8; }
+
+// Converts values between little-endian and the byte order of the host, in place.
+template <typename T>
+void ogeom_byte_order(T *values, size_t count)
+{
+#if BOOST_ENDIAN_BIG_BYTE
+  auto *bytes = reinterpret_cast<unsigned char *>(values);
+  for (size_t i = 0; i < count; ++i) std::reverse(bytes + i * sizeof(T), bytes + (i + 1) * sizeof(T));
+#else
+  (void)values;
+  (void)count;
+#endif
+}
@@ -167,7 +167,8 @@ struct CommandLine {
   const std::string& parameterFile;
   const std::string& setName;
   const ViewOptions& viewOptions;
-  const Camera& camera;
+  // One per image when exporting png. The design sees the first one in $vpt etc.
+  const std::vector<Camera>& cameras;
   const boost::optional<FileFormat> export_format;
   const CmdLineExportOptions& exportOptions;
   const AnimateArgs animate;
@@ -315,14 +316,14 @@ AnimateArgs get_animate(const po::variables_map& vm)
   return animate;
 }
 
-Camera get_camera(const po::variables_map& vm)
+Camera get_camera(const po::variables_map& vm, const std::string& parameters)
 {
   Camera camera;
 
-  if (vm.count("camera")) {
+  if (!parameters.empty()) {
     std::vector<std::string> strs;
     std::vector<double> cam_parameters;
-    boost::split(strs, vm["camera"].as<std::string>(), boost::is_any_of(","));
+    boost::split(strs, parameters, boost::is_any_of(","));
     if (strs.size() == 6 || strs.size() == 7) {
       try {
         for (const auto& s : strs) {
@@ -382,6 +383,31 @@ Camera get_camera(const po::variables_map& vm)
   return camera;
 }
 
+// One camera per --camera option, the other options apply to all of them.
+std::vector<Camera> get_cameras(const po::variables_map& vm)
+{
+  std::vector<Camera> cameras;
+  if (vm.count("camera")) {
+    for (const auto& parameters : vm["camera"].as<std::vector<std::string>>()) {
+      cameras.push_back(get_camera(vm, parameters));
+    }
+  } else {
+    cameras.push_back(get_camera(vm, ""));
+  }
+  return cameras;
+}
+
+// filename with suffix appended to its stem, as for animation frames
+std::string numbered_filename(const std::string& filename, const std::string& suffix)
+{
+  auto path = fs::path(filename);
+  auto extension = path.extension();
+  path.replace_extension();
+  path += suffix;
+  path.replace_extension(extension);
+  return path.generic_string();
+}
+
 int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format,
               SourceFile *root_file)
 {
@@ -401,7 +427,8 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
   PRINTDB("BuiltinContext:\n%s", builtin_context->dump());
 #endif
 
-  AbstractNode::resetIndexCounter();
+  // Nodes reused from previous frames keep their index, which must not be handed out again.
+  if (!Feature::ExperimentalIncrementalInstantiation.is_enabled()) AbstractNode::resetIndexCounter();
   std::shared_ptr<const FileContext> file_context;
   std::shared_ptr<AbstractNode> absolute_root_node;
 
@@ -415,10 +442,11 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
   }
 #endif
 
-  Camera camera = cmd.camera;
+  std::vector<Camera> cameras = cmd.cameras;
   if (file_context) {
-    camera.updateView(file_context, true);
+    for (auto& camera : cameras) camera.updateView(file_context, true);
   }
+  Camera& camera = cameras.front();
 
   // restore CWD after module instantiation finished
   fs::current_path(cmd.original_path);
@@ -504,23 +532,46 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     }
 
     const std::string input_filename = cmd.is_stdin ? "<stdin>" : cmd.filename;
-    const int dim = fileformat::is3D(export_format) ? 3 : fileformat::is2D(export_format) ? 2 : 0;
+    int dim = fileformat::is3D(export_format) ? 3 : fileformat::is2D(export_format) ? 2 : 0;
+    if (fileformat::isAnyDimension(export_format)) dim = root_geom->getDimension() == 2 ? 2 : 3;
     ExportInfo exportInfo = createExportInfo(export_format, fileformat::info(export_format),
-                                             input_filename, &cmd.camera, cmd.exportOptions);
+                                             input_filename, &cmd.cameras.front(), cmd.exportOptions);
     if (dim > 0 && !checkAndExport(root_geom, dim, exportInfo, cmd.is_stdout, filename_str)) {
       return 1;
     }
 
     if (export_format == FileFormat::PNG) {
+      // With several cameras, view i is written to <name>-<i>.png
+      const auto view_filename = [&](size_t i) {
+        if (cameras.size() == 1) return filename_str;
+        return numbered_filename(filename_str, "-" + std::to_string(i));
+      };
       bool success = true;
       bool const wrote = with_output(
-        cmd.is_stdout, filename_str,
-        [&success, &root_geom, &cmd, &camera, &glview](std::ostream& stream) {
+        cmd.is_stdout, view_filename(0),
+        [&success, &root_geom, &cmd, &cameras, &glview, &view_filename](std::ostream& stream) {
+          std::vector<std::ofstream> view_streams;
+          std::vector<std::ostream *> outputs{&stream};
+          for (size_t i = 1; i < cameras.size(); ++i) {
+            const auto filename = view_filename(i);
+            auto& fstream = view_streams.emplace_back(std::filesystem::u8path(filename),
+                                                      std::ios::out | std::ios::binary);
+            if (!fstream.is_open()) {
+              LOG("Can't open file \"%1$s\" for export", filename);
+              success = false;
+              return;
+            }
+            outputs.push_back(&fstream);
+          }
           if (cmd.viewOptions.renderer == RenderType::BACKEND_SPECIFIC ||
               cmd.viewOptions.renderer == RenderType::GEOMETRY) {
-            success = export_png(root_geom, cmd.viewOptions, camera, stream);
+            success = export_png(root_geom, cmd.viewOptions, cameras, outputs);
           } else {
+            // prepare_preview() has drawn the first view
             success = export_png(*glview, stream);
+            for (size_t i = 1; success && i < cameras.size(); ++i) {
+              success = export_png(*glview, cameras[i], *outputs[i]);
+            }
           }
         },
         std::ios::out | std::ios::binary);
@@ -639,7 +690,7 @@ int cmdline(const CommandLine& cmd)
                  ? (cmd.viewOptions.renderer == RenderType::OPENCSG ||
                     cmd.viewOptions.renderer == RenderType::THROWNTOGETHER)
                  : false,
-    .camera = cmd.camera,
+    .camera = cmd.cameras.front(),
   };
 
   if (cmd.animate.frames == 0) {
@@ -654,13 +705,7 @@ int cmdline(const CommandLine& cmd)
 
       std::ostringstream oss;
       oss << std::setw(5) << std::setfill('0') << frame;
-
-      auto frame_file = fs::path(cmd.output_file);
-      auto extension = frame_file.extension();
-      frame_file.replace_extension();
-      frame_file += oss.str();
-      frame_file.replace_extension(extension);
-      std::string const frame_str = frame_file.generic_string();
+      std::string const frame_str = numbered_filename(cmd.output_file, oss.str());
 
       LOG("Exporting %1$s...", cmd.filename);
 
@@ -851,7 +896,8 @@ int openscad_main(int argc, char **argv)
     "default so asciistl should be explicitly specified in scripts when needed.\n")(
     "o,o", po::value<std::vector<std::string>>(),
     "output specified file instead of running the GUI. The file extension specifies the type: stl, off, "
-    "wrl, amf, 3mf, csg, dxf, svg, pdf, png, echo, ast, term, nef3, nefdbg, param, pov. May be used "
+    "wrl, amf, 3mf, csg, dxf, svg, pdf, png, echo, ast, term, nef3, nefdbg, param, pov, "
+    "ogeom. May be used "
     "multiple times for different exports. Use '-' for stdout.\n")(
     "O,O", po::value<std::vector<std::string>>(),
     "pass settings value to the file export using the format section/key=value, e.g "
@@ -871,13 +917,17 @@ int openscad_main(int argc, char **argv)
         "help-export", "print list of export parameters and values that can be set via -O")(
         "version,v", "print the version")("info", "print information about the build process\n")
 
-        ("camera", po::value<std::string>(),
+        ("camera", po::value<std::vector<std::string>>(),
          "camera parameters when exporting png: =translate_x,y,z,rot_x,y,z,dist or "
-         "=eye_x,y,z,center_x,y,z")("autocenter", "adjust camera to look at object's center")(
+         "=eye_x,y,z,center_x,y,z. Repeat to export one png per camera, as name-0.png, name-1.png "
+         "and so on")("autocenter", "adjust camera to look at object's center")(
           "viewall", "adjust camera to fit object")(
           "backend", po::value<std::string>(),
           "3D rendering backend to use: 'CGAL' (old/slow) or 'Manifold' (new/fast) [default]")(
           "imgsize", po::value<std::string>(), "=width,height of exported png")(
+          "offscreen-provider", po::value<std::string>(),
+          "=OpenGL context provider for exporting png, or 'software' to render geometry without "
+          "OpenGL")(
           "render", po::value<std::string>()->implicit_value(""),
           "for full geometry evaluation when exporting png")(
           "preview", po::value<std::string>()->implicit_value(""),
@@ -1016,6 +1066,9 @@ int openscad_main(int argc, char **argv)
     }
     RenderSettings::inst()->backend3D = backend.value();
   }
+  if (vm.count("offscreen-provider")) {
+    RenderSettings::inst()->offscreenProvider = vm["offscreen-provider"].as<std::string>();
+  }
 
   if (vm.count("preview")) {
     if (vm["preview"].as<std::string>() == "throwntogether")
@@ -1114,7 +1167,7 @@ int openscad_main(int argc, char **argv)
   }
 
   AnimateArgs const animate = get_animate(vm);
-  const Camera camera = get_camera(vm);
+  const std::vector<Camera> cameras = get_cameras(vm);
 
   if (animate.frames) {
     for (const auto& filename : output_files) {
@@ -1127,6 +1180,14 @@ int openscad_main(int argc, char **argv)
       output_files.emplace_back("frame.png");
     }
   }
+  if (cameras.size() > 1) {
+    for (const auto& filename : output_files) {
+      if (filename == "-") {
+        LOG("Several --camera options are not supported when exporting to stdout.");
+        return 1;
+      }
+    }
+  }
 
   PRINTDB("Application location detected as %s", applicationPath);
 
@@ -1158,7 +1219,7 @@ int openscad_main(int argc, char **argv)
                                 parameterFile,
                                 parameterSet,
                                 viewOptions,
-                                camera,
+                                cameras,
                                 export_format,
                                 export_options,
                                 animate,
@@ -11,14 +11,24 @@
 class StackCheck
 {
 public:
+  // Each thread measures its own stack, from wherever it first calls inst().
   static StackCheck& inst()
   {
-    static StackCheck instance;
+    static thread_local StackCheck instance;
     return instance;
   }
 
   inline bool check() { return size() >= limit; }
 
+  // Measure from the caller's frame on, with a limit for threads whose stack may be smaller than
+  // the process stack limit.
+  void reset(unsigned long limit)
+  {
+    unsigned char c;
+    ptr = &c;  // NOLINT(*StackAddressEscape)
+    this->limit = limit;
+  }
+
 private:
   StackCheck() : limit(PlatformUtils::stackLimit())
   {
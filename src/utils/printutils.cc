@@ -38,6 +38,10 @@ boost::circular_buffer<struct Message> lastlogmessages(5);
 
 bool no_throw;
 bool deferred;
+size_t message_count = 0;
+
+thread_local bool messages_suppressed = false;
+thread_local size_t suppressed_message_count = 0;
 
 }  // namespace
 
@@ -76,8 +80,25 @@ void print_messages_pop()
   }
 }
 
+size_t print_message_count() { return message_count; }
+
+void suppress_thread_messages(bool suppress)
+{
+  messages_suppressed = suppress;
+  suppressed_message_count = 0;
+}
+
+size_t suppressed_thread_message_count() { return suppressed_message_count; }
+
+bool drop_suppressed_message()
+{
+  if (messages_suppressed) ++suppressed_message_count;
+  return messages_suppressed;
+}
+
 void PRINT(const Message& msgObj)
 {
+  if (drop_suppressed_message()) return;
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
 
   if (print_messages_stack.size() > 0) {
@@ -98,7 +119,9 @@ void PRINT(const Message& msgObj)
 
 void PRINT_NOCACHE(const Message& msgObj)
 {
+  if (drop_suppressed_message()) return;
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  ++message_count;
 
   const auto msg = msgObj.str();
 
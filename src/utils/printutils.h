@@ -122,6 +122,14 @@ void resetSuppressedMessages();
 void PRINT(const Message& msgObj);
 
 void PRINT_NOCACHE(const Message& msgObj);
+// Number of messages printed so far, used to detect whether an evaluation printed anything.
+size_t print_message_count();
+// While suppressed, messages of the calling thread are counted instead of being printed. Used by worker
+// threads whose results are discarded if they had anything to report (see ParallelComprehension).
+void suppress_thread_messages(bool suppress);
+size_t suppressed_thread_message_count();
+// Counts the message and returns true if messages of the calling thread are suppressed.
+bool drop_suppressed_message();
 #define PRINTB_NOCACHE(_fmt, _arg) \
   do {                             \
   } while (0)
@@ -249,6 +257,7 @@ template <typename... Args>
 std::optional<Message> make_message_obj(const message_group& msgGroup, Location loc, std::string docPath,
                                         std::string&& f, Args&&...args)
 {
+  if (drop_suppressed_message()) return {};
   auto formatted = MessageClass<Args...>{std::move(f), std::forward<Args>(args)...}.format();
 
   // check for deprecations
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+
+# 3MF build structure test
+#
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] file.txt
+#
+#
+# step 1. Export the .scad file as 3MF
+# step 2. Write the mesh objects of the exported model, with their vertex and triangle counts, and the
+#         build items referencing them, with their transforms, to file.txt
+# step 3. (done in CTest) - compare the generated file.txt to expected output
+#
+# This script should return 0 on success, not-0 on error.
+
+
+import sys, os, subprocess, argparse, tempfile, zipfile
+import xml.etree.ElementTree as ET
+
+CORE = "{http://schemas.microsoft.com/3dmanufacturing/core/2015/02}"
+
+
+def failquit(*args):
+    if len(args) != 0:
+        print(*args)
+    print("export_3mf_build_test args:", str(sys.argv))
+    print("exiting export_3mf_build_test.py with failure")
+    sys.exit(1)
+
+
+#
+# Parse arguments
+#
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable")
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+resultfile = remaining_args[-1]
+remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+with tempfile.TemporaryDirectory() as exportdir:
+    exportfile = os.path.join(exportdir, "export.3mf")
+    export_cmd = [args.openscad, inputfile, "-o", exportfile] + remaining_args
+    print("Running OpenSCAD:", " ".join(export_cmd), file=sys.stderr)
+    result = subprocess.call(export_cmd)
+    if result != 0:
+        failquit("OpenSCAD failed with return code " + str(result))
+    model = ET.fromstring(zipfile.ZipFile(exportfile).read("3D/3dmodel.model"))
+
+with open(resultfile, "w") as out:
+    for obj in model.iter(CORE + "object"):
+        vertices = obj.findall("./%smesh/%svertices/%svertex" % (CORE, CORE, CORE))
+        triangles = obj.findall("./%smesh/%striangles/%striangle" % (CORE, CORE, CORE))
+        out.write("object %s \"%s\": %d vertices, %d triangles\n" %
+                  (obj.get("id"), obj.get("name"), len(vertices), len(triangles)))
+    for item in model.iter(CORE + "item"):
+        transform = item.get("transform")
+        if transform is not None:
+            transform = " ".join("%g" % float(x) for x in transform.split())
+        out.write("item %s: %s\n" % (item.get("objectid"), transform or "identity"))
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+
+# Export comparison test
+#
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> --compare-args=<args> [<openscad args>] file.txt
+#
+#
+# step 1. Export the .scad file as ASCII STL twice: with the given OpenSCAD arguments, and with the
+#         arguments of --compare-args added, e.g. to enable an experimental cache
+# step 2. Compare the volume, surface area and bounding box of both exports, which don't depend on how
+#         faces are triangulated or ordered, and write which of them match to file.txt
+# step 3. (done in CTest) - compare the generated file.txt to expected output
+#
+# This script should return 0 on success, not-0 on error.
+
+
+import sys, os, shlex, subprocess, argparse, tempfile
+
+
+def failquit(*args):
+    if len(args) != 0:
+        print(*args)
+    print("export_compare_test args:", str(sys.argv))
+    print("exiting export_compare_test.py with failure")
+    sys.exit(1)
+
+
+def read_stl(filename):
+    triangles = []
+    vertices = []
+    with open(filename) as f:
+        for line in f:
+            words = line.split()
+            if words and words[0] == "vertex":
+                vertices.append(tuple(float(x) for x in words[1:4]))
+                if len(vertices) == 3:
+                    triangles.append(vertices)
+                    vertices = []
+    return triangles
+
+
+def measure(triangles):
+    volume = 0.0
+    area = 0.0
+    lo = [float("inf")] * 3
+    hi = [float("-inf")] * 3
+    for a, b, c in triangles:
+        volume += (a[0] * (b[1] * c[2] - b[2] * c[1]) - a[1] * (b[0] * c[2] - b[2] * c[0]) +
+                   a[2] * (b[0] * c[1] - b[1] * c[0])) / 6
+        u = [b[i] - a[i] for i in range(3)]
+        v = [c[i] - a[i] for i in range(3)]
+        n = (u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0])
+        area += (n[0] ** 2 + n[1] ** 2 + n[2] ** 2) ** 0.5 / 2
+        for p in (a, b, c):
+            for i in range(3):
+                lo[i] = min(lo[i], p[i])
+                hi[i] = max(hi[i], p[i])
+    return {"volume": [volume], "area": [area], "bounding box": lo + hi}
+
+
+def same(expected, actual, scale):
+    # exports are rounded to about 6 significant digits
+    return all(abs(e - a) <= 1e-4 * scale for e, a in zip(expected, actual))
+
+
+def main():
+    #
+    # Parse arguments
+    #
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable")
+    parser.add_argument("--compare-args", required=True,
+                        help="OpenSCAD arguments only for the compared export")
+    args, remaining_args = parser.parse_known_args()
+
+    inputfile = remaining_args[0]
+    resultfile = remaining_args[-1]
+    remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+    if not os.path.exists(inputfile):
+        failquit("can't find input file named: " + inputfile)
+    if not os.path.exists(args.openscad):
+        failquit("can't find openscad executable named: " + args.openscad)
+
+    fontdir = os.path.abspath(os.path.join(os.path.dirname(__file__), "data/ttf"))
+    fontenv = os.environ.copy()
+    fontenv["OPENSCAD_FONT_PATH"] = fontdir
+
+    measures = []
+    with tempfile.TemporaryDirectory() as exportdir:
+        for name, extra_args in (("reference", []), ("compared", shlex.split(args.compare_args))):
+            exportfile = os.path.join(exportdir, name + ".stl")
+            export_cmd = [args.openscad, inputfile, "-o", exportfile, "--export-format=asciistl"]
+            export_cmd += remaining_args + extra_args
+            print("Running OpenSCAD:", " ".join(export_cmd), file=sys.stderr)
+            result = subprocess.call(export_cmd, env=fontenv)
+            if result != 0:
+                failquit("OpenSCAD failed with return code " + str(result))
+            triangles = read_stl(exportfile)
+            if not triangles:
+                failquit("empty export: " + " ".join(export_cmd))
+            measures.append(measure(triangles))
+
+    reference, compared = measures
+    box = reference["bounding box"]
+    size = max(box[i + 3] - box[i] for i in range(3))
+    scales = {"volume": size ** 3, "area": size ** 2, "bounding box": size}
+    failures = []
+    with open(resultfile, "w") as out:
+        for key in ("volume", "area", "bounding box"):
+            if same(reference[key], compared[key], scales[key]):
+                out.write("%s: same\n" % key)
+            else:
+                out.write("%s: differs\n" % key)
+                failures.append("%s: %s, compared %s" % (key, reference[key], compared[key]))
+    if failures:
+        failquit("exports differ:\n  " + "\n  ".join(failures))
+
+
+if __name__ == "__main__":
+    main()
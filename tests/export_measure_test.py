@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+# Export measurement test
+#
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] file.txt
+#
+#
+# step 1. Export the .scad file as ASCII STL with the given OpenSCAD arguments
+# step 2. Write the warnings OpenSCAD printed, the bounding box of the export rounded to 0.1, and
+#         whether its volume is that given by an "// Expected volume: <volume> [within <n>%]" comment
+#         of the .scad file, within 1% unless given, to file.txt. The tolerance allows for how the
+#         geometry was sampled or triangulated.
+# step 3. (done in CTest) - compare the generated file.txt to expected output
+#
+# This script should return 0 on success, not-0 on error.
+
+
+import sys, os, re, subprocess, argparse, tempfile
+
+from export_compare_test import read_stl, measure
+
+
+def failquit(*args):
+    if len(args) != 0:
+        print(*args)
+    print("export_measure_test args:", str(sys.argv))
+    print("exiting export_measure_test.py with failure")
+    sys.exit(1)
+
+
+def expected_volume(filename):
+    with open(filename, encoding="utf-8") as f:
+        for line in f:
+            match = re.match(r"\s*//\s*Expected volume:\s*([-+0-9.e]+)(?:\s+within\s+([0-9.]+)%)?", line)
+            if match:
+                return float(match.group(1)), float(match.group(2) or 1)
+    failquit("no \"// Expected volume: <volume>\" comment in " + filename)
+
+
+#
+# Parse arguments
+#
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable")
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+resultfile = remaining_args[-1]
+remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+expected, tolerance = expected_volume(inputfile)
+
+with tempfile.TemporaryDirectory() as exportdir:
+    exportfile = os.path.join(exportdir, "export.stl")
+    export_cmd = [args.openscad, inputfile, "-o", exportfile, "--export-format=asciistl"] + remaining_args
+    print("Running OpenSCAD:", " ".join(export_cmd), file=sys.stderr)
+    result = subprocess.run(export_cmd, stderr=subprocess.PIPE, universal_newlines=True)
+    sys.stderr.write(result.stderr)
+    if result.returncode != 0:
+        failquit("OpenSCAD failed with return code " + str(result.returncode))
+    triangles = read_stl(exportfile)
+    if not triangles:
+        failquit("empty export: " + " ".join(export_cmd))
+
+measures = measure(triangles)
+volume = measures["volume"][0]
+print("volume: %.6g, expected %.6g within %g%%" % (volume, expected, tolerance), file=sys.stderr)
+
+with open(resultfile, "w") as out:
+    for line in result.stderr.splitlines():
+        if line.startswith("WARNING:"):
+            # The location depends on where the test data is
+            out.write(re.sub(r" in file .*, line \d+$", "", line) + "\n")
+    out.write("bounding box: %s\n" % " ".join("%.1f" % (x + 0.0) for x in measures["bounding box"]))
+    if abs(volume - expected) <= tolerance / 100 * abs(expected):
+        out.write("volume: within %g%% of %g\n" % (tolerance, expected))
+    else:
+        out.write("volume: %.6g, not within %g%% of %g\n" % (volume, tolerance, expected))
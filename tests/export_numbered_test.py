@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+
+# Numbered export test
+#
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> --format=<format> [<openscad args>] file.txt
+#
+#
+# step 1. Run OpenSCAD on the .scad file with arguments which export several numbered files, e.g.
+#         --animate or several --camera options, into an empty directory
+# step 2. Write the names of the exported files to file.txt, followed by their contents for text
+#         formats, or by their dimensions for PNG images and whether anything was drawn in them
+# step 3. With --compare-cameras=<python>, export each --camera=... view on its own as well, and
+#         compare it to the numbered image of that view with image_compare.py run by <python>
+# step 4. (done in CTest) - compare the generated file.txt to expected output
+#
+# This script should return 0 on success, not-0 on error.
+
+
+import sys, os, struct, subprocess, argparse, tempfile, zlib
+
+text_formats = ["echo", "csg", "ast", "term", "txt"]
+
+
+def failquit(*args):
+    if len(args) != 0:
+        print(*args)
+    print("export_numbered_test args:", str(sys.argv))
+    print("exiting export_numbered_test.py with failure")
+    sys.exit(1)
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(filename):
+    """Returns the width and height of an 8 bit, non-interlaced PNG image, and its rows of pixels."""
+    with open(filename, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        failquit("not a PNG file: " + filename)
+    pos = 8
+    idat = b""
+    while pos < len(data):
+        length, chunk = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if chunk == b"IHDR":
+            width, height, depth, colortype, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif chunk == b"IDAT":
+            idat += body
+        pos += length + 12
+    if depth != 8 or interlace != 0 or colortype not in (0, 2, 4, 6):
+        failquit("unsupported PNG format: " + filename)
+    bpp = {0: 1, 2: 3, 4: 2, 6: 4}[colortype]
+    raw = zlib.decompress(idat)
+    stride = width * bpp
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        kind = raw[start]
+        row = bytearray(raw[start + 1:start + 1 + stride])
+        for i in range(stride):
+            a = row[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                row[i] = (row[i] + a) & 0xff
+            elif kind == 2:
+                row[i] = (row[i] + b) & 0xff
+            elif kind == 3:
+                row[i] = (row[i] + (a + b) // 2) & 0xff
+            elif kind == 4:
+                row[i] = (row[i] + paeth(a, b, c)) & 0xff
+        rows.append(bytes(row))
+        prev = row
+    return width, height, bpp, rows
+
+
+def png_description(filename):
+    width, height, bpp, rows = read_png(filename)
+    first = rows[0][:bpp]
+    blank = all(row == first * width for row in rows)
+    return "%dx%d%s" % (width, height, " blank" if blank else "")
+
+
+#
+# Parse arguments
+#
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable")
+parser.add_argument("--format", required=True, help="Specify export format")
+parser.add_argument("--compare-cameras", metavar="PYTHON",
+                    help="Compare numbered PNG images with single --camera exports, using PYTHON")
+args, remaining_args = parser.parse_known_args()
+
+args.format = args.format.lower()
+inputfile = remaining_args[0]
+resultfile = remaining_args[-1]
+remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+inputbasename = os.path.splitext(os.path.basename(inputfile))[0]
+image_compare_py = os.path.join(os.path.dirname(os.path.abspath(__file__)), "image_compare.py")
+fontdir = os.path.abspath(os.path.join(os.path.dirname(__file__), "data/ttf"))
+fontenv = os.environ.copy()
+fontenv["OPENSCAD_FONT_PATH"] = fontdir
+
+with tempfile.TemporaryDirectory() as exportdir:
+    exportfile = os.path.join(exportdir, inputbasename + "." + args.format)
+    export_cmd = [args.openscad, inputfile, "-o", exportfile] + remaining_args
+    print("Running OpenSCAD:", " ".join(export_cmd), file=sys.stderr)
+    result = subprocess.call(export_cmd, env=fontenv)
+    if result != 0:
+        failquit("OpenSCAD failed with return code " + str(result))
+
+    exported = sorted(os.listdir(exportdir))
+    if not exported:
+        failquit("OpenSCAD didn't export any files")
+
+    # Maps the numbered images to their single --camera exports, e.g. name00001-2.png to the
+    # name00001.png exported with the third camera only
+    single_exports = {}
+    if args.compare_cameras:
+        cameras = [arg for arg in remaining_args if arg.startswith("--camera=")]
+        other_args = [arg for arg in remaining_args if not arg.startswith("--camera=")]
+        for i, camera in enumerate(cameras):
+            cameradir = os.path.join(exportdir, "camera%d" % i)
+            os.mkdir(cameradir)
+            camera_cmd = [args.openscad, inputfile, "-o", os.path.join(cameradir, inputbasename + ".png")]
+            camera_cmd += other_args + [camera]
+            print("Running OpenSCAD:", " ".join(camera_cmd), file=sys.stderr)
+            result = subprocess.call(camera_cmd, env=fontenv)
+            if result != 0:
+                failquit("OpenSCAD failed with return code " + str(result))
+            for name in os.listdir(cameradir):
+                base, ext = os.path.splitext(name)
+                single_exports["%s-%d%s" % (base, i, ext)] = os.path.join(cameradir, name)
+
+    with open(resultfile, "w") as out:
+        for name in exported:
+            filename = os.path.join(exportdir, name)
+            if args.format == "png":
+                description = png_description(filename)
+                if name in single_exports:
+                    compare_cmd = [args.compare_cameras, "-Xutf8=1", image_compare_py, single_exports[name],
+                                   filename]
+                    print("Comparing images:", " ".join(compare_cmd), file=sys.stderr)
+                    same = subprocess.call(compare_cmd) == 0
+                    description += " same as single camera" if same else " differs from single camera"
+                elif args.compare_cameras:
+                    description += " without single camera export"
+                out.write("=== %s %s\n" % (name, description))
+            elif args.format in text_formats:
+                out.write("=== %s\n" % name)
+                with open(filename, encoding="utf-8") as f:
+                    out.write(f.read())
+            else:
+                out.write("=== %s\n" % name)
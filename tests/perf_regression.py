@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+
+# Performance regression test
+#
+#
+# Usage: <script> --baseline=<file.json> [--openscad=<executable-path> --scenarios=<scenarios.json>]
+#                 [--bench=<openscad-bench-path>] [--results=<file.json>] [--tolerance=<fraction>]
+#
+#
+# step 1. Time each macro scenario (an OpenSCAD export of an example or test file), keeping the
+#         fastest of --repeat runs, and/or run the openscad-bench micro-benchmarks.
+# step 2. Write all timings as JSON to --results.
+# step 3. Compare against the baseline: a timing fails if it exceeds the baseline by more than
+#         --tolerance (relative) plus --slack (absolute, in seconds).
+#
+# Timings are machine specific, so a missing baseline is created from the current results
+# (and the test passes). Use --update-baseline to accept new timings.
+#
+# This script should return 0 on success, not-0 on error.
+
+
+import sys, os, json, time, subprocess, argparse, tempfile
+
+
+def failquit(*args):
+    if len(args) != 0:
+        print(*args)
+    print("perf_regression args:", str(sys.argv))
+    print("exiting perf_regression.py with failure")
+    sys.exit(1)
+
+
+def run_scenarios(openscad, scenarios_file, repeat):
+    with open(scenarios_file) as f:
+        scenarios = json.load(f)["scenarios"]
+    root = os.path.abspath(os.path.join(os.path.dirname(scenarios_file), "..", ".."))
+    results = {}
+    with tempfile.TemporaryDirectory() as tmpdir:
+        for scenario in scenarios:
+            inputfile = os.path.join(root, scenario["file"])
+            outputfile = os.path.join(tmpdir, scenario["name"] + "." + scenario["format"])
+            cmd = [openscad, inputfile, "-o", outputfile] + scenario.get("args", [])
+            best = None
+            for _ in range(repeat):
+                start = time.perf_counter()
+                proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+                elapsed = time.perf_counter() - start
+                if proc.returncode != 0:
+                    failquit("scenario " + scenario["name"] + " failed:", proc.stdout.decode(errors="replace"))
+                best = elapsed if best is None else min(best, elapsed)
+            print("scenario %-32s %8.3f s" % (scenario["name"], best))
+            results[scenario["name"]] = best
+    if not results:
+        failquit("no scenarios in " + scenarios_file)
+    return results
+
+
+def run_benchmarks(bench, repeat):
+    with tempfile.TemporaryDirectory() as tmpdir:
+        outputfile = os.path.join(tmpdir, "bench.json")
+        cmd = [bench, "--benchmark_out=" + outputfile, "--benchmark_out_format=json",
+               "--benchmark_repetitions=" + str(repeat)]
+        proc = subprocess.run(cmd)
+        if proc.returncode != 0:
+            failquit("openscad-bench failed")
+        with open(outputfile) as f:
+            output = json.load(f)
+    results = {}
+    for benchmark in output["benchmarks"]:
+        # the minimum over the individual repetitions is the most stable estimate, so skip the
+        # mean/median/stddev/cv aggregates
+        if benchmark.get("run_type", "iteration") != "iteration" or benchmark.get("error_occurred"):
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        seconds = benchmark["real_time"] * {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1}[benchmark["time_unit"]]
+        results[name] = min(seconds, results.get(name, seconds))
+    if not results:
+        failquit("no benchmark results parsed from openscad-bench output")
+    return results
+
+
+def compare(results, baseline, tolerance, slack):
+    failures = []
+    for kind in results:
+        for name, seconds in results[kind].items():
+            expected = baseline.get(kind, {}).get(name)
+            if expected is None:
+                print("no baseline for %s %s" % (kind, name))
+                continue
+            # micro-benchmarks run in nanoseconds, so the absolute slack only applies to scenarios
+            limit = expected * (1 + tolerance) + (slack if kind == "scenarios" else 0)
+            if seconds > limit:
+                failures.append("%s %s: %.6g s, baseline %.6g s (+%d%%)" %
+                                (kind, name, seconds, expected, round(100 * (seconds / expected - 1))))
+    return failures
+
+
+#
+# Parse arguments
+#
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", help="Specify OpenSCAD executable for the macro scenarios")
+parser.add_argument("--scenarios", help="JSON file listing the macro scenarios")
+parser.add_argument("--bench", help="Specify openscad-bench executable for the micro-benchmarks")
+parser.add_argument("--baseline", required=True, help="JSON file with the baseline timings")
+parser.add_argument("--results", help="Write the timings as JSON to this file")
+parser.add_argument("--repeat", type=int, default=3, help="Number of runs per scenario or benchmark")
+parser.add_argument("--tolerance", type=float, default=0.25, help="Allowed relative slowdown")
+parser.add_argument("--slack", type=float, default=0.05, help="Allowed absolute slowdown of scenarios (s)")
+parser.add_argument("--update-baseline", action="store_true", help="Replace the baseline by the results")
+args = parser.parse_args()
+
+if not args.bench and not (args.openscad and args.scenarios):
+    failquit("nothing to do: specify --bench and/or --openscad with --scenarios")
+
+results = {}
+if args.openscad and args.scenarios:
+    results["scenarios"] = run_scenarios(args.openscad, args.scenarios, args.repeat)
+if args.bench:
+    results["benchmarks"] = run_benchmarks(args.bench, args.repeat)
+
+if args.results:
+    with open(args.results, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+if args.update_baseline or not os.path.exists(args.baseline):
+    print("writing baseline " + args.baseline)
+    os.makedirs(os.path.dirname(os.path.abspath(args.baseline)), exist_ok=True)
+    with open(args.baseline, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+    sys.exit(0)
+
+with open(args.baseline) as f:
+    baseline = json.load(f)
+failures = compare(results, baseline, args.tolerance, args.slack)
+if failures:
+    failquit("performance regressions:\n  " + "\n  ".join(failures))
+sys.exit(0)